@@ -733,12 +733,28 @@ Agnus::executeUntil(Cycle targetClock)
 
     } else {
 
+        // Skip all DMA cycles up to the next pending event
+        if (dmaCycles > 0 && nextTrigger > clock) {
+            
+            DMACycle skip = std::min((nextTrigger - clock) / DMA_CYCLES(1), dmaCycles);
+            clock += DMA_CYCLES(skip);
+            pos.h += skip;
+            dmaCycles -= skip;
+            assert(pos.h <= HPOS_CNT);
+        }
+        
         // Execute DMA cycles one after another
         for (DMACycle i = 0; i < dmaCycles; i++) execute();
     }
 }
 #endif
 
+void
+Agnus::syncWithCPU()
+{
+    executeUntil(cpu.getMasterClock());
+}
+
 void
 Agnus::syncWithEClock()
 {
@@ -983,6 +999,9 @@ Agnus::hsyncHandler()
     // Reset the horizontal counter
     pos.h = 0;
 
+    // Check if recorded input is due soon
+    inputRecorder.hsyncHandler();
+
     // Advance the vertical counter
     if (++pos.v >= frame.numLines()) vsyncHandler();
 
@@ -1092,7 +1111,9 @@ void
 Agnus::vsyncHandler()
 {
     // Run the screen recorder
-    denise.screenRecorder.vsyncHandler(clock - 50 * DMA_CYCLES(HPOS_CNT));
+    if (!runAhead.isActive()) {
+        denise.screenRecorder.vsyncHandler(clock - 50 * DMA_CYCLES(HPOS_CNT));
+    }
 
     // Synthesize sound samples
     paula.executeUntil(clock - 50 * DMA_CYCLES(HPOS_CNT));
@@ -1117,6 +1138,18 @@ Agnus::vsyncHandler()
     updateStats();
     mem.updateStats();
     
+    // Speculative frames end here (see RunAhead)
+    if (runAhead.isActive()) return;
+    
+    // Record a checkpoint for the rewind buffer if one is due
+    rewindBuffer.vsyncHandler();
+    
+    // Emulate the next frames ahead if run-ahead is enabled
+    runAhead.vsyncHandler();
+
+    // Record the state after the boot if the boot cache asks for it
+    bootCache.vsyncHandler();
+    
     // Count some sheep (zzzzzz) ...
     oscillator.synchronize();
     /*
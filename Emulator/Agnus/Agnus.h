@@ -460,6 +460,9 @@ private:
 
 public:
     
+    // Returns a textual description for an event
+    static const char *eventName(EventSlot slot, EventID id);
+
     AgnusStats getStats() { return stats; }
     
 private:
@@ -879,6 +882,16 @@ public:
     // Executes the device until the target clock is reached
     void executeUntil(Cycle targetClock);
 
+    /* Executes the device until the CPU clock is reached. Unless Agnus is
+     * synchronized eagerly, the CPU only emulates Agnus up to its own clock if
+     * an event is due. This function needs to be called before the Agnus state
+     * is accessed in a way that depends on the current beam position.
+     */
+    void syncWithCPU();
+
+    // Returns the trigger cycle of the next pending event
+    Cycle getNextTrigger() const { return nextTrigger; }
+
     // Executes the device to the beginning of the next E clock cycle
     void syncWithEClock();
 
@@ -12,8 +12,28 @@
 #include "Agnus.h"
 #include "Checksum.h"
 #include "IO.h"
+#include <mutex>
+
+u8 Blitter::fillPattern[2][2][256];
+u8 Blitter::nextCarryIn[2][256];
+void (Blitter::*Blitter::blitfunc[32])(void);
+void (Blitter::*Blitter::copyBlitInstr[16][2][2][6])(void);
+void (Blitter::*Blitter::lineBlitInstr[6])(void);
 
 Blitter::Blitter(Amiga& ref) : AmigaComponent(ref)
+{
+    // Set up the lookup tables if this is the first instance
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        
+        initFillPatterns();
+        initFastBlitter();
+        initSlowBlitter();
+    });
+}
+
+void
+Blitter::initFillPatterns()
 {
     // Initialize fill pattern tables    
     for (isize carryIn = 0; carryIn < 2; carryIn++) {
@@ -38,13 +58,6 @@ Blitter::Blitter(Amiga& ref) : AmigaComponent(ref)
     }
 }
 
-void
-Blitter::_initialize()
-{    
-    initFastBlitter();
-    initSlowBlitter();
-}
-
 void
 Blitter::_reset(bool hard)
 {
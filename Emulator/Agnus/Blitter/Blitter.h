@@ -37,9 +37,9 @@ class Blitter : public AmigaComponent
     // Result of the latest inspection
     BlitterInfo info;
 
-    // The fill pattern lookup tables
-    u8 fillPattern[2][2][256];     // [inclusive/exclusive][carry in][data]
-    u8 nextCarryIn[2][256];        // [carry in][data]
+    // The fill pattern lookup tables (shared by all instances)
+    static u8 fillPattern[2][2][256];     // [inclusive/exclusive][carry in][data]
+    static u8 nextCarryIn[2][256];        // [carry in][data]
 
 
     //
@@ -87,19 +87,19 @@ class Blitter : public AmigaComponent
     // Fast Blitter
     //
 
-    // The Fast Blitter's blit functions
-    void (Blitter::*blitfunc[32])(void);
+    // The Fast Blitter's blit functions (shared by all instances)
+    static void (Blitter::*blitfunc[32])(void);
 
 
     //
     // Slow Blitter
     //
 
-    // Micro-programs for copy blits
-    void (Blitter::*copyBlitInstr[16][2][2][6])(void);
+    // Micro-programs for copy blits (shared by all instances)
+    static void (Blitter::*copyBlitInstr[16][2][2][6])(void);
 
-    // Micro-program for line blits
-    void (Blitter::*lineBlitInstr[6])(void);
+    // Micro-program for line blits (shared by all instances)
+    static void (Blitter::*lineBlitInstr[6])(void);
 
     // The program counter indexing the micro instruction to execute
     u16 bltpc;
@@ -182,10 +182,13 @@ public:
 
     const char *getDescription() const override { return "Blitter"; }
     
-    void initFastBlitter();
-    void initSlowBlitter();
+private:
+    
+    // Sets up the lookup tables. Called once for all instances
+    static void initFillPatterns();
+    static void initFastBlitter();
+    static void initSlowBlitter();
 
-    void _initialize() override;
     void _reset(bool hard) override;
 
     
@@ -36,8 +36,8 @@ Blitter::initFastBlitter()
         &Blitter::doFastCopyBlit<1,1,1,1,0>, &Blitter::doFastCopyBlit<1,1,1,1,1>
     };
 
-    assert(sizeof(this->blitfunc) == sizeof(blitfunc));
-    memcpy(this->blitfunc, blitfunc, sizeof(blitfunc));
+    assert(sizeof(Blitter::blitfunc) == sizeof(blitfunc));
+    memcpy(Blitter::blitfunc, blitfunc, sizeof(blitfunc));
 }
 
 void
@@ -838,11 +838,11 @@ Blitter::initSlowBlitter()
     };
 
     // Copy all programs over
-    assert(sizeof(this->copyBlitInstr) == sizeof(copyBlitInstr));
-    memcpy(this->copyBlitInstr, copyBlitInstr, sizeof(copyBlitInstr));
+    assert(sizeof(Blitter::copyBlitInstr) == sizeof(copyBlitInstr));
+    memcpy(Blitter::copyBlitInstr, copyBlitInstr, sizeof(copyBlitInstr));
 
-    assert(sizeof(this->lineBlitInstr) == sizeof(lineBlitInstr));
-    memcpy(this->lineBlitInstr, lineBlitInstr, sizeof(lineBlitInstr));
+    assert(sizeof(Blitter::lineBlitInstr) == sizeof(lineBlitInstr));
+    memcpy(Blitter::lineBlitInstr, lineBlitInstr, sizeof(lineBlitInstr));
 }
 
 void
@@ -11,8 +11,10 @@
 #include "Agnus.h"
 #include "CIA.h"
 #include "CPU.h"
+#include "EventTracer.h"
 #include "Keyboard.h"
 #include "Paula.h"
+#include "Profiler.h"
 #include "UART.h"
 
 void
@@ -60,309 +62,299 @@ Agnus::inspectEventSlot(EventInfo &info, EventSlot nr) const
         i.frameRel = -1;
     }
 
-    switch ((EventSlot)nr) {
+    i.eventName = eventName((EventSlot)nr, slot[nr].id);
+}
+
+const char *
+Agnus::eventName(EventSlot slot, EventID id)
+{
+    assert_enum(EventSlot, slot);
+
+    switch (slot) {
 
         case SLOT_REG:
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case REG_CHANGE:    i.eventName = "REG_CHANGE"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case REG_CHANGE:    return "REG_CHANGE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_RAS:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case RAS_HSYNC:     i.eventName = "RAS_HSYNC"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case RAS_HSYNC:     return "RAS_HSYNC";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_CIAA:
         case SLOT_CIAB:
 
-            switch (slot[nr].id) {
-                case 0:             i.eventName = "none"; break;
-                case CIA_EXECUTE:   i.eventName = "CIA_EXECUTE"; break;
-                case CIA_WAKEUP:    i.eventName = "CIA_WAKEUP"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+            switch (id) {
+                case 0:             return "none";
+                case CIA_EXECUTE:   return "CIA_EXECUTE";
+                case CIA_WAKEUP:    return "CIA_WAKEUP";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_BPL:
 
-            switch ((int)slot[nr].id) {
-                case 0:                              i.eventName = "none"; break;
-                case DRAW_ODD:                       i.eventName = "BPL [O]"; break;
-                case DRAW_EVEN:                      i.eventName = "BPL [E]"; break;
-                case DRAW_ODD | DRAW_EVEN:           i.eventName = "BPL [OE]"; break;
-                case BPL_L1:                         i.eventName = "BPL_L1"; break;
-                case BPL_L1 | DRAW_ODD:              i.eventName = "BPL_L1 [O]"; break;
-                case BPL_L1 | DRAW_EVEN:             i.eventName = "BPL_L1 [E]"; break;
-                case BPL_L1 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L1 [OE]"; break;
-                case BPL_L2:                         i.eventName = "BPL_L2"; break;
-                case BPL_L2 | DRAW_ODD:              i.eventName = "BPL_L2 [O]"; break;
-                case BPL_L2 | DRAW_EVEN:             i.eventName = "BPL_L2 [E]"; break;
-                case BPL_L2 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L2 [OE]"; break;
-                case BPL_L3:                         i.eventName = "BPL_L3"; break;
-                case BPL_L3 | DRAW_ODD:              i.eventName = "BPL_L3 [O]"; break;
-                case BPL_L3 | DRAW_EVEN:             i.eventName = "BPL_L3 [E]"; break;
-                case BPL_L3 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L3 [OE]"; break;
-                case BPL_L4:                         i.eventName = "BPL_L4"; break;
-                case BPL_L4 | DRAW_ODD:              i.eventName = "BPL_L4 [O]"; break;
-                case BPL_L4 | DRAW_EVEN:             i.eventName = "BPL_L4 [E]"; break;
-                case BPL_L4 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L4 [OE]"; break;
-                case BPL_L5:                         i.eventName = "BPL_L5"; break;
-                case BPL_L5 | DRAW_ODD:              i.eventName = "BPL_L5 [O]"; break;
-                case BPL_L5 | DRAW_EVEN:             i.eventName = "BPL_L5 [E]"; break;
-                case BPL_L5 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L5 [OE]"; break;
-                case BPL_L6:                         i.eventName = "BPL_L6"; break;
-                case BPL_L6 | DRAW_ODD:              i.eventName = "BPL_L6 [O]"; break;
-                case BPL_L6 | DRAW_EVEN:             i.eventName = "BPL_L6 [E]"; break;
-                case BPL_L6 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_L6 [OE]"; break;
-                case BPL_H1:                         i.eventName = "BPL_H1"; break;
-                case BPL_H1 | DRAW_ODD:              i.eventName = "BPL_H1 [O]"; break;
-                case BPL_H1 | DRAW_EVEN:             i.eventName = "BPL_H1 [E]"; break;
-                case BPL_H1 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_H1 [OE]"; break;
-                case BPL_H2:                         i.eventName = "BPL_H2"; break;
-                case BPL_H2 | DRAW_ODD:              i.eventName = "BPL_H2 [O]"; break;
-                case BPL_H2 | DRAW_EVEN:             i.eventName = "BPL_H2 [E]"; break;
-                case BPL_H2 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_H2 [OE]"; break;
-                case BPL_H3:                         i.eventName = "BPL_H3"; break;
-                case BPL_H3 | DRAW_ODD:              i.eventName = "BPL_H3 [O]"; break;
-                case BPL_H3 | DRAW_EVEN:             i.eventName = "BPL_H3 [E]"; break;
-                case BPL_H3 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_H3 [OE]"; break;
-                case BPL_H4:                         i.eventName = "BPL_H4"; break;
-                case BPL_H4 | DRAW_ODD:              i.eventName = "BPL_H4 [O]"; break;
-                case BPL_H4 | DRAW_EVEN:             i.eventName = "BPL_H4 [E]"; break;
-                case BPL_H4 | DRAW_ODD | DRAW_EVEN:  i.eventName = "BPL_H4 [OE]"; break;
-                case BPL_EOL:                        i.eventName = "BPL_EOL"; break;
-                case BPL_EOL | DRAW_ODD:             i.eventName = "BPL_EOL [O]"; break;
-                case BPL_EOL | DRAW_EVEN:            i.eventName = "BPL_EOL [E]"; break;
-                case BPL_EOL | DRAW_ODD | DRAW_EVEN: i.eventName = "BPL_EOL [OE]"; break;
-                default:                             i.eventName = "*** INVALID ***"; break;
+            switch ((int)id) {
+                case 0:                              return "none";
+                case DRAW_ODD:                       return "BPL [O]";
+                case DRAW_EVEN:                      return "BPL [E]";
+                case DRAW_ODD | DRAW_EVEN:           return "BPL [OE]";
+                case BPL_L1:                         return "BPL_L1";
+                case BPL_L1 | DRAW_ODD:              return "BPL_L1 [O]";
+                case BPL_L1 | DRAW_EVEN:             return "BPL_L1 [E]";
+                case BPL_L1 | DRAW_ODD | DRAW_EVEN:  return "BPL_L1 [OE]";
+                case BPL_L2:                         return "BPL_L2";
+                case BPL_L2 | DRAW_ODD:              return "BPL_L2 [O]";
+                case BPL_L2 | DRAW_EVEN:             return "BPL_L2 [E]";
+                case BPL_L2 | DRAW_ODD | DRAW_EVEN:  return "BPL_L2 [OE]";
+                case BPL_L3:                         return "BPL_L3";
+                case BPL_L3 | DRAW_ODD:              return "BPL_L3 [O]";
+                case BPL_L3 | DRAW_EVEN:             return "BPL_L3 [E]";
+                case BPL_L3 | DRAW_ODD | DRAW_EVEN:  return "BPL_L3 [OE]";
+                case BPL_L4:                         return "BPL_L4";
+                case BPL_L4 | DRAW_ODD:              return "BPL_L4 [O]";
+                case BPL_L4 | DRAW_EVEN:             return "BPL_L4 [E]";
+                case BPL_L4 | DRAW_ODD | DRAW_EVEN:  return "BPL_L4 [OE]";
+                case BPL_L5:                         return "BPL_L5";
+                case BPL_L5 | DRAW_ODD:              return "BPL_L5 [O]";
+                case BPL_L5 | DRAW_EVEN:             return "BPL_L5 [E]";
+                case BPL_L5 | DRAW_ODD | DRAW_EVEN:  return "BPL_L5 [OE]";
+                case BPL_L6:                         return "BPL_L6";
+                case BPL_L6 | DRAW_ODD:              return "BPL_L6 [O]";
+                case BPL_L6 | DRAW_EVEN:             return "BPL_L6 [E]";
+                case BPL_L6 | DRAW_ODD | DRAW_EVEN:  return "BPL_L6 [OE]";
+                case BPL_H1:                         return "BPL_H1";
+                case BPL_H1 | DRAW_ODD:              return "BPL_H1 [O]";
+                case BPL_H1 | DRAW_EVEN:             return "BPL_H1 [E]";
+                case BPL_H1 | DRAW_ODD | DRAW_EVEN:  return "BPL_H1 [OE]";
+                case BPL_H2:                         return "BPL_H2";
+                case BPL_H2 | DRAW_ODD:              return "BPL_H2 [O]";
+                case BPL_H2 | DRAW_EVEN:             return "BPL_H2 [E]";
+                case BPL_H2 | DRAW_ODD | DRAW_EVEN:  return "BPL_H2 [OE]";
+                case BPL_H3:                         return "BPL_H3";
+                case BPL_H3 | DRAW_ODD:              return "BPL_H3 [O]";
+                case BPL_H3 | DRAW_EVEN:             return "BPL_H3 [E]";
+                case BPL_H3 | DRAW_ODD | DRAW_EVEN:  return "BPL_H3 [OE]";
+                case BPL_H4:                         return "BPL_H4";
+                case BPL_H4 | DRAW_ODD:              return "BPL_H4 [O]";
+                case BPL_H4 | DRAW_EVEN:             return "BPL_H4 [E]";
+                case BPL_H4 | DRAW_ODD | DRAW_EVEN:  return "BPL_H4 [OE]";
+                case BPL_EOL:                        return "BPL_EOL";
+                case BPL_EOL | DRAW_ODD:             return "BPL_EOL [O]";
+                case BPL_EOL | DRAW_EVEN:            return "BPL_EOL [E]";
+                case BPL_EOL | DRAW_ODD | DRAW_EVEN: return "BPL_EOL [OE]";
+                default:                             return "*** INVALID ***";
             }
-            break;
 
         case SLOT_DAS:
 
-            switch (slot[nr].id) {
-                case 0:             i.eventName = "none"; break;
-                case DAS_REFRESH:   i.eventName = "DAS_REFRESH"; break;
-                case DAS_D0:        i.eventName = "DAS_D0"; break;
-                case DAS_D1:        i.eventName = "DAS_D1"; break;
-                case DAS_D2:        i.eventName = "DAS_D2"; break;
-                case DAS_A0:        i.eventName = "DAS_A0"; break;
-                case DAS_A1:        i.eventName = "DAS_A1"; break;
-                case DAS_A2:        i.eventName = "DAS_A2"; break;
-                case DAS_A3:        i.eventName = "DAS_A3"; break;
-                case DAS_S0_1:      i.eventName = "DAS_S0_1"; break;
-                case DAS_S0_2:      i.eventName = "DAS_S0_2"; break;
-                case DAS_S1_1:      i.eventName = "DAS_S1_1"; break;
-                case DAS_S1_2:      i.eventName = "DAS_S1_2"; break;
-                case DAS_S2_1:      i.eventName = "DAS_S2_2"; break;
-                case DAS_S3_1:      i.eventName = "DAS_S3_1"; break;
-                case DAS_S3_2:      i.eventName = "DAS_S3_2"; break;
-                case DAS_S4_1:      i.eventName = "DAS_S4_1"; break;
-                case DAS_S4_2:      i.eventName = "DAS_S4_2"; break;
-                case DAS_S5_1:      i.eventName = "DAS_S5_1"; break;
-                case DAS_S5_2:      i.eventName = "DAS_S5_2"; break;
-                case DAS_S6_1:      i.eventName = "DAS_S6_1"; break;
-                case DAS_S6_2:      i.eventName = "DAS_S6_2"; break;
-                case DAS_S7_1:      i.eventName = "DAS_S7_1"; break;
-                case DAS_S7_2:      i.eventName = "DAS_S7_2"; break;
-                case DAS_SDMA:      i.eventName = "DAS_SDMA"; break;
-                case DAS_TICK:      i.eventName = "DAS_TICK"; break;
-                case DAS_TICK2:     i.eventName = "DAS_TICK2"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+            switch (id) {
+                case 0:             return "none";
+                case DAS_REFRESH:   return "DAS_REFRESH";
+                case DAS_D0:        return "DAS_D0";
+                case DAS_D1:        return "DAS_D1";
+                case DAS_D2:        return "DAS_D2";
+                case DAS_A0:        return "DAS_A0";
+                case DAS_A1:        return "DAS_A1";
+                case DAS_A2:        return "DAS_A2";
+                case DAS_A3:        return "DAS_A3";
+                case DAS_S0_1:      return "DAS_S0_1";
+                case DAS_S0_2:      return "DAS_S0_2";
+                case DAS_S1_1:      return "DAS_S1_1";
+                case DAS_S1_2:      return "DAS_S1_2";
+                case DAS_S2_1:      return "DAS_S2_2";
+                case DAS_S3_1:      return "DAS_S3_1";
+                case DAS_S3_2:      return "DAS_S3_2";
+                case DAS_S4_1:      return "DAS_S4_1";
+                case DAS_S4_2:      return "DAS_S4_2";
+                case DAS_S5_1:      return "DAS_S5_1";
+                case DAS_S5_2:      return "DAS_S5_2";
+                case DAS_S6_1:      return "DAS_S6_1";
+                case DAS_S6_2:      return "DAS_S6_2";
+                case DAS_S7_1:      return "DAS_S7_1";
+                case DAS_S7_2:      return "DAS_S7_2";
+                case DAS_SDMA:      return "DAS_SDMA";
+                case DAS_TICK:      return "DAS_TICK";
+                case DAS_TICK2:     return "DAS_TICK2";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_COP:
 
-            switch (slot[nr].id) {
-
-                case 0:                i.eventName = "none"; break;
-                case COP_REQ_DMA:      i.eventName = "COP_REQ_DMA"; break;
-                case COP_WAKEUP:       i.eventName = "COP_WAKEUP"; break;
-                case COP_WAKEUP_BLIT:  i.eventName = "COP_WAKEUP_BLIT"; break;
-                case COP_FETCH:        i.eventName = "COP_FETCH"; break;
-                case COP_MOVE:         i.eventName = "COP_MOVE"; break;
-                case COP_WAIT_OR_SKIP: i.eventName = "WAIT_OR_SKIP"; break;
-                case COP_WAIT1:        i.eventName = "COP_WAIT1"; break;
-                case COP_WAIT2:        i.eventName = "COP_WAIT2"; break;
-                case COP_WAIT_BLIT:    i.eventName = "COP_WAIT_BLIT"; break;
-                case COP_SKIP1:        i.eventName = "COP_SKIP1"; break;
-                case COP_SKIP2:        i.eventName = "COP_SKIP1"; break;
-                case COP_JMP1:         i.eventName = "COP_JMP1"; break;
-                case COP_JMP2:         i.eventName = "COP_JMP2"; break;
-                case COP_VBLANK:       i.eventName = "COP_VBLANK"; break;
-                default:               i.eventName = "*** INVALID ***"; break;
+            switch (id) {
+
+                case 0:                return "none";
+                case COP_REQ_DMA:      return "COP_REQ_DMA";
+                case COP_WAKEUP:       return "COP_WAKEUP";
+                case COP_WAKEUP_BLIT:  return "COP_WAKEUP_BLIT";
+                case COP_FETCH:        return "COP_FETCH";
+                case COP_MOVE:         return "COP_MOVE";
+                case COP_WAIT_OR_SKIP: return "WAIT_OR_SKIP";
+                case COP_WAIT1:        return "COP_WAIT1";
+                case COP_WAIT2:        return "COP_WAIT2";
+                case COP_WAIT_BLIT:    return "COP_WAIT_BLIT";
+                case COP_SKIP1:        return "COP_SKIP1";
+                case COP_SKIP2:        return "COP_SKIP1";
+                case COP_JMP1:         return "COP_JMP1";
+                case COP_JMP2:         return "COP_JMP2";
+                case COP_VBLANK:       return "COP_VBLANK";
+                default:               return "*** INVALID ***";
             }
-            break;
 
         case SLOT_BLT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case BLT_STRT1:     i.eventName = "BLT_STRT1"; break;
-                case BLT_STRT2:     i.eventName = "BLT_STRT2"; break;
-                case BLT_COPY_SLOW: i.eventName = "BLT_COPY_SLOW"; break;
-                case BLT_COPY_FAKE: i.eventName = "BLT_COPY_FAKE"; break;
-                case BLT_LINE_FAKE: i.eventName = "BLT_LINE_FAKE"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case BLT_STRT1:     return "BLT_STRT1";
+                case BLT_STRT2:     return "BLT_STRT2";
+                case BLT_COPY_SLOW: return "BLT_COPY_SLOW";
+                case BLT_COPY_FAKE: return "BLT_COPY_FAKE";
+                case BLT_LINE_FAKE: return "BLT_LINE_FAKE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_SEC:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case SEC_TRIGGER:   i.eventName = "SEC_TRIGGER"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case SEC_TRIGGER:   return "SEC_TRIGGER";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_CH0:
         case SLOT_CH1:
         case SLOT_CH2:
         case SLOT_CH3:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case CHX_PERFIN:    i.eventName = "CHX_PERFIN"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case CHX_PERFIN:    return "CHX_PERFIN";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_DSK:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case DSK_ROTATE:    i.eventName = "DSK_ROTATE"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case DSK_ROTATE:    return "DSK_ROTATE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_DCH:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case DCH_INSERT:    i.eventName = "DCH_INSERT"; break;
-                case DCH_EJECT:     i.eventName = "DCH_EJECT"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case DCH_INSERT:    return "DCH_INSERT";
+                case DCH_EJECT:     return "DCH_EJECT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_VBL:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case VBL_STROBE0:   i.eventName = "VBL_STROBE0"; break;
-                case VBL_STROBE1:   i.eventName = "VBL_STROBE1"; break;
-                case VBL_STROBE2:   i.eventName = "VBL_STROBE2"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case VBL_STROBE0:   return "VBL_STROBE0";
+                case VBL_STROBE1:   return "VBL_STROBE1";
+                case VBL_STROBE2:   return "VBL_STROBE2";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_IRQ:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case IRQ_CHECK:     i.eventName = "IRQ_CHECK"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case IRQ_CHECK:     return "IRQ_CHECK";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_IPL:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case IPL_CHANGE:    i.eventName = "IPL_CHANGE"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case IPL_CHANGE:    return "IPL_CHANGE";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_KBD:
 
-            switch (slot[nr].id) {
-
-                case 0:             i.eventName = "none"; break;
-                case KBD_TIMEOUT:   i.eventName = "KBD_TIMEOUT"; break;
-                case KBD_DAT:       i.eventName = "KBD_DAT"; break;
-                case KBD_CLK0:      i.eventName = "KBD_CLK0"; break;
-                case KBD_CLK1:      i.eventName = "KBD_CLK1"; break;
-                case KBD_SYNC_DAT0: i.eventName = "KBD_SYNC_DAT0"; break;
-                case KBD_SYNC_CLK0: i.eventName = "KBD_SYNC_CLK0"; break;
-                case KBD_SYNC_DAT1: i.eventName = "KBD_SYNC_DAT1"; break;
-                case KBD_SYNC_CLK1: i.eventName = "KBD_SYNC_CLK1"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+            switch (id) {
+
+                case 0:             return "none";
+                case KBD_TIMEOUT:   return "KBD_TIMEOUT";
+                case KBD_DAT:       return "KBD_DAT";
+                case KBD_CLK0:      return "KBD_CLK0";
+                case KBD_CLK1:      return "KBD_CLK1";
+                case KBD_SYNC_DAT0: return "KBD_SYNC_DAT0";
+                case KBD_SYNC_CLK0: return "KBD_SYNC_CLK0";
+                case KBD_SYNC_DAT1: return "KBD_SYNC_DAT1";
+                case KBD_SYNC_CLK1: return "KBD_SYNC_CLK1";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_TXD:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case TXD_BIT:       i.eventName = "TXD_BIT"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case TXD_BIT:       return "TXD_BIT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_RXD:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case RXD_BIT:       i.eventName = "RXD_BIT"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case RXD_BIT:       return "RXD_BIT";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         case SLOT_POT:
 
-            switch (slot[nr].id) {
+            switch (id) {
 
-                case 0:             i.eventName = "none"; break;
-                case POT_DISCHARGE: i.eventName = "POT_DISCHARGE"; break;
-                case POT_CHARGE:    i.eventName = "POT_CHARGE"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+                case 0:             return "none";
+                case POT_DISCHARGE: return "POT_DISCHARGE";
+                case POT_CHARGE:    return "POT_CHARGE";
+                default:            return "*** INVALID ***";
             }
-            break;
             
         case SLOT_INS:
 
-            switch (slot[nr].id) {
-
-                case 0:             i.eventName = "none"; break;
-                case INS_NONE:      i.eventName = "INS_NONE"; break;
-                case INS_AMIGA:     i.eventName = "INS_AMIGA"; break;
-                case INS_CPU:       i.eventName = "INS_CPU"; break;
-                case INS_MEM:       i.eventName = "INS_MEM"; break;
-                case INS_CIA:       i.eventName = "INS_CIA"; break;
-                case INS_AGNUS:     i.eventName = "INS_AGNUS"; break;
-                case INS_PAULA:     i.eventName = "INS_PAULA"; break;
-                case INS_DENISE:    i.eventName = "INS_DENISE"; break;
-                case INS_PORTS:     i.eventName = "INS_PORTS"; break;
-                case INS_EVENTS:    i.eventName = "INS_EVENTS"; break;
-                default:            i.eventName = "*** INVALID ***"; break;
+            switch (id) {
+
+                case 0:             return "none";
+                case INS_NONE:      return "INS_NONE";
+                case INS_AMIGA:     return "INS_AMIGA";
+                case INS_CPU:       return "INS_CPU";
+                case INS_MEM:       return "INS_MEM";
+                case INS_CIA:       return "INS_CIA";
+                case INS_AGNUS:     return "INS_AGNUS";
+                case INS_PAULA:     return "INS_PAULA";
+                case INS_DENISE:    return "INS_DENISE";
+                case INS_PORTS:     return "INS_PORTS";
+                case INS_EVENTS:    return "INS_EVENTS";
+                default:            return "*** INVALID ***";
             }
-            break;
 
         default: assert(false);
     }
+    return "*** INVALID ***";
 }
 
 EventInfo
@@ -451,27 +443,43 @@ Agnus::executeEventsUntil(Cycle cycle) {
     //
 
     if (isDue<SLOT_RAS>(cycle)) {
+        PROFILE_SLOT(SLOT_RAS);
+        TRACE_SLOT(SLOT_RAS);
         serviceRASEvent();
     }
     if (isDue<SLOT_REG>(cycle)) {
+        PROFILE_SLOT(SLOT_REG);
+        TRACE_SLOT(SLOT_REG);
         serviceREGEvent(cycle);
     }
     if (isDue<SLOT_CIAA>(cycle)) {
+        PROFILE_SLOT(SLOT_CIAA);
+        TRACE_SLOT(SLOT_CIAA);
         serviceCIAEvent<0>();
     }
     if (isDue<SLOT_CIAB>(cycle)) {
+        PROFILE_SLOT(SLOT_CIAB);
+        TRACE_SLOT(SLOT_CIAB);
         serviceCIAEvent<1>();
     }
     if (isDue<SLOT_BPL>(cycle)) {
+        PROFILE_SLOT(SLOT_BPL);
+        TRACE_SLOT(SLOT_BPL);
         serviceBPLEvent();
     }
     if (isDue<SLOT_DAS>(cycle)) {
+        PROFILE_SLOT(SLOT_DAS);
+        TRACE_SLOT(SLOT_DAS);
         serviceDASEvent();
     }
     if (isDue<SLOT_COP>(cycle)) {
+        PROFILE_SLOT(SLOT_COP);
+        TRACE_SLOT(SLOT_COP);
         copper.serviceEvent(slot[SLOT_COP].id);
     }
     if (isDue<SLOT_BLT>(cycle)) {
+        PROFILE_SLOT(SLOT_BLT);
+        TRACE_SLOT(SLOT_BLT);
         blitter.serviceEvent();
     }
 
@@ -481,46 +489,77 @@ Agnus::executeEventsUntil(Cycle cycle) {
         // Check secondary slots
         //
 
+        PROFILE_SLOT(SLOT_SEC);
+        TRACE_SLOT(SLOT_SEC);
+
         if (isDue<SLOT_CH0>(cycle)) {
+            PROFILE_SLOT(SLOT_CH0);
+            TRACE_SLOT(SLOT_CH0);
             paula.channel0.serviceEvent();
         }
         if (isDue<SLOT_CH1>(cycle)) {
+            PROFILE_SLOT(SLOT_CH1);
+            TRACE_SLOT(SLOT_CH1);
             paula.channel1.serviceEvent();
         }
         if (isDue<SLOT_CH2>(cycle)) {
+            PROFILE_SLOT(SLOT_CH2);
+            TRACE_SLOT(SLOT_CH2);
             paula.channel2.serviceEvent();
         }
         if (isDue<SLOT_CH3>(cycle)) {
+            PROFILE_SLOT(SLOT_CH3);
+            TRACE_SLOT(SLOT_CH3);
             paula.channel3.serviceEvent();
         }
         if (isDue<SLOT_DSK>(cycle)) {
+            PROFILE_SLOT(SLOT_DSK);
+            TRACE_SLOT(SLOT_DSK);
             paula.diskController.serviceDiskEvent();
         }
         if (isDue<SLOT_DCH>(cycle)) {
+            PROFILE_SLOT(SLOT_DCH);
+            TRACE_SLOT(SLOT_DCH);
             paula.diskController.serviceDiskChangeEvent();
         }
         if (isDue<SLOT_VBL>(cycle)) {
+            PROFILE_SLOT(SLOT_VBL);
+            TRACE_SLOT(SLOT_VBL);
             serviceVblEvent();
         }
         if (isDue<SLOT_IRQ>(cycle)) {
+            PROFILE_SLOT(SLOT_IRQ);
+            TRACE_SLOT(SLOT_IRQ);
             paula.serviceIrqEvent();
         }
         if (isDue<SLOT_KBD>(cycle)) {
+            PROFILE_SLOT(SLOT_KBD);
+            TRACE_SLOT(SLOT_KBD);
             keyboard.serviceKeyboardEvent(slot[SLOT_KBD].id);
         }
         if (isDue<SLOT_TXD>(cycle)) {
+            PROFILE_SLOT(SLOT_TXD);
+            TRACE_SLOT(SLOT_TXD);
             uart.serviceTxdEvent(slot[SLOT_TXD].id);
         }
         if (isDue<SLOT_RXD>(cycle)) {
+            PROFILE_SLOT(SLOT_RXD);
+            TRACE_SLOT(SLOT_RXD);
             uart.serviceRxdEvent(slot[SLOT_RXD].id);
         }
         if (isDue<SLOT_POT>(cycle)) {
+            PROFILE_SLOT(SLOT_POT);
+            TRACE_SLOT(SLOT_POT);
             paula.servicePotEvent(slot[SLOT_POT].id);
         }
         if (isDue<SLOT_IPL>(cycle)) {
+            PROFILE_SLOT(SLOT_IPL);
+            TRACE_SLOT(SLOT_IPL);
             paula.serviceIplEvent();
         }
         if (isDue<SLOT_INS>(cycle)) {
+            PROFILE_SLOT(SLOT_INS);
+            TRACE_SLOT(SLOT_INS);
             serviceINSEvent();
         }
 
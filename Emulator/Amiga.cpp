@@ -10,6 +10,9 @@
 #include "config.h"
 #include "Amiga.h"
 #include "Snapshot.h"
+#include "MappedSnapshot.h"
+#include "DeltaSnapshot.h"
+#include <memory>
 
 // Perform some consistency checks
 static_assert(sizeof(i8) == 1,  "i8 size mismatch");
@@ -98,7 +101,13 @@ Amiga::Amiga()
         &ciaB,
         &mem,
         &cpu,
-        &queue
+        &queue,
+        &rewindBuffer,
+        &runAhead,
+        &bootCache,
+        &inputRecorder,
+        &profiler,
+        &tracer
     };
 
     // Set up the initial state
@@ -256,6 +265,18 @@ Amiga::getConfigItem(Option option) const
         case OPT_ACCURATE_KEYBOARD:
             return keyboard.getConfigItem(option);
 
+        case OPT_REWIND:
+        case OPT_REWIND_INTERVAL:
+        case OPT_REWIND_DURATION:
+        case OPT_REWIND_BUDGET:
+            return rewindBuffer.getConfigItem(option);
+
+        case OPT_RUN_AHEAD:
+            return runAhead.getConfigItem(option);
+
+        case OPT_BOOT_CACHE:
+            return bootCache.getConfigItem(option);
+
         default: assert(false); return 0;
     }
 }
@@ -286,6 +307,7 @@ Amiga::getConfigItem(Option option, long id) const
             return df[id]->getConfigItem(option);
             
         case OPT_PULLUP_RESISTORS:
+        case OPT_SHAKE_DETECTION:
         case OPT_MOUSE_VELOCITY:
             if (id == PORT_1) return controlPort1.mouse.getConfigItem(option);
             if (id == PORT_2) return controlPort2.mouse.getConfigItem(option);
@@ -305,6 +327,9 @@ Amiga::configure(Option option, long value)
     
     // Inform the GUI if the configuration has changed
     if (changed) queue.put(MSG_CONFIG);
+
+    // Log the change if input is recorded
+    if (changed) inputRecorder.recordConfig(option, -1, value);
     
     // Dump the current configuration in debug mode
     if (changed && CNF_DEBUG) dump(Dump::Config);
@@ -321,12 +346,34 @@ Amiga::configure(Option option, long id, long value)
     // Inform the GUI if the configuration has changed
     if (changed) queue.put(MSG_CONFIG);
 
+    // Log the change if input is recorded
+    if (changed) inputRecorder.recordConfig(option, id, value);
+
     // Dump the current configuration in debug mode
     if (changed && CNF_DEBUG) dump(Dump::Config);
         
     return changed;
 }
 
+bool
+Amiga::configureInRunLoop(Option option, long id, long value)
+{
+    assert(!inRunLoop);
+
+    bool result;
+    inRunLoop = true;
+
+    try {
+        result = id < 0 ? configure(option, value) : configure(option, id, value);
+    } catch (...) {
+        inRunLoop = false;
+        throw;
+    }
+
+    inRunLoop = false;
+    return result;
+}
+
 EventID
 Amiga::getInspectionTarget() const
 {
@@ -390,7 +437,7 @@ Amiga::powerOn()
         
     if (isPoweredOff() && isReady()) {
         
-        assert(p == nullptr);
+        assert(p == (pthread_t)0);
         
         // Perform a hard reset
         hardReset();
@@ -401,6 +448,9 @@ Amiga::powerOn()
         // Power on all subcomponents
         HardwareComponent::powerOn();
         
+        // Skip the boot if a cached state is available
+        bootCache.restore();
+
         // Update the recorded debug information
         inspect();
 
@@ -476,7 +526,7 @@ Amiga::run()
             
     if (!isRunning() && isReady()) {
         
-        assert(p == nullptr);
+        assert(p == (pthread_t)0);
 
         // Switch state
         state = EMULATOR_STATE_RUNNING;
@@ -633,6 +683,8 @@ void
 Amiga::suspend()
 {
     debug(RUN_DEBUG, "Suspending (%zu)...\n", suspendCounter);
+
+    if (inRunLoop) return;
     
     if (suspendCounter || isRunning()) {
         pause();
@@ -644,6 +696,8 @@ void
 Amiga::resume()
 {
     debug(RUN_DEBUG, "Resuming (%zu)...\n", suspendCounter);
+
+    if (inRunLoop) return;
     
     if (suspendCounter && --suspendCounter == 0) {
         run();
@@ -723,78 +777,155 @@ Amiga::runLoop()
     while(1) {
         
         // Emulate the next CPU instruction
-        cpu.execute();
+        {
+            PROFILE(PROF_CPU);
+            cpu.execute();
+        }
 
         // Check if special action needs to be taken
-        if (runLoopCtrl) {
-            
-            // Are we requested to take a snapshot?
-            if (runLoopCtrl & RL_AUTO_SNAPSHOT) {
-                debug(RUN_DEBUG, "RL_AUTO_SNAPSHOT\n");
-                autoSnapshot = Snapshot::makeWithAmiga(this);
-                queue.put(MSG_AUTO_SNAPSHOT_TAKEN);
-                clearControlFlags(RL_AUTO_SNAPSHOT);
-            }
-            
-            if (runLoopCtrl & RL_USER_SNAPSHOT) {
-                debug(RUN_DEBUG, "RL_USER_SNAPSHOT\n");
-                userSnapshot = Snapshot::makeWithAmiga(this);
-                queue.put(MSG_USER_SNAPSHOT_TAKEN);
-                clearControlFlags(RL_USER_SNAPSHOT);
-            }
-
-            // Are we requested to update the debugger info structs?
-            if (runLoopCtrl & RL_INSPECT) {
-                debug(RUN_DEBUG, "RL_INSPECT\n");
-                inspect();
-                clearControlFlags(RL_INSPECT);
-            }
-
-            // Did we reach a breakpoint?
-            if (runLoopCtrl & RL_BREAKPOINT_REACHED) {
-                inspect();
-                queue.put(MSG_BREAKPOINT_REACHED);
-                debug(RUN_DEBUG, "BREAKPOINT_REACHED pc: %x\n", cpu.getPC());
-                clearControlFlags(RL_BREAKPOINT_REACHED);
-                break;
-            }
-
-            // Did we reach a watchpoint?
-            if (runLoopCtrl & RL_WATCHPOINT_REACHED) {
-                inspect();
-                queue.put(MSG_WATCHPOINT_REACHED);
-                debug(RUN_DEBUG, "WATCHPOINT_REACHED pc: %x\n", cpu.getPC());
-                clearControlFlags(RL_WATCHPOINT_REACHED);
-                break;
-            }
-
-            // Are we requested to terminate the run loop?
-            if (runLoopCtrl & RL_STOP) {
-                clearControlFlags(RL_STOP);
-                debug(RUN_DEBUG, "RL_STOP\n");
-                break;
-            }
-
-            // Are we requested to enter of exit warp mode?
-            if (runLoopCtrl & RL_WARP_ON) {
-                clearControlFlags(RL_WARP_ON);
-                debug(RUN_DEBUG, "RL_WARP_ON\n");
-                warpOn();
-            }
-
-            if (runLoopCtrl & RL_WARP_OFF) {
-                clearControlFlags(RL_WARP_OFF);
-                debug(RUN_DEBUG, "RL_WARP_OFF\n");
-                warpOff();
-            }
-        }
+        if (runLoopCtrl && !processControlFlags()) break;
     }
     
+    agnus.syncWithCPU();
+    
     // Switch state
     state = EMULATOR_STATE_PAUSED;
     HardwareComponent::pause();    
 }
 
+bool
+Amiga::processControlFlags()
+{
+    agnus.syncWithCPU();
+    
+    // Are we requested to take a snapshot?
+    if (runLoopCtrl & RL_AUTO_SNAPSHOT) {
+        debug(RUN_DEBUG, "RL_AUTO_SNAPSHOT\n");
+        autoSnapshot = Snapshot::makeWithAmiga(this);
+        queue.put(MSG_AUTO_SNAPSHOT_TAKEN);
+        clearControlFlags(RL_AUTO_SNAPSHOT);
+    }
+    
+    if (runLoopCtrl & RL_USER_SNAPSHOT) {
+        debug(RUN_DEBUG, "RL_USER_SNAPSHOT\n");
+        userSnapshot = Snapshot::makeWithAmiga(this);
+        queue.put(MSG_USER_SNAPSHOT_TAKEN);
+        clearControlFlags(RL_USER_SNAPSHOT);
+    }
+
+    if (runLoopCtrl & RL_REWIND_SNAPSHOT) {
+        debug(RUN_DEBUG, "RL_REWIND_SNAPSHOT\n");
+        rewindBuffer.takeCheckpoint();
+        clearControlFlags(RL_REWIND_SNAPSHOT);
+    }
+
+    if (runLoopCtrl & RL_RUN_AHEAD) {
+        clearControlFlags(RL_RUN_AHEAD);
+        runAhead.execute();
+    }
+
+    if (runLoopCtrl & RL_BOOT_SNAPSHOT) {
+        debug(RUN_DEBUG, "RL_BOOT_SNAPSHOT\n");
+        clearControlFlags(RL_BOOT_SNAPSHOT);
+        bootCache.store();
+    }
+
+    // Are we requested to update the debugger info structs?
+    if (runLoopCtrl & RL_INSPECT) {
+        debug(RUN_DEBUG, "RL_INSPECT\n");
+        inspect();
+        clearControlFlags(RL_INSPECT);
+    }
+
+    // Did we reach a breakpoint?
+    if (runLoopCtrl & RL_BREAKPOINT_REACHED) {
+        inspect();
+        queue.put(MSG_BREAKPOINT_REACHED);
+        debug(RUN_DEBUG, "BREAKPOINT_REACHED pc: %x\n", cpu.getPC());
+        clearControlFlags(RL_BREAKPOINT_REACHED);
+        return false;
+    }
+
+    // Did we reach a watchpoint?
+    if (runLoopCtrl & RL_WATCHPOINT_REACHED) {
+        inspect();
+        queue.put(MSG_WATCHPOINT_REACHED);
+        debug(RUN_DEBUG, "WATCHPOINT_REACHED pc: %x\n", cpu.getPC());
+        clearControlFlags(RL_WATCHPOINT_REACHED);
+        return false;
+    }
+
+    // Are we requested to terminate the run loop?
+    if (runLoopCtrl & RL_STOP) {
+        clearControlFlags(RL_STOP);
+        debug(RUN_DEBUG, "RL_STOP\n");
+        return false;
+    }
+
+    // Are we requested to enter of exit warp mode?
+    if (runLoopCtrl & RL_WARP_ON) {
+        clearControlFlags(RL_WARP_ON);
+        debug(RUN_DEBUG, "RL_WARP_ON\n");
+        warpOn();
+    }
+
+    if (runLoopCtrl & RL_WARP_OFF) {
+        clearControlFlags(RL_WARP_OFF);
+        debug(RUN_DEBUG, "RL_WARP_OFF\n");
+        warpOff();
+    }
+
+    // Are we requested to replay recorded input?
+    if (runLoopCtrl & RL_INPUT) {
+        if (!inputRecorder.replay()) clearControlFlags(RL_INPUT);
+    }
+    
+    return true;
+}
+
+bool
+Amiga::executeFrame()
+{
+    return executeSync(NEVER, agnus.frame.nr + 1);
+}
+
+bool
+Amiga::executeCycles(Cycle cycles)
+{
+    return executeSync(agnus.clock + cycles, INT64_MAX);
+}
+
+bool
+Amiga::executeSync(Cycle cycle, i64 frame)
+{
+    assert(isPoweredOn());
+    assert(!isRunning());
+    
+    // Enable or disable debugging features
+    if (debugMode) {
+        cpu.debugger.enableLogging();
+    } else {
+        cpu.debugger.disableLogging();
+    }
+
+    bool result = true;
+    
+    while (cpu.getMasterClock() < cycle && agnus.frame.nr < frame) {
+        
+        // Emulate the next CPU instruction
+        {
+            PROFILE(PROF_CPU);
+            cpu.execute();
+        }
+
+        // Check if special action needs to be taken
+        if (runLoopCtrl && !processControlFlags()) { result = false; break; }
+    }
+    
+    agnus.syncWithCPU();
+    return result;
+}
+
 void
 Amiga::requestAutoSnapshot()
 {
@@ -863,3 +994,125 @@ Amiga::loadFromSnapshotSafe(Snapshot *snapshot)
     loadFromSnapshotUnsafe(snapshot);
     resume();
 }
+
+void
+Amiga::loadFromSnapshotUnsafe(const MappedSnapshot &snapshot)
+{
+    snapshot.restore(*this);
+    queue.put(MSG_SNAPSHOT_RESTORED);
+}
+
+void
+Amiga::loadFromSnapshotSafe(const MappedSnapshot &snapshot)
+{
+    trace(SNP_DEBUG, "loadFromSnapshotSafe\n");
+
+    suspend();
+    try { loadFromSnapshotUnsafe(snapshot); } catch (VAError &err) {
+        resume();
+        throw err;
+    }
+    resume();
+}
+
+DeltaSnapshot *
+Amiga::takeDeltaSnapshot(bool keyframe)
+{
+    return DeltaSnapshot::makeWithAmiga(this, deltaChain, keyframe);
+}
+
+void
+Amiga::loadFromDeltaSnapshotUnsafe(const DeltaSnapshot *delta)
+{
+    if (delta) {
+        delta->apply(this);
+        queue.put(MSG_SNAPSHOT_RESTORED);
+    }
+}
+
+void
+Amiga::loadFromDeltaSnapshotSafe(const DeltaSnapshot *delta)
+{
+    trace(SNP_DEBUG, "loadFromDeltaSnapshotSafe\n");
+    
+    suspend();
+    try { loadFromDeltaSnapshotUnsafe(delta); } catch (...) { resume(); throw; }
+    resume();
+}
+
+bool
+Amiga::rewind(isize seconds)
+{
+    bool result;
+    
+    suspend();
+    try { result = rewindBuffer.rewind(50 * seconds); } catch (...) { resume(); throw; }
+    resume();
+    
+    return result;
+}
+
+Amiga *
+Amiga::fork()
+{
+    assert(isPoweredOn());
+
+    suspend();
+
+    std::unique_ptr<Amiga> result;
+
+    try {
+
+        result = std::make_unique<Amiga>();
+        forkInto(*result);
+
+    } catch (...) {
+
+        // forkInto() may have thrown with the serialization flags cleared
+        mem.serializeContents = true;
+        for (isize i = 0; i < 4; i++) df[i]->serializeDisk = true;
+
+        resume();
+        throw;
+    }
+
+    resume();
+
+    return result.release();
+}
+
+void
+Amiga::forkInto(Amiga &result)
+{
+    // Share the inserted disks
+    for (isize i = 0; i < 4; i++) {
+        if (df[i]->disk) result.df[i]->disk = df[i]->disk->fork();
+    }
+
+    // Copy the component state without memory contents and disks
+    {   util::NativeByteOrder native;
+
+        mem.serializeContents = result.mem.serializeContents = false;
+        for (isize i = 0; i < 4; i++) {
+            df[i]->serializeDisk = result.df[i]->serializeDisk = false;
+        }
+
+        std::vector<u8> image(size());
+        save(image.data());
+        result.load(image.data());
+
+        mem.serializeContents = result.mem.serializeContents = true;
+        for (isize i = 0; i < 4; i++) {
+            df[i]->serializeDisk = result.df[i]->serializeDisk = true;
+        }
+    }
+
+    // Share the memory contents and set up the memory lookup tables
+    result.mem.cloneContents(mem);
+    result.mem.updateMemSrcTables();
+
+    /* Switch the state directly, because a regular power-up would reset the
+     * machine and overwrite the Ram with the initialization pattern.
+     */
+    result.state = EMULATOR_STATE_PAUSED;
+}
@@ -22,6 +22,12 @@
 #include "Oscillator.h"
 #include "Paula.h"
 #include "RetroShell.h"
+#include "RewindBuffer.h"
+#include "RunAhead.h"
+#include "BootCache.h"
+#include "EventTracer.h"
+#include "InputRecorder.h"
+#include "Profiler.h"
 #include "RTC.h"
 #include "SerialPort.h"
 #include "ZorroManager.h"
@@ -91,6 +97,18 @@ public:
     // Command shell
     RetroShell retroShell = RetroShell(*this);
     
+    // Time travel
+    RewindBuffer rewindBuffer = RewindBuffer(*this);
+    RunAhead runAhead = RunAhead(*this);
+    BootCache bootCache = BootCache(*this);
+
+    // Input recording
+    InputRecorder inputRecorder = InputRecorder(*this);
+
+    // Performance analysis
+    Profiler profiler = Profiler(*this);
+    EventTracer tracer = EventTracer(*this);
+    
     
     //
     // Message queue
@@ -121,6 +139,9 @@ private:
     
     // The invocation counter for implementing suspend() / resume()
     isize suspendCounter = 0;
+
+    // Set while configureInRunLoop() is executed (suspend() is a no-op then)
+    bool inRunLoop = false;
     
     // The emulator thread
     pthread_t p = (pthread_t)0;
@@ -135,6 +156,9 @@ private:
     class Snapshot *autoSnapshot = nullptr;
     class Snapshot *userSnapshot = nullptr;
 
+    // The chain of delta snapshots taken by takeDeltaSnapshot()
+    DeltaChain deltaChain;
+
     
     //
     // Initializing
@@ -171,6 +195,12 @@ public:
     // Sets a single configuration item
     bool configure(Option option, long value) throws;
     bool configure(Option option, long id, long value) throws;
+
+    /* Sets a single configuration item from inside the run loop. The emulator
+     * thread is in a safe state already. Hence, the emulator is not suspended.
+     * This function is used to replay recorded configuration changes.
+     */
+    bool configureInRunLoop(Option option, long id, long value) throws;
     
     
     //
@@ -292,6 +322,10 @@ public:
     void signalWarpOff() { setControlFlags(RL_WARP_OFF); }
     void signalAutoSnapshot() { setControlFlags(RL_AUTO_SNAPSHOT); }
     void signalUserSnapshot() { setControlFlags(RL_USER_SNAPSHOT); }
+    void signalRewindSnapshot() { setControlFlags(RL_REWIND_SNAPSHOT); }
+    void signalRunAhead() { setControlFlags(RL_RUN_AHEAD); }
+    void signalBootSnapshot() { setControlFlags(RL_BOOT_SNAPSHOT); }
+    void signalInput() { setControlFlags(RL_INPUT); }
     // void signalShutdown() { setControlFlags(RL_STOP | RL_SHUTDOWN); }
 
     //
@@ -335,6 +369,27 @@ public:
      */
     void runLoop();
 
+    /* Runs the emulator synchronously. In contrast to run(), these functions
+     * don't launch the emulator thread. They run the same loop on the calling
+     * thread and return when the current frame has been completed or the
+     * specified number of master cycles has been emulated, respectively. False
+     * is returned if the execution was interrupted prematurely, e.g., because
+     * a breakpoint has been reached. The emulator must be powered on and must
+     * not be running. No real-time synchronization takes place.
+     */
+    bool executeFrame();
+    bool executeCycles(Cycle cycles);
+
+private:
+    
+    // Emulates until the specified master cycle or frame has been reached
+    bool executeSync(Cycle cycle, i64 frame);
+    
+    /* Processes the run loop control flags. The function returns false if
+     * the run loop has to be terminated.
+     */
+    bool processControlFlags();
+
     
     //
     // Handling snapshots
@@ -361,4 +416,55 @@ public:
      */
     void loadFromSnapshotUnsafe(Snapshot *snapshot);
     void loadFromSnapshotSafe(Snapshot *snapshot);
+
+    /* Loads the current state from a memory-mapped snapshot file. If the
+     * memory contents are stored uncompressed, the Ram is mapped from the
+     * file instead of being copied.
+     */
+    void loadFromSnapshotUnsafe(const class MappedSnapshot &snapshot) throws;
+    void loadFromSnapshotSafe(const class MappedSnapshot &snapshot) throws;
+
+    /* Takes a delta snapshot. A delta snapshot only contains the memory pages
+     * and component blocks that have changed since the previous delta snapshot
+     * was taken. If a keyframe is requested, the complete state is recorded.
+     * The function must be called inside the emulator thread or from outside
+     * if the emulator is halted.
+     */
+    class DeltaSnapshot *takeDeltaSnapshot(bool keyframe = false);
+
+    /* Applies a delta snapshot to the current state. Delta snapshots need to
+     * be applied in the order they have been taken, starting with a keyframe.
+     * There is a thread-unsafe and thread-safe version of this function.
+     */
+    void loadFromDeltaSnapshotUnsafe(const DeltaSnapshot *delta) throws;
+    void loadFromDeltaSnapshotSafe(const DeltaSnapshot *delta) throws;
+
+    /* Travels back in time by the given number of seconds, utilizing the
+     * checkpoints recorded by the rewind buffer. The function returns false if
+     * the recorded history does not reach back far enough. In this case, the
+     * oldest checkpoint is restored. The function can be called any time.
+     */
+    bool rewind(isize seconds) throws;
+
+
+    //
+    // Forking
+    //
+
+public:
+
+    /* Creates an independent copy of this Amiga. The component state is
+     * transferred via the serialization interface. The memory contents and the
+     * inserted disks are shared copy-on-write. Hence, forking is cheap even for
+     * large memory configurations, and both instances only pay for the pages
+     * they modify afterwards. The new instance is powered on and paused. It
+     * has no message queue listener and can be run on a thread of its own.
+     * The function can be called any time.
+     */
+    Amiga *fork() throws;
+
+private:
+
+    // Turns a freshly created instance into a copy of this one
+    void forkInto(Amiga &result) throws;
 };
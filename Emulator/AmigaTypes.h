@@ -17,14 +17,18 @@
 
 enum_u32(RunLoopControlFlag)
 {
-    RL_STOP               = 0b000000001,
-    RL_INSPECT            = 0b000000010,
-    RL_WARP_ON            = 0b000000100,
-    RL_WARP_OFF           = 0b000001000,
-    RL_BREAKPOINT_REACHED = 0b000010000,
-    RL_WATCHPOINT_REACHED = 0b000100000,
-    RL_AUTO_SNAPSHOT      = 0b001000000,
-    RL_USER_SNAPSHOT      = 0b010000000
+    RL_STOP               = 0b000000000001,
+    RL_INSPECT            = 0b000000000010,
+    RL_WARP_ON            = 0b000000000100,
+    RL_WARP_OFF           = 0b000000001000,
+    RL_BREAKPOINT_REACHED = 0b000000010000,
+    RL_WATCHPOINT_REACHED = 0b000000100000,
+    RL_AUTO_SNAPSHOT      = 0b000001000000,
+    RL_USER_SNAPSHOT      = 0b000010000000,
+    RL_REWIND_SNAPSHOT    = 0b000100000000,
+    RL_RUN_AHEAD          = 0b001000000000,
+    RL_BOOT_SNAPSHOT      = 0b010000000000,
+    RL_INPUT              = 0b100000000000
 };
 
 //
@@ -15,6 +15,7 @@ AmigaComponent::AmigaComponent(Amiga& ref) :
 agnus(ref.agnus),
 amiga(ref),
 blitter(ref.agnus.blitter),
+bootCache(ref.bootCache),
 ciaa(ref.ciaA),
 ciab(ref.ciaB),
 controlPort1(ref.controlPort1),
@@ -28,15 +29,20 @@ df0(ref.df0),
 df1(ref.df1),
 df2(ref.df2),
 df3(ref.df3),
+inputRecorder(ref.inputRecorder),
 keyboard(ref.keyboard),
 mem(ref.mem),
 messageQueue(ref.queue),
 oscillator(ref.oscillator),
 paula(ref.paula),
 pixelEngine(ref.denise.pixelEngine),
+profiler(ref.profiler),
 retroShell(ref.retroShell),
+rewindBuffer(ref.rewindBuffer),
 rtc(ref.rtc),
+runAhead(ref.runAhead),
 serialPort(ref.serialPort),
+tracer(ref.tracer),
 uart(ref.paula.uart),
 zorro(ref.zorro)
 {
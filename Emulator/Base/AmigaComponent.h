@@ -14,6 +14,7 @@
 class Agnus;
 class Amiga;
 class Blitter;
+class BootCache;
 class CPU;
 class CIA;
 class CIAA;
@@ -24,6 +25,8 @@ class Denise;
 class DiskController;
 class DmaDebugger;
 class Drive;
+class EventTracer;
+class InputRecorder;
 class Joystick;
 class Keyboard;
 class Memory;
@@ -32,8 +35,11 @@ class MsgQueue;
 class Oscillator;
 class Paula;
 class PixelEngine;
+class Profiler;
 class RetroShell;
+class RewindBuffer;
 class RTC;
+class RunAhead;
 class SerialPort;
 class UART;
 class ZorroManager;
@@ -48,6 +54,7 @@ protected:
     Agnus &agnus;
     Amiga &amiga;
     Blitter &blitter;
+    BootCache &bootCache;
     CIAA &ciaa;
     CIAB &ciab;
     ControlPort &controlPort1;
@@ -61,15 +68,20 @@ protected:
     Drive &df1;
     Drive &df2;
     Drive &df3;
+    InputRecorder &inputRecorder;
     Keyboard &keyboard;
     Memory &mem;
     MsgQueue &messageQueue;
     Oscillator &oscillator;
     Paula &paula;
     PixelEngine &pixelEngine;
+    Profiler &profiler;
     RetroShell &retroShell;
+    RewindBuffer &rewindBuffer;
     RTC &rtc;
+    RunAhead &runAhead;
     SerialPort &serialPort;
+    EventTracer &tracer;
     UART &uart;
     ZorroManager &zorro;
 
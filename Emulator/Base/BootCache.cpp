@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "BootCache.h"
+#include "Amiga.h"
+#include "Checksum.h"
+#include "IO.h"
+#include "MappedSnapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+BootCache::BootCache(Amiga& ref) : AmigaComponent(ref)
+{
+    config.frames = 0;
+}
+
+long
+BootCache::getConfigItem(Option option) const
+{
+    switch (option) {
+
+        case OPT_BOOT_CACHE:  return config.frames;
+
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+bool
+BootCache::setConfigItem(Option option, long value)
+{
+    switch (option) {
+
+        case OPT_BOOT_CACHE:
+
+            if (value < 0) {
+                throw ConfigArgError("Positive value or 0 to disable");
+            }
+            if (config.frames == value) {
+                return false;
+            }
+
+            config.frames = value;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void
+BootCache::setDirectory(const string &path)
+{
+    directory = path;
+}
+
+BootCacheInfo
+BootCache::getInfo()
+{
+    BootCacheInfo result;
+
+    synchronized { result = info; }
+
+    return result;
+}
+
+void
+BootCache::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::Config) {
+
+        os << DUMP("Boot cache");
+        if (config.frames) {
+            os << "after " << DEC << config.frames << " frames" << std::endl;
+        } else {
+            os << "disabled" << std::endl;
+        }
+        os << DUMP("Directory") << (directory.empty() ? "none" : directory) << std::endl;
+    }
+
+    if (category & Dump::State) {
+
+        os << DUMP("Hits") << DEC << info.hits << std::endl;
+        os << DUMP("Misses") << DEC << info.misses << std::endl;
+        os << DUMP("Stored states") << DEC << info.stored << std::endl;
+        os << DUMP("Key") << HEX64 << info.key << std::endl;
+        os << DUMP("Recording") << YESNO(pendingKey != 0) << std::endl;
+    }
+}
+
+u64
+BootCache::computeKey() const
+{
+    u64 key = util::fnv_1a_init64();
+    auto add = [&](i64 value) { key = util::fnv_1a_it64(key, (u64)value); };
+
+    // Cached states are only compatible with the same snapshot version
+    add(V_MAJOR);
+    add(V_MINOR);
+    add(V_SUBMINOR);
+    add(SNP_FORMAT);
+
+    // Roms
+    add(mem.romFingerprint());
+    add(mem.extFingerprint());
+
+    // Configuration (all options are included)
+    for (isize i = 0; i < OPT_COUNT; i++) {
+
+        auto option = (Option)i;
+
+        switch (option) {
+
+            // Options that are configured per drive or per audio channel
+            case OPT_DRIVE_CONNECT:
+            case OPT_DRIVE_TYPE:
+            case OPT_EMULATE_MECHANICS:
+            case OPT_DRIVE_PAN:
+            case OPT_STEP_VOLUME:
+            case OPT_POLL_VOLUME:
+            case OPT_INSERT_VOLUME:
+            case OPT_EJECT_VOLUME:
+            case OPT_DEFAULT_FILESYSTEM:
+            case OPT_DEFAULT_BOOTBLOCK:
+            case OPT_AUDPAN:
+            case OPT_AUDVOL:
+
+                for (isize id = 0; id < 4; id++) add(amiga.getConfigItem(option, id));
+                break;
+
+            // Options that are configured per control port
+            case OPT_PULLUP_RESISTORS:
+            case OPT_SHAKE_DETECTION:
+            case OPT_MOUSE_VELOCITY:
+
+                add(amiga.getConfigItem(option, PORT_1));
+                add(amiga.getConfigItem(option, PORT_2));
+                break;
+
+            default:
+
+                add(amiga.getConfigItem(option));
+        }
+    }
+    add(config.frames);
+
+    // Disks
+    for (isize i = 0; i < 4; i++) {
+
+        add(df[i]->hasDisk());
+        if (df[i]->hasDisk()) add((i64)df[i]->disk->getFnv());
+    }
+
+    return key;
+}
+
+string
+BootCache::cachePath(u64 key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "boot-%016llx.vasnap", (unsigned long long)key);
+
+    return util::appendPath(directory, name);
+}
+
+bool
+BootCache::restore()
+{
+    pendingKey = 0;
+
+    if (config.frames == 0 || directory.empty()) return false;
+
+    u64 key = computeKey();
+    string path = cachePath(key);
+
+    synchronized { info.key = key; }
+
+    if (util::fileExists(path)) {
+
+        try {
+
+            MappedSnapshot snapshot(path);
+            amiga.loadFromSnapshotUnsafe(snapshot);
+
+            trace(SNP_DEBUG, "Restored %s\n", path.c_str());
+            synchronized { info.hits++; }
+            return true;
+
+        } catch (VAError &err) {
+
+            // Discard the file and boot regularly
+            warn("Cannot restore %s: %s\n", path.c_str(), err.what());
+            std::remove(path.c_str());
+            amiga.hardReset();
+        }
+    }
+
+    // Record the state after the boot
+    pendingKey = key;
+    targetFrame = agnus.frame.nr + config.frames;
+
+    synchronized { info.misses++; }
+    return false;
+}
+
+void
+BootCache::vsyncHandler()
+{
+    if (pendingKey && agnus.frame.nr >= targetFrame) {
+        amiga.signalBootSnapshot();
+    }
+}
+
+void
+BootCache::store()
+{
+    if (!pendingKey) return;
+
+    u64 key = pendingKey;
+    pendingKey = 0;
+
+    // Discard the state if the configuration or a disk has changed
+    if (computeKey() != key) {
+
+        trace(SNP_DEBUG, "Boot state discarded\n");
+        return;
+    }
+
+    // Write into a temporary file first to never expose a partial file
+    string path = cachePath(key);
+    string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+
+    std::ofstream stream(tmpPath, std::ios::binary);
+    if (!stream.is_open()) {
+
+        warn("Cannot create %s\n", tmpPath.c_str());
+        return;
+    }
+
+    // A failing cache write must not take down the emulator
+    try {
+        Snapshot::writeAmigaToStream(amiga, stream, true);
+    } catch (VAError &err) {
+
+        warn("Cannot write %s: %s\n", path.c_str(), err.what());
+        stream.close();
+        std::remove(tmpPath.c_str());
+        return;
+    }
+    stream.close();
+
+    if (!stream || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+
+        warn("Cannot write %s\n", path.c_str());
+        std::remove(tmpPath.c_str());
+        return;
+    }
+
+    trace(SNP_DEBUG, "Stored %s\n", path.c_str());
+    synchronized { info.stored++; }
+}
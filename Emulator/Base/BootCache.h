@@ -0,0 +1,131 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "BootCacheTypes.h"
+#include "AmigaComponent.h"
+
+/* The boot cache shortcuts the Kickstart boot. After a power-up, the emulator
+ * runs for a configurable number of frames. Afterwards, the emulator state is
+ * written into a snapshot file inside the cache directory. When the emulator
+ * is powered on the next time with the same Roms, the same configuration, and
+ * the same disks inserted, the cached state is restored instead of running
+ * the boot again.
+ *
+ * The cache key is computed from the Rom fingerprints, the values of all
+ * configuration options, and the checksums of the inserted disks. Host input
+ * and disk changes during the boot period are not covered by the key. If the
+ * configuration or a disk changes while the boot is recorded, the recorded
+ * state is discarded. Note that a cached state contains the real-time clock
+ * registers as they were when the state was recorded.
+ *
+ * Cached states are stored with uncompressed memory and restored by mapping
+ * the memory contents copy-on-write from the file. See also: MappedSnapshot
+ */
+class BootCache : public AmigaComponent {
+
+    // Current configuration
+    BootCacheConfig config;
+
+    // Collected statistics
+    BootCacheInfo info = { };
+
+    // Directory where the cached states are stored
+    string directory;
+
+    // Key of the state that is recorded after the boot (0 = none)
+    u64 pendingKey = 0;
+
+    // The frame at which the pending state is recorded
+    i64 targetFrame = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    BootCache(Amiga& ref);
+
+    const char *getDescription() const override { return "BootCache"; }
+
+private:
+
+    void _reset(bool hard) override { }
+    void _powerOff() override { pendingKey = 0; }
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    const BootCacheConfig &getConfig() const { return config; }
+
+    long getConfigItem(Option option) const;
+    bool setConfigItem(Option option, long value) override;
+
+    const string &getDirectory() const { return directory; }
+    void setDirectory(const string &path);
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    BootCacheInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Caching
+    //
+
+public:
+
+    // Computes the cache key for the current Roms, configuration, and disks
+    u64 computeKey() const;
+
+    // Returns the path of the cache file for a certain key
+    string cachePath(u64 key) const;
+
+    /* Restores the cached state if one is available. The function is called
+     * by Amiga::powerOn(). If no state is available, recording is armed and
+     * the state will be stored once the configured number of frames has been
+     * emulated. The function returns true if a cached state was restored.
+     */
+    bool restore();
+
+    // Called by Agnus at the end of each frame
+    void vsyncHandler();
+
+    /* Writes the pending state into the cache. The function is called inside
+     * the run loop between two CPU instructions.
+     */
+    void store();
+};
@@ -0,0 +1,39 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Number of frames emulated before the state is cached (0 = disabled)
+    long frames;
+}
+BootCacheConfig;
+
+typedef struct
+{
+    // Number of power-ups that have been shortcut by a cached state
+    i64 hits;
+
+    // Number of power-ups without a matching cached state
+    i64 misses;
+
+    // Number of states that have been written into the cache
+    i64 stored;
+
+    // Key of the most recent power-up
+    u64 key;
+}
+BootCacheInfo;
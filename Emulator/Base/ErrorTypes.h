@@ -41,6 +41,8 @@ enum_long(ERROR_CODE)
     // Snapshots
     ERROR_SNP_TOO_OLD,
     ERROR_SNP_TOO_NEW,
+    ERROR_SNP_MISMATCH,
+    ERROR_SNP_CORRUPTED,
     ERROR_UNSUPPORTED_SNAPSHOT,  // DEPRECATED
     
     // Encrypted Roms
@@ -119,6 +121,8 @@ struct ErrorCodeEnum : util::Reflection<ErrorCodeEnum, ErrorCode> {
                 
             case ERROR_SNP_TOO_OLD:                 return "SNP_TOO_OLD";
             case ERROR_SNP_TOO_NEW:                 return "SNP_TOO_NEW";
+            case ERROR_SNP_MISMATCH:                return "SNP_MISMATCH";
+            case ERROR_SNP_CORRUPTED:               return "SNP_CORRUPTED";
             case ERROR_UNSUPPORTED_SNAPSHOT:        return "UNSUPPORTED_SNAPSHOT";
                 
             case ERROR_MISSING_ROM_KEY:             return "MISSING_ROM_KEY";
@@ -0,0 +1,255 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "EventTracer.h"
+#include "Amiga.h"
+#include "IO.h"
+
+// Helper functions for formatting the trace file without printf
+
+static char *
+append(char *p, const char *s)
+{
+    while (*s) *p++ = *s++;
+    return p;
+}
+
+static char *
+append(char *p, i64 value)
+{
+    char digits[20];
+    isize n = 0;
+
+    if (value < 0) { *p++ = '-'; value = -value; }
+    do { digits[n++] = (char)('0' + value % 10); value /= 10; } while (value);
+    while (n) *p++ = digits[--n];
+    return p;
+}
+
+// Appends a time span given in nanoseconds as microseconds
+static char *
+appendMicros(char *p, i64 nsec)
+{
+    p = append(p, nsec / 1000);
+    *p++ = '.';
+    *p++ = (char)('0' + nsec / 100 % 10);
+    *p++ = (char)('0' + nsec / 10 % 10);
+    *p++ = (char)('0' + nsec % 10);
+    return p;
+}
+
+EventTracer::~EventTracer()
+{
+    // The emulator is being destroyed and must not be suspended here
+    if (running) {
+
+        running = false;
+        finish();
+    }
+}
+
+bool
+EventTracer::isAvailable()
+{
+#ifdef EVENT_TRACER
+    return true;
+#else
+    return false;
+#endif
+}
+
+EventTracerInfo
+EventTracer::getInfo()
+{
+    EventTracerInfo result;
+
+    synchronized {
+
+        result.running = running;
+        result.recorded = recorded;
+        result.dropped = dropped;
+        result.written = written;
+    }
+
+    return result;
+}
+
+void
+EventTracer::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::State) {
+
+        if (!isAvailable()) {
+
+            os << "The event tracer is not compiled in. Define EVENT_TRACER in config.h." << std::endl;
+            return;
+        }
+
+        os << DUMP("State") << (running ? "Recording" : "Idle") << std::endl;
+        os << DUMP("Recorded events") << DEC << recorded << std::endl;
+        os << DUMP("Dropped events") << DEC << dropped << std::endl;
+        os << DUMP("Written events") << DEC << written << std::endl;
+    }
+}
+
+void
+EventTracer::start(const string &path)
+{
+    if (!isAvailable()) return;
+
+    stop();
+
+    file = fopen(path.c_str(), "w");
+    if (!file) throw VAError(ERROR_FILE_CANT_CREATE);
+
+    raw = tmpfile();
+    if (!raw) {
+
+        fclose(file);
+        file = nullptr;
+        throw VAError(ERROR_FILE_CANT_CREATE);
+    }
+
+    suspend();
+
+    buffer.resize(capacity);
+    r = w = 0;
+    signalled = false;
+    recorded = dropped = written = 0;
+    clock.restart();
+    startTick = util::ticks();
+    terminate = false;
+    running = true;
+
+    resume();
+
+    writer = std::thread(&EventTracer::writerMain, this);
+}
+
+void
+EventTracer::stop()
+{
+    if (!running) return;
+
+    suspend();
+    running = false;
+    resume();
+
+    finish();
+}
+
+void
+EventTracer::finish()
+{
+    // Shut down the writer and write the remaining records
+    terminate = true;
+    wakeable.wakeUp();
+    writer.join();
+    drain();
+
+    convert();
+
+    fclose(raw);
+    fclose(file);
+    raw = file = nullptr;
+
+    std::vector<TraceRecord>().swap(buffer);
+}
+
+void
+EventTracer::writerMain()
+{
+    while (!terminate) {
+
+        // Sleep until the buffer is half full (the timeout is a safety net)
+        wakeable.waitForWakeUp(util::Time(100000000));
+        signalled = false;
+        drain();
+    }
+}
+
+void
+EventTracer::drain()
+{
+    isize pos = r.load(std::memory_order_relaxed);
+    isize end = w.load(std::memory_order_acquire);
+    if (pos == end) return;
+
+    // The pending records occupy at most two chunks of the ring buffer
+    isize count = (end - pos) & (capacity - 1);
+    isize first = std::min(count, capacity - pos);
+
+    fwrite(buffer.data() + pos, sizeof(TraceRecord), first, raw);
+    fwrite(buffer.data(), sizeof(TraceRecord), count - first, raw);
+
+    r.store(end, std::memory_order_release);
+    written += count;
+}
+
+void
+EventTracer::convert()
+{
+    // Determine the length of a tick in nsec
+    u64 elapsedTicks = util::ticks() - startTick;
+    double elapsedTime = (double)clock.getElapsedTime().asNanoseconds();
+    double tick = elapsedTicks ? elapsedTime / (double)elapsedTicks : 0.0;
+
+    // Name the event slots
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (isize i = 0; i < SLOT_COUNT; i++) {
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%zd,\"args\":{\"name\":\"SLOT_%s\"}}",
+                i ? ",\n" : "", i, EventSlotEnum::key((EventSlot)i));
+    }
+
+    // Read the raw records in chunks and reserve enough space for formatting
+    const isize chunkSize = 1024;
+    const isize maxRecordSize = 256;
+    std::vector<TraceRecord> records(chunkSize);
+    std::vector<char> text(chunkSize * maxRecordSize);
+
+    rewind(raw);
+
+    size_t count;
+    while ((count = fread(records.data(), sizeof(TraceRecord), chunkSize, raw)) > 0) {
+
+        char *p = text.data();
+
+        for (size_t i = 0; i < count; i++) {
+
+            auto &rec = records[i];
+            auto slot = (EventSlot)rec.slot;
+
+            p = append(p, ",\n{\"name\":\"");
+            p = append(p, Agnus::eventName(slot, (EventID)rec.id));
+            p = append(p, "\",\"cat\":\"");
+            p = append(p, EventSlotEnum::key(slot));
+            p = append(p, "\",\"ph\":\"X\",\"ts\":");
+            p = appendMicros(p, (i64)((double)(rec.timestamp - startTick) * tick));
+            p = append(p, ",\"dur\":");
+            p = appendMicros(p, (i64)((double)rec.duration * tick));
+            p = append(p, ",\"pid\":1,\"tid\":");
+            p = append(p, (i64)rec.slot);
+            p = append(p, ",\"args\":{\"id\":");
+            p = append(p, (i64)rec.id);
+            p = append(p, ",\"cycle\":");
+            p = append(p, (i64)rec.cycle);
+            p = append(p, ",\"v\":");
+            p = append(p, (i64)rec.v);
+            p = append(p, ",\"h\":");
+            p = append(p, (i64)rec.h);
+            p = append(p, "}}");
+        }
+        fwrite(text.data(), 1, p - text.data(), file);
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+}
@@ -0,0 +1,216 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "EventTracerTypes.h"
+#include "AmigaComponent.h"
+#include "Beam.h"
+#include "Chrono.h"
+#include "Concurrency.h"
+#include "EventTypes.h"
+#include "EventHandlerTypes.h"
+#include <atomic>
+#include <thread>
+
+/* The event tracer records each serviced event in a fixed-size binary record
+ * containing the host time, the trigger cycle, the event slot and ID, and the
+ * beam position. Unlike the printf-based trace() macros, it is cheap enough to
+ * be left enabled in long warp runs. The records are analyzed after the fact
+ * in the Chrome trace viewer or in Perfetto.
+ *
+ * Records are written into a ring buffer owned by the Amiga instance. Since an
+ * instance is emulated by a single thread, each emulator thread writes into a
+ * buffer of its own, and no locking is needed. A background thread drains the
+ * buffer and appends the raw records to a temporary file. It is woken up when
+ * the buffer is half full. The emulator never waits for the writer. If the
+ * buffer is full, records are dropped and counted. When recording stops, the
+ * raw records are converted into a file in Chrome trace JSON format. Each
+ * event slot appears as a separate thread in the viewer.
+ *
+ * The tracer is only compiled in if EVENT_TRACER is defined in config.h. If it
+ * is undefined, the TRACE_SLOT macro expands to nothing and no events are
+ * recorded.
+ */
+class EventTracer : public AmigaComponent {
+
+    // Capacity of the ring buffer (must be a power of two)
+    static constexpr isize capacity = 1 << 18;
+
+    // The ring buffer
+    std::vector<TraceRecord> buffer;
+
+    // Read and write pointers of the ring buffer (on separate cache lines)
+    alignas(64) std::atomic<isize> r { 0 };
+    alignas(64) std::atomic<isize> w { 0 };
+
+    // Indicates if events are recorded
+    bool running = false;
+
+    // Collected statistics
+    i64 recorded = 0;
+    i64 dropped = 0;
+    std::atomic<i64> written { 0 };
+
+    // The trace file and the temporary file holding the raw records
+    FILE *file = nullptr;
+    FILE *raw = nullptr;
+
+    // The background writer
+    std::thread writer;
+    std::atomic<bool> terminate { false };
+    util::Wakeable wakeable;
+
+    // Indicates if the writer has been woken up and hasn't drained yet
+    std::atomic<bool> signalled { false };
+
+    // Host time and ticks at the time recording has started
+    util::Clock clock;
+    u64 startTick = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    EventTracer(Amiga& ref) : AmigaComponent(ref) { }
+    ~EventTracer();
+
+    const char *getDescription() const override { return "EventTracer"; }
+
+private:
+
+    void _reset(bool hard) override { }
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    EventTracerInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Tracing
+    //
+
+public:
+
+    // Indicates if the event tracer has been compiled in
+    static bool isAvailable();
+
+    bool isRunning() const { return running; }
+
+    // Starts recording events into the specified file
+    void start(const string &path);
+
+    // Stops recording and closes the trace file
+    void stop();
+
+    // Records a serviced event
+    void record(const TraceRecord &record) {
+
+        isize pos = w.load(std::memory_order_relaxed);
+        isize next = (pos + 1) & (capacity - 1);
+        recorded++;
+
+        if (next == r.load(std::memory_order_acquire)) { dropped++; return; }
+
+        buffer[pos] = record;
+        w.store(next, std::memory_order_release);
+
+        /* Wake up the writer when the buffer is half full. The emulator never
+         * blocks here. If the writer holds the mutex, the next call retries.
+         * The flag is set beforehand, because the writer clears it as soon as
+         * it wakes up.
+         */
+        if (!signalled.load(std::memory_order_relaxed) &&
+            ((next - r.load(std::memory_order_relaxed)) & (capacity - 1)) >= capacity / 2) {
+
+            signalled.store(true, std::memory_order_relaxed);
+            if (!wakeable.tryWakeUp()) signalled.store(false, std::memory_order_relaxed);
+        }
+    }
+
+private:
+
+    // Shuts down the writer and writes the trace file
+    void finish();
+
+    // Main function of the background writer
+    void writerMain();
+
+    // Writes all pending records into the temporary file
+    void drain();
+
+    // Converts the temporary file into the trace file
+    void convert();
+};
+
+/* Records the event serviced in the remaining part of the current scope. The
+ * slot's event ID has to be captured before the handler runs, because most
+ * handlers reschedule the slot.
+ */
+class EventTracerScope {
+
+    EventTracer &tracer;
+    TraceRecord record;
+    bool active;
+
+public:
+
+    EventTracerScope(EventTracer &ref, EventSlot s, EventID id, Cycle cycle, const Beam &pos) :
+    tracer(ref), active(ref.isRunning()) {
+
+        if (active) {
+
+            record.slot = (u8)s;
+            record.id = (i32)id;
+            record.cycle = cycle;
+            record.v = pos.v;
+            record.h = pos.h;
+            record.timestamp = util::ticks();
+        }
+    }
+
+    ~EventTracerScope() {
+
+        if (active) {
+
+            record.duration = (u32)(util::ticks() - record.timestamp);
+            tracer.record(record);
+        }
+    }
+};
+
+#ifdef EVENT_TRACER
+#define TRACE_SLOT(s) \
+EventTracerScope _tracerScope(tracer, s, slot[s].id, slot[s].triggerCycle, pos)
+#else
+#define TRACE_SLOT(s)
+#endif
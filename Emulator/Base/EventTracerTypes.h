@@ -0,0 +1,55 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Host ticks at the time the event handler was entered
+    u64 timestamp;
+
+    // Host ticks spent in the event handler
+    u32 duration;
+
+    // The serviced event
+    i32 id;
+
+    // Trigger cycle of the event (master cycles)
+    i64 cycle;
+
+    // Beam position at the time the event was serviced
+    i16 v;
+    i16 h;
+
+    // The event slot
+    u8 slot;
+}
+TraceRecord;
+
+typedef struct
+{
+    // Indicates if events are recorded
+    bool running;
+
+    // Number of recorded events
+    i64 recorded;
+
+    // Number of events dropped because the ring buffer was full
+    i64 dropped;
+
+    // Number of events written to the trace file
+    i64 written;
+}
+EventTracerInfo;
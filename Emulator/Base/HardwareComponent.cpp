@@ -9,6 +9,7 @@
 
 #include "config.h"
 #include "HardwareComponent.h"
+#include "Checksum.h"
 
 HardwareComponent::~HardwareComponent()
 {
@@ -175,6 +176,34 @@ HardwareComponent::save(u8 *buffer)
     return result;
 }
 
+u64
+HardwareComponent::hash()
+{
+    u64 result = _hash();
+
+    for (HardwareComponent *c : subComponents) {
+        result = util::fnv_1a_it64(result, c->hash());
+    }
+
+    return result;
+}
+
+u64
+HardwareComponent::_hash()
+{
+    // Serialize the internal state of this component (without subcomponents)
+    static thread_local std::vector<u8> buffer;
+    buffer.resize(_size());
+
+    u8 *ptr = buffer.data();
+    ptr += willSaveToBuffer(ptr);
+    ptr += _save(ptr);
+    ptr += didSaveToBuffer(ptr);
+    assert(ptr - buffer.data() == (isize)buffer.size());
+
+    return util::fnv_1a_64(buffer.data(), (isize)buffer.size());
+}
+
 void
 HardwareComponent::powerOn()
 {
@@ -192,6 +192,18 @@ public:
     virtual isize willSaveToBuffer(u8 *buffer) const {return 0; }
     virtual isize didSaveToBuffer(u8 *buffer) const { return 0; }
     
+    /* Computes a checksum over the internal state of the component and it's
+     * subcomponents. Two components with the same serialized state yield the
+     * same value. By default, a component hashes it's serialized state. Large
+     * components override _hash() to update the checksum incrementally. E.g.,
+     * memory is hashed page by page and only modified pages are rehashed.
+     * Hence, the function is cheap enough to be called in each frame to spot
+     * diverging emulator instances early. It must not be called while the
+     * emulator thread is running.
+     */
+    u64 hash();
+    virtual u64 _hash();
+    
     
     //
     // Controlling
@@ -97,6 +97,18 @@ enum_long(OPT)
     OPT_AUDVOLL,
     OPT_AUDVOLR,
     
+    // Rewind buffer
+    OPT_REWIND,
+    OPT_REWIND_INTERVAL,
+    OPT_REWIND_DURATION,
+    OPT_REWIND_BUDGET,
+
+    // Run-ahead
+    OPT_RUN_AHEAD,
+
+    // Boot cache
+    OPT_BOOT_CACHE,
+    
     OPT_COUNT
 };
 typedef OPT Option;
@@ -172,6 +184,15 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
             case OPT_AUDVOL:              return "AUDVOL";
             case OPT_AUDVOLL:             return "AUDVOLL";
             case OPT_AUDVOLR:             return "AUDVOLR";
+
+            case OPT_REWIND:              return "REWIND";
+            case OPT_REWIND_INTERVAL:     return "REWIND_INTERVAL";
+            case OPT_REWIND_DURATION:     return "REWIND_DURATION";
+            case OPT_REWIND_BUDGET:       return "REWIND_BUDGET";
+
+            case OPT_RUN_AHEAD:           return "RUN_AHEAD";
+
+            case OPT_BOOT_CACHE:          return "BOOT_CACHE";
                 
             case OPT_COUNT:               return "???";
         }
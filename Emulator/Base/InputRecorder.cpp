@@ -0,0 +1,479 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "InputRecorder.h"
+#include "Amiga.h"
+#include "IO.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+// Signature and version of recording files
+static const u8 fileHeader[] = { 'V', 'A', 'I', 'N', 'P', 1 };
+
+// Events are polled if they are due within the next two rasterlines
+static const Cycle pollWindow = DMA_CYCLES(2 * HPOS_CNT);
+
+void
+InputRecorder::_powerOff()
+{
+    stop();
+}
+
+InputRecorderInfo
+InputRecorder::getInfo()
+{
+    InputRecorderInfo result;
+
+    synchronized {
+
+        result.state = state;
+        result.events = (isize)events.size();
+        result.replayed = cursor;
+        result.disks = (isize)disks.size();
+        result.startCycle = startCycle;
+        result.nextCycle = nextCycle;
+    }
+
+    return result;
+}
+
+void
+InputRecorder::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::State) {
+
+        os << DUMP("State") << RecorderStateEnum::key(state) << std::endl;
+        os << DUMP("Events") << DEC << events.size() << std::endl;
+        os << DUMP("Disks") << DEC << disks.size() << std::endl;
+        os << DUMP("Start cycle") << DEC << startCycle << std::endl;
+
+        if (isReplaying()) {
+
+            os << DUMP("Replayed events") << DEC << cursor << std::endl;
+            os << DUMP("Next trigger cycle") << DEC << nextCycle << std::endl;
+        }
+    }
+}
+
+void
+InputRecorder::startRecording()
+{
+    synchronized {
+
+        events.clear();
+        disks.clear();
+        cursor = 0;
+        startCycle = cpu.getMasterClock();
+        nextCycle = NEVER;
+        state = REC_RECORDING;
+    }
+}
+
+void
+InputRecorder::startReplay()
+{
+    suspend();
+
+    synchronized {
+
+        state = REC_REPLAYING;
+        startCycle = cpu.getMasterClock();
+        cursor = 0;
+        updateNextCycle();
+    }
+
+    // Inject the events that have been recorded right at the beginning
+    if (replay()) amiga.signalInput();
+
+    resume();
+}
+
+void
+InputRecorder::stop()
+{
+    synchronized {
+
+        state = REC_IDLE;
+        nextCycle = NEVER;
+    }
+}
+
+void
+InputRecorder::saveToFile(const string &path)
+{
+    std::vector<u8> buffer;
+
+    synchronized {
+
+        // Determine the size of the recording
+        isize size = isizeof(fileHeader) + 16;
+        size += (isize)events.size() * 7 * 8;
+        for (auto &disk : disks) size += 8 + (isize)disk.size();
+        buffer.resize(size);
+
+        util::SerWriter writer(buffer.data());
+        writer.copy(fileHeader, isizeof(fileHeader));
+
+        writer << (i64)events.size();
+        for (auto &e : events) {
+            writer << e.cycle << e.type << e.target << e.value << e.id << e.x << e.y;
+        }
+
+        writer << (i64)disks.size();
+        for (auto &disk : disks) {
+
+            writer << (i64)disk.size();
+            writer.copy(disk.data(), (isize)disk.size());
+        }
+        assert(writer.ptr == buffer.data() + buffer.size());
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_CANT_CREATE);
+
+    stream.write((const char *)buffer.data(), (std::streamsize)buffer.size());
+    if (!stream) throw VAError(ERROR_FILE_CANT_WRITE);
+}
+
+void
+InputRecorder::loadFromFile(const string &path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_NOT_FOUND);
+
+    std::vector<u8> buffer((std::istreambuf_iterator<char>(stream)),
+                           std::istreambuf_iterator<char>());
+
+    if (!util::matchingBufferHeader(buffer.data(), fileHeader, isizeof(fileHeader)) ||
+        buffer.size() < sizeof(fileHeader) + 16) {
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+
+    const u8 *end = buffer.data() + buffer.size();
+    util::SerReader reader(buffer.data() + sizeof(fileHeader));
+
+    // Checks if the next n bytes are part of the file
+    auto check = [&](i64 n) {
+        if (n < 0 || n > end - reader.ptr) throw VAError(ERROR_FILE_CANT_READ);
+    };
+
+    std::vector<InputEvent> newEvents;
+    std::vector<std::vector<u8>> newDisks;
+    i64 count;
+
+    reader << count;
+    if (count < 0 || count > (end - reader.ptr) / (7 * 8)) {
+        throw VAError(ERROR_FILE_CANT_READ);
+    }
+    newEvents.resize(count);
+    for (auto &e : newEvents) {
+        reader << e.cycle << e.type << e.target << e.value << e.id << e.x << e.y;
+    }
+
+    check(8);
+    reader << count;
+    for (i64 i = 0; i < count; i++) {
+
+        i64 size;
+        check(8);
+        reader << size;
+        check(size);
+        newDisks.emplace_back(reader.ptr, reader.ptr + size);
+        reader.ptr += size;
+    }
+
+    // Reject disks that can't be inserted
+    for (auto &disk : newDisks) {
+
+        if ((isize)disk.size() != 16 + Disk::serializedSize()) {
+            throw VAError(ERROR_FILE_CANT_READ);
+        }
+
+        util::SerReader diskReader(disk.data());
+        DiskDiameter type;
+        DiskDensity density;
+        diskReader << type << density;
+
+        if (!Disk::isValidType(type, density)) throw VAError(ERROR_FILE_CANT_READ);
+    }
+
+    // Reject events that can't be injected
+    for (auto &e : newEvents) {
+
+        bool valid = InputTypeEnum::isValid(e.type) && e.cycle >= 0;
+
+        switch (e.type) {
+
+            case INP_KEY_PRESS:
+            case INP_KEY_RELEASE:
+
+                valid &= e.target >= 0 && e.target < 0x80;
+                break;
+
+            case INP_MOUSE_XY:
+            case INP_MOUSE_DELTA:
+            case INP_MOUSE_LEFT:
+            case INP_MOUSE_RIGHT:
+
+                valid &= PortNrEnum::isValid(e.target);
+                break;
+
+            case INP_JOYSTICK:
+
+                valid &= PortNrEnum::isValid(e.target) && GamePadActionEnum::isValid(e.value);
+                break;
+
+            case INP_DISK_INSERT:
+
+                valid &= e.id >= 0 && e.id < (i64)newDisks.size();
+                [[fallthrough]];
+
+            case INP_DISK_EJECT:
+
+                valid &= e.target >= 0 && e.target <= 3;
+                break;
+
+            case INP_CONFIG:
+
+                valid &= OptionEnum::isValid(e.target);
+                break;
+
+            default:
+                break;
+        }
+        if (!valid) throw VAError(ERROR_FILE_CANT_READ);
+    }
+
+    suspend();
+
+    synchronized {
+
+        events = std::move(newEvents);
+        disks = std::move(newDisks);
+        state = REC_IDLE;
+        cursor = 0;
+        startCycle = 0;
+        nextCycle = NEVER;
+    }
+
+    resume();
+}
+
+void
+InputRecorder::hsyncHandler()
+{
+    if (nextCycle - agnus.clock <= pollWindow) amiga.signalInput();
+}
+
+bool
+InputRecorder::replay()
+{
+    synchronized {
+
+        Cycle clock = cpu.getMasterClock();
+
+        while (nextCycle <= clock) {
+
+            trace(INP_DEBUG, "Replaying %s at %lld\n",
+                  InputTypeEnum::key(events[cursor].type), clock);
+
+            inject(events[cursor++]);
+            updateNextCycle();
+        }
+
+        // Keep polling if the next event is due soon
+        return nextCycle - clock <= pollWindow;
+    }
+    return false;
+}
+
+void
+InputRecorder::recordKey(long keycode, bool pressed)
+{
+    record(pressed ? INP_KEY_PRESS : INP_KEY_RELEASE, keycode, 0);
+}
+
+void
+InputRecorder::recordMouseXY(PortNr port, double x, double y)
+{
+    record(INP_MOUSE_XY, port, 0, -1, x, y);
+}
+
+void
+InputRecorder::recordMouseDelta(PortNr port, double dx, double dy)
+{
+    record(INP_MOUSE_DELTA, port, 0, -1, dx, dy);
+}
+
+void
+InputRecorder::recordMouseButton(PortNr port, bool left, bool value)
+{
+    record(left ? INP_MOUSE_LEFT : INP_MOUSE_RIGHT, port, value);
+}
+
+void
+InputRecorder::recordJoystick(PortNr port, GamePadAction action)
+{
+    record(INP_JOYSTICK, port, action);
+}
+
+void
+InputRecorder::recordDiskInsert(Disk *disk, isize nr, Cycle delay)
+{
+    if (!isRecording()) return;
+
+    // Store a copy of the disk
+    util::SerCounter counter;
+    disk->applyToPersistentItems(counter);
+
+    std::vector<u8> data(counter.count + 16);
+    util::SerWriter writer(data.data());
+    writer << disk->getDiameter() << disk->getDensity();
+    disk->applyToPersistentItems(writer);
+
+    synchronized {
+
+        // Store each disk only once
+        auto it = std::find(disks.begin(), disks.end(), data);
+        if (it == disks.end()) it = disks.insert(it, std::move(data));
+
+        record(INP_DISK_INSERT, nr, delay, it - disks.begin());
+    }
+}
+
+void
+InputRecorder::recordDiskEject(isize nr, Cycle delay)
+{
+    record(INP_DISK_EJECT, nr, delay);
+}
+
+void
+InputRecorder::recordConfig(Option option, long id, long value)
+{
+    record(INP_CONFIG, option, value, id);
+}
+
+void
+InputRecorder::record(InputType type, i64 target, i64 value, i64 id, double x, double y)
+{
+    if (!isRecording()) return;
+
+    synchronized {
+
+        Cycle clock = cpu.getMasterClock();
+
+        InputEvent event;
+        event.cycle = clock - startCycle;
+        event.type = type;
+        event.target = target;
+        event.value = value;
+        event.id = id;
+        event.x = x;
+        event.y = y;
+
+        trace(INP_DEBUG, "Recording %s at %lld\n", InputTypeEnum::key(type), clock);
+        events.push_back(event);
+    }
+}
+
+void
+InputRecorder::inject(const InputEvent &event)
+{
+    ControlPort &port = event.target == PORT_1 ? controlPort1 : controlPort2;
+
+    switch (event.type) {
+
+        case INP_KEY_PRESS:
+
+            keyboard.pressKey(event.target);
+            break;
+
+        case INP_KEY_RELEASE:
+
+            keyboard.releaseKey(event.target);
+            break;
+
+        case INP_MOUSE_XY:
+
+            port.mouse.setXY(event.x, event.y);
+            break;
+
+        case INP_MOUSE_DELTA:
+
+            port.mouse.setDeltaXY(event.x, event.y);
+            break;
+
+        case INP_MOUSE_LEFT:
+
+            port.mouse.setLeftButton(event.value);
+            break;
+
+        case INP_MOUSE_RIGHT:
+
+            port.mouse.setRightButton(event.value);
+            break;
+
+        case INP_JOYSTICK:
+
+            port.joystick.trigger((GamePadAction)event.value);
+            break;
+
+        case INP_DISK_INSERT:
+        {
+            util::SerReader reader(disks[event.id].data());
+            DiskDiameter type;
+            DiskDensity density;
+            reader << type << density;
+
+            Disk *disk = Disk::makeWithReader(reader, type, density);
+            if (isRunning()) {
+                diskController.scheduleDiskInsert(disk, event.target, event.value);
+            } else {
+                diskController.insertDiskNow(disk, event.target);
+            }
+            break;
+        }
+        case INP_DISK_EJECT:
+
+            diskController.scheduleDiskEject(event.target, event.value);
+            break;
+
+        case INP_CONFIG:
+
+            try {
+
+                amiga.configureInRunLoop((Option)event.target, event.id, event.value);
+
+            } catch (ConfigError &err) {
+
+                warn("Cannot replay %s: %s\n",
+                     OptionEnum::key((Option)event.target), err.what());
+            }
+            break;
+
+        default:
+            assert(false);
+    }
+}
+
+void
+InputRecorder::updateNextCycle()
+{
+    if (isReplaying() && cursor < (isize)events.size()) {
+
+        nextCycle = startCycle + events[cursor].cycle;
+
+    } else {
+
+        state = isReplaying() ? REC_IDLE : state;
+        nextCycle = NEVER;
+    }
+}
@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "InputRecorderTypes.h"
+#include "AmigaComponent.h"
+#include "ControlPortTypes.h"
+#include "JoystickTypes.h"
+#include "Event.h"
+
+/* The input recorder makes emulator sessions reproducible. While recording,
+ * all input that is injected from the outside is logged together with the
+ * master clock value of the CPU. Agnus is not used as time base, because it
+ * is synchronized with the CPU lazily and may lag behind. This covers key presses, mouse and joystick
+ * changes, disk insertions and ejections, and configuration changes. Inserted
+ * disks are copied into the recording, so that a recording can be replayed
+ * without the original disk files.
+ *
+ * When a recording is replayed, each event is injected at the first CPU
+ * instruction boundary at which the master clock has reached the recorded
+ * time stamp. If the recorded input has been injected between two calls of
+ * executeFrame() or executeCycles(), this is exactly the point where it was
+ * injected originally. Hence, a replay ends up in the same state as the
+ * recorded session, provided that it starts from the same state. Input that
+ * has been recorded while the emulator thread was running is injected at the
+ * recorded cycle, too. Because the GUI delivers such input asynchronously,
+ * that cycle is only approximately the one at which the input took effect.
+ *
+ * To keep the run loop free of additional checks, Agnus informs the recorder
+ * at the beginning of each rasterline. If the next event is due within the
+ * next two lines, the recorder raises RL_INPUT. As long as this flag is set,
+ * the run loop checks the master clock after each instruction.
+ *
+ * Time stamps are stored relative to the beginning of the recording. During
+ * a replay, they are rebased to the cycle at which the replay has started.
+ */
+class InputRecorder : public AmigaComponent {
+
+    // The current state
+    RecorderState state = REC_IDLE;
+
+    // The recorded events
+    std::vector<InputEvent> events;
+
+    // Serialized copies of all disks inserted while recording
+    std::vector<std::vector<u8>> disks;
+
+    // CPU master clock at the beginning of the recording or the replay
+    Cycle startCycle = 0;
+
+    // Index of the next event to replay
+    isize cursor = 0;
+
+    // Trigger cycle of the next event to replay
+    Cycle nextCycle = NEVER;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    InputRecorder(Amiga& ref) : AmigaComponent(ref) { }
+
+    const char *getDescription() const override { return "InputRecorder"; }
+
+private:
+
+    void _reset(bool hard) override { }
+    void _powerOff() override;
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    InputRecorderInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Recording and replaying
+    //
+
+public:
+
+    RecorderState getState() const { return state; }
+    bool isRecording() const { return state == REC_RECORDING; }
+    bool isReplaying() const { return state == REC_REPLAYING; }
+
+    // Returns the number of recorded events
+    isize numEvents() const { return (isize)events.size(); }
+
+    // Starts a new recording (the old recording is discarded)
+    void startRecording();
+
+    // Starts replaying the current recording
+    void startReplay();
+
+    // Stops recording or replaying
+    void stop();
+
+    // Writes the recording into a file or reads it back
+    void saveToFile(const string &path) throws;
+    void loadFromFile(const string &path) throws;
+
+    // Called by Agnus at the beginning of each rasterline
+    void hsyncHandler();
+
+    /* Injects all events that are due. The function is called inside the run
+     * loop between two CPU instructions while RL_INPUT is set. It returns
+     * true if the next event is due soon and RL_INPUT should stay set.
+     */
+    bool replay();
+
+
+    //
+    // Logging input
+    //
+
+public:
+
+    void recordKey(long keycode, bool pressed);
+    void recordMouseXY(PortNr port, double x, double y);
+    void recordMouseDelta(PortNr port, double dx, double dy);
+    void recordMouseButton(PortNr port, bool left, bool value);
+    void recordJoystick(PortNr port, GamePadAction action);
+    void recordDiskInsert(class Disk *disk, isize nr, Cycle delay);
+    void recordDiskEject(isize nr, Cycle delay);
+    void recordConfig(Option option, long id, long value);
+
+private:
+
+    // Appends an event to the recording
+    void record(InputType type, i64 target, i64 value, i64 id = -1,
+                double x = 0, double y = 0);
+
+    // Injects a single event
+    void inject(const InputEvent &event);
+
+    // Updates the trigger cycle of the next event
+    void updateNextCycle();
+};
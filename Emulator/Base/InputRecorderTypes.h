@@ -0,0 +1,143 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Reflection.h"
+
+//
+// Enumerations
+//
+
+enum_long(INP_TYPE)
+{
+    INP_KEY_PRESS,
+    INP_KEY_RELEASE,
+    INP_MOUSE_XY,
+    INP_MOUSE_DELTA,
+    INP_MOUSE_LEFT,
+    INP_MOUSE_RIGHT,
+    INP_JOYSTICK,
+    INP_DISK_INSERT,
+    INP_DISK_EJECT,
+    INP_CONFIG,
+
+    INP_COUNT
+};
+typedef INP_TYPE InputType;
+
+#ifdef __cplusplus
+struct InputTypeEnum : util::Reflection<InputTypeEnum, InputType> {
+
+    static bool isValid(long value)
+    {
+        return (unsigned long)value < INP_COUNT;
+    }
+
+    static const char *prefix() { return "INP"; }
+    static const char *key(InputType value)
+    {
+        switch (value) {
+
+            case INP_KEY_PRESS:    return "KEY_PRESS";
+            case INP_KEY_RELEASE:  return "KEY_RELEASE";
+            case INP_MOUSE_XY:     return "MOUSE_XY";
+            case INP_MOUSE_DELTA:  return "MOUSE_DELTA";
+            case INP_MOUSE_LEFT:   return "MOUSE_LEFT";
+            case INP_MOUSE_RIGHT:  return "MOUSE_RIGHT";
+            case INP_JOYSTICK:     return "JOYSTICK";
+            case INP_DISK_INSERT:  return "DISK_INSERT";
+            case INP_DISK_EJECT:   return "DISK_EJECT";
+            case INP_CONFIG:       return "CONFIG";
+            case INP_COUNT:        return "???";
+        }
+        return "???";
+    }
+};
+#endif
+
+enum_long(REC_STATE)
+{
+    REC_IDLE,
+    REC_RECORDING,
+    REC_REPLAYING
+};
+typedef REC_STATE RecorderState;
+
+#ifdef __cplusplus
+struct RecorderStateEnum : util::Reflection<RecorderStateEnum, RecorderState> {
+
+    static bool isValid(long value)
+    {
+        return (unsigned long)value <= REC_REPLAYING;
+    }
+
+    static const char *prefix() { return "REC"; }
+    static const char *key(RecorderState value)
+    {
+        switch (value) {
+
+            case REC_IDLE:       return "IDLE";
+            case REC_RECORDING:  return "RECORDING";
+            case REC_REPLAYING:  return "REPLAYING";
+        }
+        return "???";
+    }
+};
+#endif
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Time stamp (CPU master clock)
+    Cycle cycle;
+
+    // The kind of input
+    InputType type;
+
+    // Keycode, port number, drive number, or configuration option
+    i64 target;
+
+    // Button state, gamepad action, delay, or option value
+    i64 value;
+
+    // Disk number or option id (-1 = none)
+    i64 id;
+
+    // Mouse coordinates
+    double x;
+    double y;
+}
+InputEvent;
+
+typedef struct
+{
+    // Current state of the recorder
+    RecorderState state;
+
+    // Number of recorded or loaded events
+    isize events;
+
+    // Number of events that have been replayed
+    isize replayed;
+
+    // Number of disks stored in the recording
+    isize disks;
+
+    // Master clock at the beginning of the recording
+    Cycle startCycle;
+
+    // Trigger cycle of the next event to replay (NEVER if none)
+    Cycle nextCycle;
+}
+InputRecorderInfo;
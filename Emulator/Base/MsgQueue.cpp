@@ -9,6 +9,7 @@
 
 #include "config.h"
 #include "MsgQueue.h"
+#include "RunAhead.h"
 
 void
 MsgQueue::setListener(const void *listener, Callback *callback)
@@ -40,6 +41,9 @@ MsgQueue::removeListener()
 void
 MsgQueue::put(MsgType type, long data)
 {
+    // Speculative frames are not reported (see RunAhead)
+    if (runAhead.isActive()) return;
+    
     synchronized {
         
         debug(QUEUE_DEBUG, "%s [%ld]\n", MsgTypeEnum::key(type), data);
@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Profiler.h"
+#include "Amiga.h"
+#include "IO.h"
+
+bool
+Profiler::isAvailable()
+{
+#ifdef PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+Profiler::start()
+{
+    if (!isAvailable() || running) return;
+
+    suspend();
+
+    clock.restart();
+    startTick = now();
+    running = true;
+
+    resume();
+}
+
+void
+Profiler::stop()
+{
+    if (!running) return;
+
+    suspend();
+
+    elapsedTicks += now() - startTick;
+    elapsedTime += clock.getElapsedTime();
+    running = false;
+
+    resume();
+}
+
+void
+Profiler::clear()
+{
+    suspend();
+
+    for (isize i = 0; i < PROF_COUNT; i++) { calls[i] = 0; ticks[i] = 0; }
+    elapsedTicks = 0;
+    elapsedTime = util::Time();
+
+    if (running) {
+        clock.restart();
+        startTick = now();
+    }
+
+    resume();
+}
+
+double
+Profiler::tickLength()
+{
+    u64 totalTicks = elapsedTicks;
+    double totalTime = (double)elapsedTime.asNanoseconds() / 1000.0;
+
+    // Include the measurement that is still in progress
+    if (running) {
+        totalTicks += now() - startTick;
+        totalTime += (double)clock.getElapsedTime().asNanoseconds() / 1000.0;
+    }
+
+    return totalTicks ? totalTime / totalTicks : 0.0;
+}
+
+ProfilerInfo
+Profiler::getInfo()
+{
+    ProfilerInfo result;
+
+    synchronized {
+
+        double length = tickLength();
+
+        result.running = running;
+        for (isize i = 0; i < PROF_COUNT; i++) {
+
+            result.calls[i] = calls[i];
+            result.time[i] = ticks[i] * length;
+        }
+        result.elapsed = (elapsedTicks + (running ? now() - startTick : 0)) * length;
+    }
+
+    return result;
+}
+
+void
+Profiler::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::State) {
+
+        if (!isAvailable()) {
+
+            os << "The profiler is not compiled in. Define PROFILER in config.h." << std::endl;
+            return;
+        }
+
+        auto info = const_cast<Profiler *>(this)->getInfo();
+
+        double total = 0;
+        for (isize i = 0; i < PROF_COUNT; i++) total += info.time[i];
+
+        os << DUMP("State") << (info.running ? "Running" : "Stopped") << std::endl;
+        os << DUMP("Host time") << DEC << info.elapsed / 1000.0 << " msec" << std::endl;
+        os << DUMP("Profiled time") << DEC << total / 1000.0 << " msec" << std::endl;
+        os << std::endl;
+
+        os << std::setw(24) << std::right << "Section" << " : ";
+        os << std::setw(12) << "Calls";
+        os << std::setw(12) << "msec";
+        os << std::setw(12) << "nsec / call";
+        os << std::setw(8) << "%" << std::endl;
+
+        for (isize i = 0; i < PROF_COUNT; i++) {
+
+            if (info.calls[i] == 0) continue;
+
+            auto section = (ProfilerSection)i;
+            string name = section >= PROF_SLOT ?
+            string("SLOT_") + ProfilerSectionEnum::key(section) :
+            ProfilerSectionEnum::key(section);
+
+            os << DUMP(name) << std::fixed << std::setprecision(1);
+            os << std::setw(12) << info.calls[i];
+            os << std::setw(12) << info.time[i] / 1000.0;
+            os << std::setw(12) << info.time[i] * 1000.0 / info.calls[i];
+            os << std::setw(8) << (total > 0 ? 100.0 * info.time[i] / total : 0.0);
+            os << std::endl;
+        }
+        os << std::defaultfloat;
+    }
+}
@@ -0,0 +1,170 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "ProfilerTypes.h"
+#include "AmigaComponent.h"
+#include "Chrono.h"
+
+/* The profiler measures where the host time goes inside the emulator. It
+ * counts the invocations of all event handlers, CPU instructions, and a couple
+ * of expensive subsystem functions, and sums up the host time spent inside.
+ *
+ * Sections are nested. E.g., event handlers are called while the CPU executes
+ * an instruction, and PixelEngine::colorize() is called inside an event
+ * handler. Each section only accounts for the time not spent in one of its
+ * nested sections. Hence, the measured times add up to the total time.
+ *
+ * Time is measured with the time stamp counter on x86 hosts and with the
+ * system clock elsewhere. Time stamp counter ticks are converted to real time
+ * by relating them to the host time passed while the profiler was running.
+ *
+ * The profiler is only compiled in if PROFILER is defined in config.h. If it
+ * is undefined, the PROFILE macro expands to nothing and the profiler never
+ * collects any data.
+ */
+class Profiler : public AmigaComponent {
+
+    // Indicates if the profiler is collecting data
+    bool running = false;
+
+    // Number of invocations per section
+    i64 calls[PROF_COUNT] = { };
+
+    // Ticks spent in each section, excluding nested sections
+    u64 ticks[PROF_COUNT] = { };
+
+    // Stack of active sections
+    struct { u64 start; u64 nested; } stack[16];
+    isize depth = 0;
+
+    // Host time and ticks passed while the profiler was running
+    util::Clock clock;
+    u64 startTick = 0;
+    u64 elapsedTicks = 0;
+    util::Time elapsedTime;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    Profiler(Amiga& ref) : AmigaComponent(ref) { }
+
+    const char *getDescription() const override { return "Profiler"; }
+
+private:
+
+    void _reset(bool hard) override { }
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    ProfilerInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Profiling
+    //
+
+public:
+
+    // Indicates if the profiler has been compiled in
+    static bool isAvailable();
+
+    bool isRunning() const { return running; }
+
+    // Starts or stops collecting data
+    void start();
+    void stop();
+
+    // Discards all collected data
+    void clear();
+
+    // Enters or leaves a section
+    void begin() {
+
+        assert(depth < 16);
+        stack[depth].start = now();
+        stack[depth].nested = 0;
+        depth++;
+    }
+
+    void end(ProfilerSection section) {
+
+        assert(depth > 0);
+        depth--;
+        u64 elapsed = now() - stack[depth].start;
+        ticks[section] += elapsed - stack[depth].nested;
+        calls[section]++;
+        if (depth) stack[depth - 1].nested += elapsed;
+    }
+
+private:
+
+    // Reads out the tick counter
+    static u64 now() { return util::ticks(); }
+
+    // Returns the length of a tick in usec
+    double tickLength();
+};
+
+/* Measures the host time spent in the remaining part of the current scope.
+ * If the profiler is stopped while the scope is active, the measurement is
+ * completed nevertheless to keep the section stack balanced.
+ */
+class ProfilerScope {
+
+    Profiler &profiler;
+    ProfilerSection section;
+    bool active;
+
+public:
+
+    ProfilerScope(Profiler &ref, ProfilerSection s) :
+    profiler(ref), section(s), active(ref.isRunning()) {
+
+        if (active) profiler.begin();
+    }
+
+    ~ProfilerScope() {
+
+        if (active) profiler.end(section);
+    }
+};
+
+#ifdef PROFILER
+#define PROFILE(section) ProfilerScope _profilerScope(profiler, section)
+#define PROFILE_SLOT(slot) PROFILE((ProfilerSection)(PROF_SLOT + (slot)))
+#else
+#define PROFILE(section)
+#define PROFILE_SLOT(slot)
+#endif
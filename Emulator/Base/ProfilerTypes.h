@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Reflection.h"
+#include "EventHandlerTypes.h"
+
+//
+// Enumerations
+//
+
+/* Sections measured by the profiler. Besides the subsystems listed here, each
+ * event slot is measured separately. Slot s is mapped to section PROF_SLOT + s.
+ */
+enum_long(PROF_SECTION)
+{
+    PROF_CPU,
+    PROF_END_OF_LINE,
+    PROF_COLORIZE,
+    PROF_SYNTHESIZE,
+    PROF_SLOT,
+
+    PROF_COUNT = PROF_SLOT + SLOT_COUNT
+};
+typedef PROF_SECTION ProfilerSection;
+
+#ifdef __cplusplus
+struct ProfilerSectionEnum : util::Reflection<ProfilerSectionEnum, ProfilerSection> {
+
+    static bool isValid(long value)
+    {
+        return (unsigned long)value < PROF_COUNT;
+    }
+
+    static const char *prefix() { return "PROF"; }
+    static const char *key(ProfilerSection value)
+    {
+        if (value >= PROF_SLOT && value < PROF_COUNT) {
+            return EventSlotEnum::key((EventSlot)(value - PROF_SLOT));
+        }
+
+        switch (value) {
+
+            case PROF_CPU:          return "CPU";
+            case PROF_END_OF_LINE:  return "END_OF_LINE";
+            case PROF_COLORIZE:     return "COLORIZE";
+            case PROF_SYNTHESIZE:   return "SYNTHESIZE";
+            default:                return "???";
+        }
+    }
+};
+#endif
+
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Indicates if the profiler is collecting data
+    bool running;
+
+    // Host time spent while the profiler was collecting data in usec
+    double elapsed;
+
+    // Number of invocations per section
+    i64 calls[PROF_COUNT];
+
+    /* Host time spent in each section in usec. Time spent in nested sections
+     * is not included. E.g., the CPU time does not include the time spent in
+     * the event handlers that are called while an instruction is executed.
+     */
+    double time[PROF_COUNT];
+}
+ProfilerInfo;
@@ -0,0 +1,296 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "RewindBuffer.h"
+#include "Amiga.h"
+#include "Compression.h"
+#include "IO.h"
+#include <memory>
+
+RewindBuffer::RewindBuffer(Amiga& ref) : AmigaComponent(ref)
+{
+    config.enabled  = false;
+    config.interval = 50;
+    config.duration = 30;
+    config.budget   = 64;
+}
+
+void
+RewindBuffer::_powerOff()
+{
+    clear();
+}
+
+long
+RewindBuffer::getConfigItem(Option option) const
+{
+    switch (option) {
+            
+        case OPT_REWIND:           return config.enabled;
+        case OPT_REWIND_INTERVAL:  return config.interval;
+        case OPT_REWIND_DURATION:  return config.duration;
+        case OPT_REWIND_BUDGET:    return config.budget;
+
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+bool
+RewindBuffer::setConfigItem(Option option, long value)
+{
+    switch (option) {
+            
+        case OPT_REWIND:
+            
+            if (config.enabled == value) {
+                return false;
+            }
+            
+            suspend();
+            config.enabled = value;
+            clear();
+            resume();
+            return true;
+            
+        case OPT_REWIND_INTERVAL:
+            
+            if (value < 1 || value > 3000) {
+                throw ConfigArgError("1 ... 3000");
+            }
+            if (config.interval == value) {
+                return false;
+            }
+            
+            config.interval = value;
+            return true;
+
+        case OPT_REWIND_DURATION:
+            
+            if (value < 1 || value > 3600) {
+                throw ConfigArgError("1 ... 3600");
+            }
+            if (config.duration == value) {
+                return false;
+            }
+            
+            config.duration = value;
+            return true;
+
+        case OPT_REWIND_BUDGET:
+            
+            if (value < 1 || value > 4096) {
+                throw ConfigArgError("1 ... 4096");
+            }
+            if (config.budget == value) {
+                return false;
+            }
+            
+            config.budget = value;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+RewindBufferInfo
+RewindBuffer::getInfo()
+{
+    RewindBufferInfo result = { };
+    
+    synchronized {
+        
+        result.checkpoints = (isize)history.size();
+        result.bytesUsed = bytesUsed;
+        for (auto &checkpoint : history) {
+            if (checkpoint.keyframe) result.keyframes++;
+        }
+        if (!history.empty()) {
+            result.oldestFrame = history.front().frame;
+            result.newestFrame = history.back().frame;
+        }
+    }
+    
+    return result;
+}
+
+void
+RewindBuffer::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::Config) {
+        
+        os << DUMP("Enabled") << YESNO(config.enabled) << std::endl;
+        os << DUMP("Interval") << DEC << config.interval << " frames" << std::endl;
+        os << DUMP("Duration") << DEC << config.duration << " seconds" << std::endl;
+        os << DUMP("Memory budget") << DEC << config.budget << " MB" << std::endl;
+    }
+    
+    if (category & Dump::State) {
+        
+        os << DUMP("Checkpoints") << DEC << (isize)history.size() << std::endl;
+        os << DUMP("Memory used") << DEC << bytesUsed / 1024 << " KB" << std::endl;
+        os << std::endl;
+        
+        for (isize i = 0; i < (isize)history.size(); i++) {
+            
+            auto &checkpoint = history[i];
+            os << std::setw(4) << std::right << std::setfill(' ') << i;
+            os << ": Frame " << std::setw(8) << checkpoint.frame;
+            os << (checkpoint.keyframe ? "  Keyframe " : "  Delta    ");
+            os << std::setw(8) << checkpoint.size << " -> ";
+            os << std::setw(8) << (isize)checkpoint.data.size() << " bytes" << std::endl;
+        }
+    }
+}
+
+void
+RewindBuffer::vsyncHandler()
+{
+    if (config.enabled && agnus.frame.nr >= nextCheckpoint) {
+        amiga.signalRewindSnapshot();
+    }
+}
+
+void
+RewindBuffer::takeCheckpoint()
+{
+    if (!config.enabled) return;
+    
+    synchronized {
+        
+        // Determine if a keyframe is due
+        isize deltas = 0;
+        for (auto it = history.rbegin(); it != history.rend() && !it->keyframe; it++) {
+            deltas++;
+        }
+        bool keyframe = history.empty() || deltas + 1 >= keyframeDistance;
+        
+        // Record the changes since the previous checkpoint
+        std::unique_ptr<DeltaSnapshot> delta(DeltaSnapshot::makeWithAmiga(&amiga, chain, keyframe));
+        
+        // Compress the delta snapshot
+        Checkpoint checkpoint;
+        checkpoint.frame = agnus.frame.nr;
+        checkpoint.keyframe = keyframe;
+        checkpoint.size = delta->size();
+        checkpoint.data.resize(util::lz4Bound(delta->size()));
+        checkpoint.data.resize(util::compressLZ4(delta->getData(), delta->size(),
+                                                 checkpoint.data.data()));
+        checkpoint.data.shrink_to_fit();
+        
+        bytesUsed += (isize)checkpoint.data.size();
+        history.push_back(std::move(checkpoint));
+        
+        trim();
+    }
+    
+    nextCheckpoint = agnus.frame.nr + config.interval;
+}
+
+void
+RewindBuffer::clear()
+{
+    synchronized {
+        
+        history.clear();
+        bytesUsed = 0;
+        chain = DeltaChain();
+        nextCheckpoint = 0;
+    }
+}
+
+void
+RewindBuffer::trim()
+{
+    i64 oldest = history.back().frame - 50 * config.duration;
+    isize budget = MB(config.budget);
+    
+    while (true) {
+        
+        // Find the second keyframe
+        auto next = history.begin() + 1;
+        while (next != history.end() && !next->keyframe) next++;
+        
+        // The first keyframe group can't be deleted if it is the only one
+        if (next == history.end()) break;
+        
+        // Only delete the group if the remaining history is long enough
+        if (next->frame > oldest && bytesUsed <= budget) break;
+        
+        for (auto it = history.begin(); it != next; it++) {
+            bytesUsed -= (isize)it->data.size();
+        }
+        history.erase(history.begin(), next);
+    }
+}
+
+i64
+RewindBuffer::frameOf(isize nr) const
+{
+    assert(nr >= 0 && nr < count());
+    return history[nr].frame;
+}
+
+void
+RewindBuffer::restore(isize nr)
+{
+    assert(nr >= 0 && nr < count());
+    
+    synchronized {
+        
+        // Find the preceding keyframe
+        isize first = nr;
+        while (!history[first].keyframe) { assert(first > 0); first--; }
+        
+        // Apply the keyframe and all subsequent deltas
+        std::vector<u8> buffer;
+        for (isize i = first; i <= nr; i++) {
+            
+            auto &checkpoint = history[i];
+            buffer.resize(checkpoint.size);
+            
+            isize size = util::decompressLZ4(checkpoint.data.data(),
+                                             (isize)checkpoint.data.size(),
+                                             buffer.data(), checkpoint.size);
+            if (size != checkpoint.size) throw VAError(ERROR_SNP_MISMATCH);
+            
+            std::unique_ptr<DeltaSnapshot> delta(DeltaSnapshot::makeWithBuffer(buffer.data(), size));
+            delta->apply(&amiga);
+        }
+        
+        // Delete all newer checkpoints
+        for (isize i = nr + 1; i < count(); i++) {
+            bytesUsed -= (isize)history[i].data.size();
+        }
+        history.erase(history.begin() + nr + 1, history.end());
+        
+        // Continue recording from the restored checkpoint
+        DeltaSnapshot::rebase(&amiga, chain);
+        nextCheckpoint = agnus.frame.nr + config.interval;
+    }
+    
+    messageQueue.put(MSG_SNAPSHOT_RESTORED);
+}
+
+bool
+RewindBuffer::rewind(i64 frames)
+{
+    if (history.empty()) return false;
+    
+    // Find the newest checkpoint that is old enough
+    i64 target = agnus.frame.nr - frames;
+    isize nr = count() - 1;
+    while (nr > 0 && history[nr].frame > target) nr--;
+    
+    restore(nr);
+    return history[nr].frame <= target;
+}
@@ -0,0 +1,164 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "RewindBufferTypes.h"
+#include "AmigaComponent.h"
+#include "DeltaSnapshot.h"
+#include <deque>
+
+/* The rewind buffer keeps a rolling history of the emulator state which makes
+ * it possible to travel back in time. In regular intervals, a checkpoint is
+ * recorded at the end of a frame. Each checkpoint is a compressed delta
+ * snapshot. Every keyframeDistance checkpoints, a keyframe is recorded which
+ * contains the full emulator state. To restore a checkpoint, the preceding
+ * keyframe is applied first, followed by all deltas up to the checkpoint.
+ *
+ * The history is trimmed from the front, one keyframe group at a time, if it
+ * covers more than the configured duration or if it occupies more memory than
+ * the configured budget. The rewind buffer is not part of the emulator state.
+ * Hence, it is not affected by resets and not stored in snapshots.
+ */
+class RewindBuffer : public AmigaComponent {
+
+    // Number of checkpoints between two keyframes
+    static constexpr isize keyframeDistance = 10;
+
+    struct Checkpoint {
+
+        // Frame number at the time the checkpoint was recorded
+        i64 frame;
+
+        // Indicates if this checkpoint is a keyframe
+        bool keyframe;
+
+        // Size of the uncompressed delta snapshot
+        isize size;
+
+        // Compressed delta snapshot
+        std::vector<u8> data;
+    };
+
+    // Current configuration
+    RewindBufferConfig config;
+
+    // The recorded checkpoints (oldest first)
+    std::deque<Checkpoint> history;
+
+    // The delta snapshot chain the checkpoints are recorded in
+    DeltaChain chain;
+
+    // Number of bytes occupied by all checkpoints
+    isize bytesUsed = 0;
+
+    // Frame number at which the next checkpoint is due
+    i64 nextCheckpoint = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    RewindBuffer(Amiga& ref);
+
+    const char *getDescription() const override { return "RewindBuffer"; }
+
+private:
+
+    void _reset(bool hard) override { }
+    void _powerOff() override;
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    const RewindBufferConfig &getConfig() const { return config; }
+
+    long getConfigItem(Option option) const;
+    bool setConfigItem(Option option, long value) override;
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    RewindBufferInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Recording
+    //
+
+public:
+
+    // Called by Agnus at the end of each frame
+    void vsyncHandler();
+
+    /* Records a checkpoint. The function is called inside the run loop
+     * between two CPU instructions to make sure that the recorded state is
+     * consistent.
+     */
+    void takeCheckpoint();
+
+    // Deletes all checkpoints
+    void clear();
+
+private:
+
+    // Deletes old checkpoints until the history fits the configured limits
+    void trim();
+
+
+    //
+    // Time travelling
+    //
+
+public:
+
+    // Returns the number of recorded checkpoints
+    isize count() const { return (isize)history.size(); }
+
+    // Returns the frame number of a certain checkpoint (0 = oldest)
+    i64 frameOf(isize nr) const;
+
+    /* Restores a checkpoint (0 = oldest). All newer checkpoints are deleted.
+     * The function must be called inside the emulator thread or from outside
+     * if the emulator is halted.
+     */
+    void restore(isize nr) throws;
+
+    /* Travels back in time by at least the given number of frames. If the
+     * history does not reach back far enough, the oldest checkpoint is
+     * restored and false is returned.
+     */
+    bool rewind(i64 frames) throws;
+};
@@ -0,0 +1,42 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Indicates if checkpoints are recorded
+    bool enabled;
+
+    // Number of frames between two checkpoints
+    long interval;
+
+    // Number of seconds the history should cover
+    long duration;
+
+    // Maximum amount of memory occupied by the history in MB
+    long budget;
+}
+RewindBufferConfig;
+
+typedef struct
+{
+    isize checkpoints;
+    isize keyframes;
+    isize bytesUsed;
+    i64 oldestFrame;
+    i64 newestFrame;
+}
+RewindBufferInfo;
@@ -0,0 +1,281 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "RunAhead.h"
+#include "Amiga.h"
+#include "IO.h"
+
+RunAhead::RunAhead(Amiga& ref) : AmigaComponent(ref)
+{
+    config.frames = 0;
+}
+
+void
+RunAhead::_powerOff()
+{
+    // Free the state buffers
+    std::vector<u8>().swap(image);
+    for (isize i = 0; i < MEM_REGION_COUNT; i++) std::vector<u8>().swap(mirror[i]);
+    mirrorEpoch = 0;
+}
+
+long
+RunAhead::getConfigItem(Option option) const
+{
+    switch (option) {
+
+        case OPT_RUN_AHEAD:  return config.frames;
+
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+bool
+RunAhead::setConfigItem(Option option, long value)
+{
+    switch (option) {
+
+        case OPT_RUN_AHEAD:
+
+            if (value < 0 || value > 8) {
+                throw ConfigArgError("0 ... 8");
+            }
+            if (config.frames == value) {
+                return false;
+            }
+
+            suspend();
+            config.frames = value;
+            resume();
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+RunAheadInfo
+RunAhead::getInfo()
+{
+    RunAheadInfo result;
+
+    synchronized {
+
+        result = info;
+        result.imageSize = (isize)image.size();
+        result.saveTime = info.passes ? totalSaveTime / info.passes : 0;
+        result.restoreTime = info.passes ? totalRestoreTime / info.passes : 0;
+    }
+
+    return result;
+}
+
+void
+RunAhead::_dump(Dump::Category category, std::ostream& os) const
+{
+    if (category & Dump::Config) {
+
+        os << DUMP("Run-ahead") << DEC << config.frames << " frames" << std::endl;
+    }
+
+    if (category & Dump::State) {
+
+        double passes = info.passes ? (double)info.passes : 1.0;
+
+        os << DUMP("Passes") << DEC << info.passes << std::endl;
+        os << DUMP("Skipped frames") << DEC << info.skipped << std::endl;
+        os << DUMP("Component state") << DEC << (isize)image.size() << " bytes" << std::endl;
+        os << DUMP("Save time") << totalSaveTime / passes << " usec" << std::endl;
+        os << DUMP("Restore time") << totalRestoreTime / passes << " usec" << std::endl;
+    }
+}
+
+bool
+RunAhead::presentsFrame() const
+{
+    if (active) return agnus.frame.nr >= targetFrame;
+    return config.frames == 0 || !isPossible();
+}
+
+void
+RunAhead::vsyncHandler()
+{
+    assert(!active);
+
+    if (config.frames) {
+        amiga.signalRunAhead();
+    }
+}
+
+bool
+RunAhead::isPossible() const
+{
+    // Running ahead makes no sense in warp mode
+    if (amiga.inWarpMode()) return false;
+
+    // Breakpoints must not be hit by speculative frames
+    if (amiga.inDebugMode()) return false;
+
+    // Disk changes can't be reverted
+    if (agnus.isPending<SLOT_DCH>()) return false;
+
+    return true;
+}
+
+void
+RunAhead::execute()
+{
+    if (config.frames == 0) return;
+
+    synchronized {
+
+        if (!isPossible()) { info.skipped++; return; }
+
+        util::Clock clock;
+
+        // Save the current state
+        saveState();
+        totalSaveTime += clock.restart().asMicroseconds();
+
+        // Emulate the next frames with the current input
+        active = true;
+        targetFrame = agnus.frame.nr + config.frames;
+        while (agnus.frame.nr < targetFrame) {
+            PROFILE(PROF_CPU);
+            cpu.execute();
+        }
+        active = false;
+
+        // Travel back in time
+        clock.restart();
+        restoreState();
+        totalRestoreTime += clock.restart().asMicroseconds();
+
+        info.passes++;
+    }
+}
+
+void
+RunAhead::saveState()
+{
+    // Serialize all components without memory contents and disks
+    util::NativeByteOrder native;
+    mem.serializeContents = false;
+    for (isize i = 0; i < 4; i++) df[i]->serializeDisk = false;
+
+    image.resize(amiga.size());
+    amiga.save(image.data());
+
+    mem.serializeContents = true;
+    for (isize i = 0; i < 4; i++) df[i]->serializeDisk = true;
+
+    // Bring the shadow copies of all memory types up to date
+    DirtyRegion regions[MEM_REGION_COUNT];
+    mem.getDirtyRegions(regions);
+
+    for (isize r = 0; r < MEM_REGION_COUNT; r++) {
+
+        auto &region = regions[r];
+
+        // Copy everything if the memory layout has changed
+        if ((isize)mirror[r].size() != region.size) {
+
+            mirror[r].resize(region.size);
+            if (region.size) memcpy(mirror[r].data(), region.ptr, region.size);
+            continue;
+        }
+
+        for (isize offset = 0; offset < region.size; offset += MEM_PAGE_SIZE) {
+
+            if (region.dirty[offset >> MEM_PAGE_SHIFT] < mirrorEpoch) continue;
+
+            isize count = std::min((isize)MEM_PAGE_SIZE, region.size - offset);
+            memcpy(mirror[r].data() + offset, region.ptr + offset, count);
+        }
+    }
+    mirrorEpoch = mem.nextDirtyEpoch();
+
+    // Record all disk writes from now on
+    for (isize i = 0; i < 4; i++) df[i]->startJournal();
+
+    // Remember the end of the audio sample buffers
+    for (isize i = 0; i < 4; i++) samplerWritePtr[i] = paula.muxer.sampler[i]->w;
+
+    // Save the host input state
+    ControlPort *ports[2] = { &controlPort1, &controlPort2 };
+    for (isize i = 0; i < 2; i++) {
+
+        oldMouseX[i] = ports[i]->mouse.oldMouseX;
+        oldMouseY[i] = ports[i]->mouse.oldMouseY;
+        button[i] = ports[i]->joystick.button;
+        bulletCounter[i] = ports[i]->joystick.bulletCounter;
+        nextAutofireFrame[i] = ports[i]->joystick.nextAutofireFrame;
+    }
+}
+
+void
+RunAhead::restoreState()
+{
+    // Revert all disk writes
+    for (isize i = 0; i < 4; i++) df[i]->rollbackJournal();
+
+    // Restore all components
+    util::NativeByteOrder native;
+    mem.serializeContents = false;
+    for (isize i = 0; i < 4; i++) df[i]->serializeDisk = false;
+
+    amiga.load(image.data());
+
+    mem.serializeContents = true;
+    for (isize i = 0; i < 4; i++) df[i]->serializeDisk = true;
+
+    // Restore all memory pages that have been modified
+    DirtyRegion regions[MEM_REGION_COUNT];
+    mem.getDirtyRegions(regions);
+
+    for (isize r = 0; r < MEM_REGION_COUNT; r++) {
+
+        auto &region = regions[r];
+        assert((isize)mirror[r].size() == region.size);
+
+        for (isize offset = 0; offset < region.size; offset += MEM_PAGE_SIZE) {
+
+            isize nr = offset >> MEM_PAGE_SHIFT;
+            if (region.dirty[nr] < mirrorEpoch) continue;
+
+            isize count = std::min((isize)MEM_PAGE_SIZE, region.size - offset);
+            memcpy(region.ptr + offset, mirror[r].data() + offset, count);
+
+            // Restoring the page modifies it, too
+            region.dirty[nr] = mem.dirtyEpoch;
+        }
+    }
+
+    // Discard all audio samples that have been produced in the meantime
+    for (isize i = 0; i < 4; i++) paula.muxer.sampler[i]->w = samplerWritePtr[i];
+
+    // Restore the host input state
+    ControlPort *ports[2] = { &controlPort1, &controlPort2 };
+    for (isize i = 0; i < 2; i++) {
+
+        ports[i]->mouse.oldMouseX = oldMouseX[i];
+        ports[i]->mouse.oldMouseY = oldMouseY[i];
+
+        // Host button events are only overwritten if autofire is active
+        if (ports[i]->joystick.autofire) {
+
+            ports[i]->joystick.button = button[i];
+            ports[i]->joystick.bulletCounter = bulletCounter[i];
+            ports[i]->joystick.nextAutofireFrame = nextAutofireFrame[i];
+        }
+    }
+}
@@ -0,0 +1,155 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "RunAheadTypes.h"
+#include "AmigaComponent.h"
+#include "Memory.h"
+
+/* Run-ahead hides the input latency of the emulated machine. Many games poll
+ * the joystick once per frame and react on it in the frame after. With
+ * run-ahead enabled, the emulator saves its state at the end of each frame,
+ * emulates a couple of frames ahead with the current input, presents the
+ * last of these frames, and restores the saved state.
+ *
+ * To make this viable, saving and restoring has to be much faster than
+ * emulating a frame. Hence, the state is not copied via regular snapshots.
+ * Instead, all components are serialized without memory contents and disks
+ * into a preallocated buffer. Memory is backed up page by page in shadow
+ * copies which are kept up to date with the help of the dirty page maps.
+ * Disk writes are reverted with the undo journals of the drives. After the
+ * buffers have been set up, a run-ahead pass allocates no memory.
+ *
+ * While the emulator runs ahead, no audio samples are synthesized, no
+ * messages are sent, and the emulator is not synchronized with the host.
+ * Hence, the speculative frames are only visible on the screen.
+ */
+class RunAhead : public AmigaComponent {
+
+    // Current configuration
+    RunAheadConfig config;
+
+    // Collected statistics
+    RunAheadInfo info = { };
+
+    // Accumulated save and restore times in usec
+    double totalSaveTime = 0;
+    double totalRestoreTime = 0;
+
+    // Serialized component state (without memory contents and disks)
+    std::vector<u8> image;
+
+    /* Shadow copies of all memory types. Each page that has been modified in
+     * mirrorEpoch or later may differ from its shadow copy.
+     */
+    std::vector<u8> mirror[MEM_REGION_COUNT];
+    u32 mirrorEpoch = 0;
+
+    // Audio sample buffer write pointers
+    isize samplerWritePtr[4];
+
+    // Host input state which is not part of the serialized state
+    double oldMouseX[2];
+    double oldMouseY[2];
+    bool button[2];
+    i64 bulletCounter[2];
+    i64 nextAutofireFrame[2];
+
+    // Indicates if the emulator is currently running ahead
+    bool active = false;
+
+    // The frame at which the current run-ahead pass ends
+    i64 targetFrame = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    RunAhead(Amiga& ref);
+
+    const char *getDescription() const override { return "RunAhead"; }
+
+private:
+
+    void _reset(bool hard) override { }
+    void _powerOff() override;
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    const RunAheadConfig &getConfig() const { return config; }
+
+    long getConfigItem(Option option) const;
+    bool setConfigItem(Option option, long value) override;
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    RunAheadInfo getInfo();
+
+private:
+
+    void _dump(Dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Running ahead
+    //
+
+public:
+
+    // Indicates if the emulator is currently running ahead
+    bool isActive() const { return active; }
+
+    /* Indicates if the frame that has just been completed should be shown on
+     * the screen. If run-ahead is enabled, this is only the case for the last
+     * frame of a run-ahead pass.
+     */
+    bool presentsFrame() const;
+
+    // Called by Agnus at the end of each frame
+    void vsyncHandler();
+
+    /* Performs a run-ahead pass. The function is called inside the run loop
+     * between two CPU instructions at the beginning of a frame.
+     */
+    void execute();
+
+private:
+
+    // Checks if the current frame can be emulated ahead
+    bool isPossible() const;
+
+    // Saves or restores the emulator state
+    void saveState();
+    void restoreState();
+};
@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Number of frames to run ahead (0 = run-ahead is disabled)
+    long frames;
+}
+RunAheadConfig;
+
+typedef struct
+{
+    // Number of completed run-ahead passes
+    i64 passes;
+
+    // Number of frames in which running ahead was not possible
+    i64 skipped;
+
+    // Size of the serialized component state in bytes
+    isize imageSize;
+
+    // Average time needed to save and restore the emulator state in usec
+    double saveTime;
+    double restoreTime;
+}
+RunAheadInfo;
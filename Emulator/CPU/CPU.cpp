@@ -27,8 +27,21 @@ Moira::sync(int cycles)
     // Advance the CPU clock
     clock += cycles;
 
+#ifdef AGNUS_EAGER_SYNC
+    
     // Emulate Agnus up to the same cycle
     agnus.executeUntil(CPU_CYCLES(clock));
+
+#else
+    
+    /* Emulate Agnus up to the same cycle if an event is due. Otherwise, Agnus
+     * is synchronized lazily, e.g., when the CPU accesses the chip bus.
+     */
+    if (CPU_CYCLES(clock) >= agnus.getNextTrigger()) {
+        agnus.executeUntil(CPU_CYCLES(clock));
+    }
+
+#endif
 }
 
 u8
@@ -81,6 +94,7 @@ void
 Moira::signalReset()
 {
     trace(XFILES, "XFILES: RESET instruction\n");
+    agnus.syncWithCPU();
     amiga.softReset();
 }
 
@@ -188,6 +202,9 @@ Moira::watchpointReached(u32 addr)
 
 CPU::CPU(Amiga& ref) : moira::Moira(ref)
 {
+    // Fetch instructions directly from all banks backed by plain memory
+    fetchPtr = mem.cpuReadPtr;
+    fetchCnt = mem.cpuReadCnt;
 }
 
 void
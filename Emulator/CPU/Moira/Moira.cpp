@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <algorithm>
+#include <mutex>
 
 namespace moira {
 
@@ -22,19 +23,34 @@ namespace moira {
 #include "StrWriter_cpp.h"
 #include "MoiraDasm_cpp.h"
 
+Moira::ExecPtr Moira::exec[65536];
+Moira::DasmPtr *Moira::dasm = nullptr;
+InstrInfo *Moira::info = nullptr;
+
 Moira::Moira(Amiga &ref) : AmigaComponent(ref)
 {
-    if (BUILD_INSTR_INFO_TABLE) info = new InstrInfo[65536];
-    if (ENABLE_DASM) dasm = new DasmPtr[65536];
-
-    printf("sizeof(ExecPtr) = %zu\n", sizeof(ExecPtr));
-    createJumpTables();
+    // Set up the jump tables if this is the first instance
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        
+        if (BUILD_INSTR_INFO_TABLE) info = new InstrInfo[65536];
+        if (ENABLE_DASM) dasm = new DasmPtr[65536];
+        createJumpTables();
+    });
 }
 
 Moira::~Moira()
 {
-    if (info) delete [] info;
-    if (dasm) delete [] dasm;
+}
+
+void
+Moira::dispatch(u16 opcode)
+{
+#if PLAIN_EXEC_TABLE
+    exec[opcode](this, opcode);
+#else
+    (this->*exec[opcode])(opcode);
+#endif
 }
 
 void
@@ -95,7 +111,7 @@ Moira::execute()
     if (!flags) {
 
         reg.pc += 2;
-        (this->*exec[queue.ird])(queue.ird);
+        dispatch(queue.ird);
         assert(reg.pc0 == reg.pc);
         return;
     }
@@ -150,7 +166,7 @@ Moira::execute()
 
     // Execute the instruction
     reg.pc += 2;
-    (this->*exec[queue.ird])(queue.ird);
+    dispatch(queue.ird);
     assert(reg.pc0 == reg.pc);
 
 done:
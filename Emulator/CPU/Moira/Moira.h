@@ -117,18 +117,30 @@ protected:
     // Remembers the number of the last processed exception
     int exception;
 
-    // Jump table holding the instruction handlers
+    // Jump table holding the instruction handlers (shared by all instances)
+#if PLAIN_EXEC_TABLE
+    typedef void (*ExecPtr)(Moira *, u16);
+#else
     typedef void (Moira::*ExecPtr)(u16);
-    ExecPtr exec[65536];
+#endif
+    static ExecPtr exec[65536];
 
-    // Jump table holding the disassebler handlers
+    // Jump table holding the disassebler handlers (shared by all instances)
     typedef void (Moira::*DasmPtr)(StrWriter&, u32&, u16);
-    DasmPtr *dasm = nullptr;
+    static DasmPtr *dasm;
     
+    /* Program fetch table. For each 64 KB bank, fetchPtr points to the host
+     * memory backing this bank or is nullptr if the bank needs to be accessed
+     * via read16(). fetchCnt points to the statistics counter to update. Both
+     * tables are owned by the memory subsystem.
+     */
+    u8 *const *fetchPtr = nullptr;
+    long *const *fetchCnt = nullptr;
+
 private:
     
-    // Table holding instruction infos
-    InstrInfo *info = nullptr;
+    // Table holding instruction infos (shared by all instances)
+    static InstrInfo *info;
 
 
     //
@@ -140,7 +152,17 @@ public:
     Moira(Amiga &ref);
     virtual ~Moira();
 
-    void createJumpTables();
+private:
+    
+    // Sets up the jump tables. Called once for all instances
+    static void createJumpTables();
+
+    // Trampoline for calling an instruction handler via a plain function pointer
+    template <void (Moira::*F)(u16)> static void trampoline(Moira *cpu, u16 op) {
+        (cpu->*F)(op);
+    }
+
+public:
 
     // Configures the output format of the disassembler
     void configDasm(bool h, bool u) { hex = h; upper = u; }
@@ -157,6 +179,13 @@ public:
 
     // Executes the next instruction
     void execute();
+
+private:
+
+    // Calls the instruction handler for the provided opcode
+    void dispatch(u16 opcode);
+
+public:
     
     // Returns true if the CPU is in HALT state
     bool isHalted() const { return flags & CPU_IS_HALTED; }
@@ -258,6 +287,9 @@ protected:
     u16 read16OnReset(u32 addr);
     u16 read16Dasm(u32 addr);
 
+    // Reads a word from program space (utilizing the fetch table if possible)
+    u16 fetch16(u32 addr);
+
     // Writes a byte or word into memory
     void write8  (u32 addr, u8  val);
     void write16 (u32 addr, u16 val);
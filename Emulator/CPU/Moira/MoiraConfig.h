@@ -37,6 +37,30 @@
  */
 #define ENABLE_DASM true
 
+/* Set to true to dispatch instructions via plain function pointers.
+ *
+ * By default, the instruction jump table stores C++ member function pointers.
+ * On most platforms, such a pointer occupies 16 bytes and each call involves
+ * a this-adjustment. If this option is enabled, the table stores pointers to
+ * small static trampolines instead which take the CPU object as an argument.
+ * The compiler inlines the instruction handler into each trampoline, which
+ * halves the table size and reduces each dispatch to a plain indirect call.
+ *
+ * Enable to gain speed.
+ */
+#define PLAIN_EXEC_TABLE true
+
+/* Set to true to enable the program fetch table.
+ *
+ * If enabled, instruction words are fetched directly from host memory for all
+ * memory banks registered in the fetch table. This bypasses the read16()
+ * delegate for code running from Rom or Fast Ram. Because the table points to
+ * the backing memory itself, writes into code areas are visible immediately.
+ *
+ * Enable to gain speed.
+ */
+#define ENABLE_FETCH_TABLE true
+
 /* Set to true to build the InstrInfo lookup table.
  *
  * The info table stores information about the instruction (Instr I), the
@@ -235,12 +235,31 @@ Moira::readM(u32 addr)
     // Perform the read operation
     sync(2);
     if (F & POLLIPL) pollIrq();
-    result = (S == Byte) ? read8(addr & 0xFFFFFF) : read16(addr & 0xFFFFFF);
+    if (M == MEM_PROG && S == Word) {
+        result = fetch16(addr & 0xFFFFFF);
+    } else {
+        result = (S == Byte) ? read8(addr & 0xFFFFFF) : read16(addr & 0xFFFFFF);
+    }
     sync(2);
     
     return result;
 }
 
+u16
+Moira::fetch16(u32 addr)
+{
+    if (ENABLE_FETCH_TABLE && fetchPtr) {
+        
+        u32 bank = addr >> 16;
+        if (u8 *ptr = fetchPtr[bank]) {
+            
+            (*fetchCnt[bank])++;
+            return R16BE_ALIGNED(ptr + (addr & 0xFFFF));
+        }
+    }
+    return read16(addr);
+}
+
 template<Mode M, Size S, Flags F> u32
 Moira::readM(u32 addr, bool &error)
 {
@@ -7,13 +7,21 @@
 // See https://www.gnu.org for license information
 // -----------------------------------------------------------------------------
 
+// Converts an instruction handler into an entry of the instruction jump table
+
+#if PLAIN_EXEC_TABLE
+#define EXEC_PTR(...) &Moira::trampoline<&Moira::__VA_ARGS__>
+#else
+#define EXEC_PTR(...) &Moira::__VA_ARGS__
+#endif
+
 // Adds a single entry to the instruction jump table
 
 #define TPARAM(x,y,z) <x,y,z>
 #define bind(id, name, I, M, S) { \
-assert(exec[id] == &Moira::execIllegal); \
+assert(exec[id] == EXEC_PTR(execIllegal)); \
 if (dasm) assert(dasm[id] == &Moira::dasmIllegal); \
-exec[id] = &Moira::exec##name TPARAM(I, M, S); \
+exec[id] = EXEC_PTR(exec##name TPARAM(I, M, S)); \
 if (dasm) dasm[id] = &Moira::dasm##name TPARAM(I, M, S); \
 if (info) info[id] = InstrInfo { I, M, S }; \
 }
@@ -125,7 +133,7 @@ Moira::createJumpTables()
     //
 
     for (int i = 0; i < 0x10000; i++) {
-        exec[i] = &Moira::execIllegal;
+        exec[i] = EXEC_PTR(execIllegal);
         if (dasm) dasm[i] = &Moira::dasmIllegal;
         if (info) info[i] = InstrInfo { ILLEGAL, MODE_IP, (Size)0 };
     }
@@ -138,11 +146,11 @@ Moira::createJumpTables()
 
     for (int i = 0; i < 0x1000; i++) {
 
-        exec[0b1010 << 12 | i] = &Moira::execLineA;
+        exec[0b1010 << 12 | i] = EXEC_PTR(execLineA);
         if (dasm) dasm[0b1010 << 12 | i] = &Moira::dasmLineA;
         if (info) info[0b1010 << 12 | i] = InstrInfo { LINE_A, MODE_IP, (Size)0 };
 
-        exec[0b1111 << 12 | i] = &Moira::execLineF;
+        exec[0b1111 << 12 | i] = EXEC_PTR(execLineF);
         if (dasm) dasm[0b1111 << 12 | i] = &Moira::dasmLineF;
         if (info) info[0b1111 << 12 | i] = InstrInfo { LINE_F, MODE_IP, (Size)0 };
     }
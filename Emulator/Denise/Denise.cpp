@@ -41,6 +41,7 @@ Denise::_reset(bool hard)
     
     memset(bBuffer, 0, sizeof(bBuffer));
     memset(iBuffer, 0, sizeof(iBuffer));
+    drawCount = 0;
     memset(mBuffer, 0, sizeof(mBuffer));
     memset(zBuffer, 0, sizeof(zBuffer));
 }
@@ -269,28 +270,95 @@ Denise::fillShiftRegisters(bool odd, bool even)
         case 2: shiftReg[1] = bpldat[1];
         case 1: shiftReg[0] = bpldat[0];
     }
+}
+
+void
+Denise::recordDraw(Pixel pixel, u8 mask, u8 planes, bool hiresMode)
+{
+    if (drawCount == drawCapacity) convertDraws();
     
-    // On Intel machines, call the optimized SSE code
-    #if (defined(__i386__) || defined(__x86_64__)) && defined(__MACH__)
+    memcpy(drawData[drawCount], shiftReg, sizeof(shiftReg));
+    drawInfo[drawCount++] = DrawRecord { pixel, mask, planes, hiresMode };
+}
+
+void
+Denise::convertDraws()
+{
+    for (isize i = 0; i < drawCount;) {
+        
+        auto &info = drawInfo[i];
+        isize width = info.hires ? 16 : 32;
+        isize j = i + 1;
+        
+        // Convert the records drawing odd and even planes en bloc
+        if (info.planes == 0b111111) {
+            
+            // Collect all records continuing the block
+            for (; j < drawCount; j++) {
+                
+                auto &next = drawInfo[j];
+                if (next.planes != info.planes || next.mask != info.mask) break;
+                if (next.hires != info.hires) break;
+                if (next.pixel != drawInfo[j - 1].pixel + width) break;
+            }
+            
+            assert(info.pixel >= 0);
+            assert(info.pixel + (j - i) * width <= isizeof(bBuffer));
+            
+            if (!NO_SSE) {
+                util::transposeBlock(drawData[i], j - i, info.mask, !info.hires,
+                                     bBuffer + info.pixel);
+            } else {
+                util::transposeBlockScalar(drawData[i], j - i, info.mask, !info.hires,
+                                           bBuffer + info.pixel);
+            }
+            
+        } else {
+            
+            convertDraw(i);
+        }
+        i = j;
+    }
     
+    drawCount = 0;
+}
+
+void
+Denise::convertDraw(isize nr)
+{
+    auto &info = drawInfo[nr];
+    
+    // Compute the bit slices with the fastest kernel the host supports
     if (!NO_SSE) {
-        util::transposeSSE(shiftReg, slice);
-        return;
+        util::transpose(drawData[nr], slice);
+    } else {
+        util::transposeScalar(drawData[nr], slice);
     }
     
-    #endif
+    // Only overwrite the bits of the drawn planes
+    u8 keep = ~info.planes & 0b111111;
+    Pixel currentPixel = info.pixel;
     
-    // On all other machines, fallback to the slower standard implementation
-    u32 mask = 0x8000;
-    for (isize i = 0; i < 16; i++, mask >>= 1) {
+    for (isize i = 0; i < 16; i++) {
         
-        slice[i] =
-        (!!(shiftReg[0] & mask) << 0) |
-        (!!(shiftReg[1] & mask) << 1) |
-        (!!(shiftReg[2] & mask) << 2) |
-        (!!(shiftReg[3] & mask) << 3) |
-        (!!(shiftReg[4] & mask) << 4) |
-        (!!(shiftReg[5] & mask) << 5);
+        u8 index = slice[i] & info.mask;
+        
+        if (info.hires) {
+            
+            // Synthesize one hires pixel
+            assert(currentPixel < isizeof(bBuffer));
+            bBuffer[currentPixel] = (bBuffer[currentPixel] & keep) | index;
+            currentPixel++;
+            
+        } else {
+            
+            // Synthesize two lores pixels
+            assert(currentPixel + 1 < isizeof(bBuffer));
+            bBuffer[currentPixel] = (bBuffer[currentPixel] & keep) | index;
+            currentPixel++;
+            bBuffer[currentPixel] = (bBuffer[currentPixel] & keep) | index;
+            currentPixel++;
+        }
     }
 }
 
@@ -310,30 +378,7 @@ Denise::drawOdd(Pixel offset)
        0b010101          // 6 bitplanes
     };
     
-    u16 mask = masks[bpu()];
-    Pixel currentPixel = agnus.ppos() + offset;
-    
-    for (isize i = 0; i < 16; i++) {
-        
-        u8 index = slice[i] & mask;
-        
-        if (hiresMode) {
-            
-            // Synthesize one hires pixel
-            assert(currentPixel < isizeof(bBuffer));
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b101010) | index;
-            currentPixel++;
-            
-        } else {
-            
-            // Synthesize two lores pixels
-            assert(currentPixel + 1 < isizeof(bBuffer));
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b101010) | index;
-            currentPixel++;
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b101010) | index;
-            currentPixel++;
-        }
-    }
+    recordDraw(agnus.ppos() + offset, masks[bpu()], 0b010101, hiresMode);
  
     // Disarm and clear the shift registers
     armedOdd = false;
@@ -356,30 +401,7 @@ Denise::drawEven(Pixel offset)
        0b101010          // 6 bitplanes
     };
     
-    u16 mask = masks[bpu()];
-    i16 currentPixel = agnus.ppos() + offset;
-    
-    for (isize i = 0; i < 16; i++) {
-
-        u8 index = slice[i] & mask;
-
-        if (hiresMode) {
-            
-            // Synthesize one hires pixel
-            assert(currentPixel < isizeof(bBuffer));
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b010101) | index;
-            currentPixel++;
-
-        } else {
-            
-            // Synthesize two lores pixels
-            assert(currentPixel + 1 < isizeof(bBuffer));
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b010101) | index;
-            currentPixel++;
-            bBuffer[currentPixel] = (bBuffer[currentPixel] & 0b010101) | index;
-            currentPixel++;
-        }
-    }
+    recordDraw(agnus.ppos() + offset, masks[bpu()], 0b101010, hiresMode);
  
     // Disarm and clear the shift registers
     armedEven = false;
@@ -399,27 +421,7 @@ Denise::drawBoth(Pixel offset)
         0b111111          // 6 bitplanes
     };
     
-    u16 mask = masks[bpu()];
-    i16 currentPixel = agnus.ppos() + offset;
-    
-    for (isize i = 0; i < 16; i++) {
-        
-        u8 index = slice[i] & mask;
-        
-        if (hiresMode) {
-            
-            // Synthesize one hires pixel
-            assert(currentPixel < isizeof(bBuffer));
-            bBuffer[currentPixel++] = index;
-            
-        } else {
-            
-            // Synthesize two lores pixels
-            assert(currentPixel + 1 < isizeof(bBuffer));
-            bBuffer[currentPixel++] = index;
-            bBuffer[currentPixel++] = index;
-        }
-    }
+    recordDraw(agnus.ppos() + offset, masks[bpu()], 0b111111, hiresMode);
     
     // Disarm and clear the shift registers
     armedEven = armedOdd = false;
@@ -1112,6 +1114,7 @@ Denise::beginOfLine(int vpos)
 
     // Clear the bBuffer
     memset(bBuffer, 0, sizeof(bBuffer));
+    drawCount = 0;
 
     // Reset the sprite clipping range
     spriteClipBegin = HPIXELS;
@@ -1121,8 +1124,13 @@ Denise::beginOfLine(int vpos)
 void
 Denise::endOfLine(int vpos)
 {
+    PROFILE(PROF_END_OF_LINE);
+
     // debug("endOfLine pixel = %d HPIXELS = %d\n", pixel, HPIXELS);
 
+    // Convert the bitplane data drawn in this line
+    convertDraws();
+
     // Check if we are below the VBLANK area
     if (vpos >= 26) {
 
@@ -1144,11 +1152,12 @@ Denise::endOfLine(int vpos)
         // Remove certain graphics layers if requested
         if (config.hiddenLayers) {
             pixelEngine.hide(vpos, config.hiddenLayers, config.hiddenLayerAlpha);
+            pixelEngine.invalidate(vpos);
         }
     } else {
         
         drawSprites();
-        pixelEngine.endOfVBlankLine();
+        pixelEngine.endOfVBlankLine(vpos);
     }
 
     assert(sprChanges[0].isEmpty());
@@ -1157,7 +1166,10 @@ Denise::endOfLine(int vpos)
     assert(sprChanges[3].isEmpty());
 
     // Invoke the DMA debugger
-    dmaDebugger.computeOverlay();
+    if (dmaDebugger.isEnabled()) {
+        dmaDebugger.computeOverlay();
+        pixelEngine.invalidate(vpos);
+    }
     
     // Encode a HIRES / LORES marker in the first HBLANK pixel
     *denise.pixelEngine.pixelAddr(HBLANK_MIN * 4) = hires() ? 0 : -1;
@@ -87,13 +87,26 @@ public:
      * written to. This is emulated in function fillShiftRegister().
      *
      * Note: The upper two array elements are dummy elements. We need them in
-     * order to pass the array as parameter to function transposeSSE().
+     * order to pass the array as parameter to function util::transpose().
      */
     u16 __attribute__ ((aligned (64))) shiftReg[8];
 
     // Bit slices computed out of the shift registers
     u8 __attribute__ ((aligned (64))) slice[16];
     
+    /* Bitplane data drawn in the current rasterline. The draw functions don't
+     * synthesize pixels right away. They record the contents of the shift
+     * registers instead, which are converted into the bBuffer at the end of
+     * the line. In most rasterlines, the display setup doesn't change. In this
+     * case, the recorded data forms a contiguous block of pixels which is
+     * converted in a single pass. All other records are converted one by one.
+     */
+    typedef struct { Pixel pixel; u8 mask; u8 planes; bool hires; } DrawRecord;
+    static constexpr isize drawCapacity = 128;
+    u16 __attribute__ ((aligned (64))) drawData[drawCapacity][8];
+    DrawRecord drawInfo[drawCapacity];
+    isize drawCount = 0;
+    
     // Flags indicating that the shift registers have been loaded
     bool armedEven;
     bool armedOdd;
@@ -509,6 +522,15 @@ public:
 
 private:
 
+    // Records the contents of the shift registers for being drawn later
+    void recordDraw(Pixel pixel, u8 mask, u8 planes, bool hiresMode);
+
+    // Converts all recorded bitplane data into the bBuffer
+    void convertDraws();
+
+    // Converts a single record. Called by convertDraws()
+    void convertDraw(isize nr);
+
     // Data type used by the translation functions
     typedef struct { u16 prio1; u16 prio2; bool pf2pri; bool ham; } PFState;
 
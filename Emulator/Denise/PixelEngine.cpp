@@ -10,9 +10,13 @@
 #include "config.h"
 #include "PixelEngine.h"
 #include "Agnus.h"
+#include "Checksum.h"
 #include "Colors.h"
 #include "Denise.h"
 #include "DmaDebugger.h"
+#include "Profiler.h"
+#include "RunAhead.h"
+#include "SSEUtils.h"
 
 PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 {
@@ -22,8 +26,14 @@ PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
     config.saturation = 50;
 
     // Allocate frame buffers
-    emuTexture[0].data = new u32[PIXELS]; emuTexture[0].longFrame = true;
-    emuTexture[1].data = new u32[PIXELS]; emuTexture[1].longFrame = true;
+    for (isize i = 0; i < 3; i++) {
+
+        emuTexture[i].data = new u32[PIXELS];
+        emuTexture[i].longFrame = true;
+        emuTexture[i].nr = 0;
+        emuTexture[i].changed = new u64[dirtyWords]();
+        emuTexture[i].dirty = new u64[dirtyWords]();
+    }
     
     // Create random background noise pattern
     const isize noiseSize = 2 * VPIXELS * HPIXELS;
@@ -48,8 +58,12 @@ PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 
 PixelEngine::~PixelEngine()
 {
-    delete[] emuTexture[0].data;
-    delete[] emuTexture[1].data;
+    for (isize i = 0; i < 3; i++) {
+
+        delete[] emuTexture[i].data;
+        delete[] emuTexture[i].changed;
+        delete[] emuTexture[i].dirty;
+    }
     delete[] noise;
 }
 
@@ -71,8 +85,17 @@ PixelEngine::_powerOn()
             u32 col = (line / 4) % 2 == (i / 8) % 2 ? 0xFF222222 : 0xFF444444;
             emuTexture[0].data[pos] = col;
             emuTexture[1].data[pos] = col;
+            emuTexture[2].data[pos] = col;
         }
     }
+
+    // Mark the contents of all buffers as unknown
+    for (isize line = 0; line < VPIXELS; line++) {
+
+        signature[0][line] = 0;
+        signature[1][line] = 0;
+        signature[2][line] = 0;
+    }
 }
 
 void
@@ -80,7 +103,6 @@ PixelEngine::_reset(bool hard)
 {
     RESET_SNAPSHOT_ITEMS(hard)
     
-    frameBuffer = & emuTexture[0];
     updateRGBA();
 }
 
@@ -193,6 +215,9 @@ PixelEngine::updateRGBA()
 
     // Update all RGBA values that are cached in indexedRgba[]
     for (isize i = 0; i < 32; i++) setColor(i, colreg[i]);
+
+    // Existing lines need to be redrawn with the new colors
+    generation++;
 }
 
 void
@@ -275,14 +300,36 @@ PixelEngine::adjustRGB(u8 &r, u8 &g, u8 &b)
 ScreenBuffer
 PixelEngine::getStableBuffer()
 {
-    ScreenBuffer result;
-    
-    synchronized {
-        result = (frameBuffer == &emuTexture[0]) ? emuTexture[1] : emuTexture[0];
+    // Take the buffer from the exchange slot if it contains a newer frame
+    if (slot.load(std::memory_order_relaxed) & newFrameBit) {
+        stable = slot.exchange((u8)stable, std::memory_order_acq_rel) & 0b11;
+        consuming.store(true, std::memory_order_relaxed);
     }
-    
-    assert(result.data);
-    return result;
+
+    assert(emuTexture[stable].data);
+    return emuTexture[stable];
+}
+
+ScreenBuffer
+PixelEngine::getCompletedBuffer() const
+{
+    assert(emuTexture[completed].data);
+    return emuTexture[completed];
+}
+
+void
+PixelEngine::setFrameListener(const void *listener, FrameCallback *func)
+{
+    frameCallback = nullptr;
+    frameListener = listener;
+    frameCallback = func;
+}
+
+void
+PixelEngine::removeFrameListener()
+{
+    frameCallback = nullptr;
+    frameListener = nullptr;
 }
 
 u32 *
@@ -306,18 +353,61 @@ PixelEngine::pixelAddr(isize pixel) const
 void
 PixelEngine::beginOfFrame()
 {
-    // Switch the working buffer
-    synchronized {
-        frameBuffer = (frameBuffer == &emuTexture[0]) ? &emuTexture[1] : &emuTexture[0];
-        frameBuffer->longFrame = agnus.frame.lof;
+    // Publish the completed frame if it is to be shown
+    if (runAhead.presentsFrame()) {
+
+        i64 nr = frameNr.load(std::memory_order_relaxed) + 1;
+        frameBuffer->nr = nr;
+
+        /* The last line is only drawn in long frames. In short frames, it keeps
+         * the contents it had when the buffer was used before.
+         */
+        if (!frameBuffer->longFrame) {
+
+            u64 value = signature[frameBuffer - emuTexture][VPOS_MAX];
+            if (value == 0 || value != signature[completed][VPOS_MAX]) {
+                frameBuffer->changed[VPOS_MAX >> 6] |= 1ULL << (VPOS_MAX & 63);
+            }
+        }
+
+        /* If the consumer hasn't taken the frame in the exchange slot, it will
+         * skip that frame. Its damage is carried over to the published frame,
+         * because the changed lines are relative to the skipped frame. The slot
+         * buffer is only read here. If the consumer takes the frame before
+         * the exchange, too many lines are reported dirty, which is harmless.
+         * Damage is only carried over while a consumer takes frames. Otherwise,
+         * it would pile up until all lines are dirty.
+         */
+        u8 pending = slot.load(std::memory_order_acquire);
+        u64 *skipped = (pending & newFrameBit) && consuming.load(std::memory_order_relaxed) ?
+        emuTexture[pending & 0b11].dirty : nullptr;
+
+        for (isize i = 0; i < dirtyWords; i++) {
+            frameBuffer->dirty[i] = frameBuffer->changed[i] | (skipped ? skipped[i] : 0);
+        }
+
+        // Swap the working buffer with the buffer in the exchange slot
+        completed = frameBuffer - emuTexture;
+        u8 prev = slot.exchange((u8)(completed | newFrameBit), std::memory_order_acq_rel);
+        frameBuffer = &emuTexture[prev & 0b11];
+        frameNr.store(nr, std::memory_order_release);
+
+        // Inform the frame listener
+        if (auto callback = frameCallback.load()) callback(frameListener, nr);
     }
+    frameBuffer->longFrame = agnus.frame.lof;
+    for (isize i = 0; i < dirtyWords; i++) frameBuffer->changed[i] = 0;
     
     dmaDebugger.vSyncHandler();
 }
 
 void
-PixelEngine::endOfVBlankLine()
+PixelEngine::endOfVBlankLine(isize line)
 {
+    // Only the HIRES / LORES marker is drawn in VBLANK lines
+    u64 hash = util::fnv_1a_it64(util::fnv_1a_init64(), generation);
+    recordSignature(line, util::fnv_1a_it64(hash, denise.hires()));
+
     // Apply all color register changes that happened in this line
     for (isize i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
         applyRegisterChange(colChanges.elements[i]);
@@ -346,16 +436,28 @@ PixelEngine::applyRegisterChange(const RegChange &change)
 void
 PixelEngine::colorize(isize line)
 {
+    PROFILE(PROF_COLORIZE);
+
     // Jump to the first pixel in the specified line in the active frame buffer
     u32 *dst = frameBuffer->data + line * HPIXELS;
     Pixel pixel = 0;
 
-    // Initialize the HAM mode hold register with the current background color
-    u16 hold = colreg[0];
-
     // Add a dummy register change to ensure we draw until the line end
     colChanges.insert(HPIXELS, RegChange { SET_NONE, 0 } );
 
+    // Skip the line if the working buffer already contains it
+    if (!recordSignature(line, computeSignature(line))) {
+
+        for (isize i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
+            applyRegisterChange(colChanges.elements[i]);
+        }
+        colChanges.clear();
+        return;
+    }
+
+    // Initialize the HAM mode hold register with the current background color
+    u16 hold = colreg[0];
+
     // Iterate over all recorded register changes
     for (isize i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
 
@@ -383,64 +485,124 @@ PixelEngine::colorize(isize line)
     colChanges.clear();
 }
 
-void
-PixelEngine::colorize(u32 *dst, Pixel from, Pixel to)
+// Hashes a memory area word by word, using four independent FNV-1a streams
+static u64
+hashWords(u64 hash, const void *addr, isize size)
 {
-    u8 *mbuf = denise.mBuffer;
+    const u8 *p = (const u8 *)addr;
+    u64 h[4] = { hash, hash ^ 1, hash ^ 2, hash ^ 3 };
+    u64 w[4];
 
-    for (Pixel i = from; i < to; i++) {
-        dst[i] = indexedRgba[mbuf[i]];
+    for (; size >= 32; size -= 32, p += 32) {
+
+        memcpy(w, p, 32);
+        for (isize i = 0; i < 4; i++) h[i] = util::fnv_1a_it64(h[i], w[i]);
+    }
+    for (; size > 0; size--, p++) {
+        h[0] = util::fnv_1a_it64(h[0], *p);
     }
+    for (isize i = 1; i < 4; i++) h[0] = util::fnv_1a_it64(h[0], h[i] ^ (h[i] >> 29));
+
+    return h[0];
 }
 
-void
-PixelEngine::colorizeHAM(u32 *dst, Pixel from, Pixel to, u16& ham)
+u64
+PixelEngine::computeSignature(isize line)
 {
-    u8 *bbuf = denise.bBuffer;
-    u8 *ibuf = denise.iBuffer;
-    u8 *mbuf = denise.mBuffer;
+    bool ham = hamMode;
 
-    for (Pixel i = from; i < to; i++) {
+    u64 hash = util::fnv_1a_it64(util::fnv_1a_init64(), generation);
+    hash = util::fnv_1a_it64(hash, denise.hires());
+    hash = util::fnv_1a_it64(hash, hamMode);
+    hash = hashWords(hash, colreg, sizeof(colreg));
 
-        u8 index = ibuf[i];
-        assert(isRgbaIndex(index));
+    for (isize i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
 
-        // switch ((index >> 4) & 0b11) {
-        switch ((bbuf[i] >> 4) & 0b11) {
+        RegChange &change = colChanges.elements[i];
+        hash = util::fnv_1a_it64(hash, colChanges.keys[i]);
+        hash = util::fnv_1a_it64(hash, (u64)change.addr << 16 | change.value);
+        if (change.addr == BPLCON0) ham |= Denise::ham(change.value);
+    }
 
-            case 0b00: // Get color from register
+    hash = hashWords(hash, denise.mBuffer, HPIXELS);
 
-                ham = colreg[index];
-                break;
+    // In HAM mode, the colors also depend on the bitplane data and sprites
+    if (ham) {
 
-            case 0b01: // Modify blue
+        hash = hashWords(hash, denise.bBuffer, HPIXELS);
+        hash = hashWords(hash, denise.iBuffer, HPIXELS);
+        hash = hashWords(hash, denise.zBuffer, sizeof(u16) * HPIXELS);
+    }
 
-                ham &= 0xFF0;
-                ham |= (index & 0b1111);
-                break;
+    // 0 is reserved for lines with unknown contents
+    return hash | 1;
+}
 
-            case 0b10: // Modify red
+bool
+PixelEngine::recordSignature(isize line, u64 value)
+{
+    assert(line < VPIXELS);
 
-                ham &= 0x0FF;
-                ham |= (index & 0b1111) << 8;
-                break;
+    isize working = frameBuffer - emuTexture;
 
-            case 0b11: // Modify green
+    if (value != signature[completed][line]) {
+        frameBuffer->changed[line >> 6] |= 1ULL << (line & 63);
+    }
+    if (value != signature[working][line]) {
+        signature[working][line] = value;
+        return true;
+    }
+    return false;
+}
 
-                ham &= 0xF0F;
-                ham |= (index & 0b1111) << 4;
-                break;
+void
+PixelEngine::invalidate(isize line)
+{
+    assert(line < VPIXELS);
 
-            default:
-                assert(false);
-        }
+    isize working = frameBuffer - emuTexture;
 
-        // Synthesize pixel
-        if (denise.spritePixelIsVisible(i)) {
-            dst[i] = rgba[colreg[mbuf[i]]];
-        } else {
-            dst[i] = rgba[ham];
-        }
+    signature[working][line] = 0;
+    frameBuffer->changed[line >> 6] |= 1ULL << (line & 63);
+}
+
+void
+PixelEngine::colorize(u32 *dst, Pixel from, Pixel to)
+{
+    u8 *mbuf = denise.mBuffer;
+
+    if (!NO_SSE) {
+        util::lookup8(indexedRgba, rgbaIndexCnt, mbuf + from, dst + from, to - from);
+    } else {
+        util::lookup8Scalar(indexedRgba, rgbaIndexCnt, mbuf + from, dst + from, to - from);
+    }
+}
+
+void
+PixelEngine::colorizeHAM(u32 *dst, Pixel from, Pixel to, u16& ham)
+{
+    u8 *bbuf = denise.bBuffer;
+    u8 *ibuf = denise.iBuffer;
+    u8 *mbuf = denise.mBuffer;
+
+    // Decode the HAM pixels into 12 bit Amiga colors
+    u16 colors[HPIXELS];
+    if (!NO_SSE) {
+        ham = util::decodeHAM(bbuf + from, ibuf + from, colreg, colors + from, to - from, ham);
+    } else {
+        ham = util::decodeHAMScalar(bbuf + from, ibuf + from, colreg, colors + from, to - from, ham);
+    }
+
+    // Let visible sprite pixels replace the HAM pixels
+    for (Pixel i = from; i < to; i++) {
+        if (denise.spritePixelIsVisible(i)) colors[i] = colreg[mbuf[i]];
+    }
+
+    // Synthesize pixels
+    if (!NO_SSE) {
+        util::lookup16(rgba, colors + from, dst + from, to - from);
+    } else {
+        util::lookup16Scalar(rgba, colors + from, dst + from, to - from);
     }
 }
 
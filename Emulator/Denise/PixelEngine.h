@@ -12,6 +12,8 @@
 #include "PixelEngineTypes.h"
 #include "AmigaComponent.h"
 #include "ChangeRecorder.h"
+#include "Constants.h"
+#include <atomic>
 
 class PixelEngine : public AmigaComponent {
 
@@ -32,20 +34,67 @@ private:
     // Screen buffers
     //
 
-    /* The emulator uses double-buffering for storing the computed textures.
-     * At any time, one of the two buffers is the "working buffer" and the other
-     * one the "stable buffer". All drawing functions write to the working
-     * buffer whereas the GPU reads from the stable buffer. Once a frame has
-     * been completed, the working buffer and the stable buffer are switched.
+    /* The emulator uses triple-buffering for storing the computed textures.
+     * At any time, one of the three buffers is the "working buffer", one is
+     * the "stable buffer", and one is stored in the exchange slot. All drawing
+     * functions write to the working buffer whereas the GPU reads from the
+     * stable buffer. Once a frame has been completed, the emulator swaps the
+     * working buffer with the slot. When the GPU asks for a frame, it swaps
+     * the stable buffer with the slot if the slot contains a newer frame.
+     * Both swaps are atomic exchanges. Hence, the emulator never waits for
+     * the GPU and the GPU always receives the most recently completed frame.
      */
-    ScreenBuffer emuTexture[2];
+    ScreenBuffer emuTexture[3];
 
-    // Pointer to the "working buffer"
+    // Pointer to the "working buffer" (owned by the emulator thread)
     ScreenBuffer *frameBuffer = &emuTexture[0];
 
+    // Index of the most recently completed buffer (owned by the emulator thread)
+    isize completed = 1;
+
+    // Index of the "stable buffer" (owned by the consumer thread)
+    isize stable = 1;
+
+    /* The exchange slot. Bits 0 and 1 contain the index of the buffer in the
+     * slot. Bit 2 is set if the buffer contains a frame the consumer hasn't
+     * seen yet.
+     */
+    std::atomic<u8> slot { 2 };
+    static const u8 newFrameBit = 0b100;
+
+    // Set when the consumer takes a frame for the first time
+    std::atomic<bool> consuming { false };
+
+    // Number of completed frames
+    std::atomic<i64> frameNr { 0 };
+
+    // The registered frame listener and its callback function
+    const void *frameListener = nullptr;
+    std::atomic<FrameCallback *> frameCallback { nullptr };
+
     // Buffer with background noise (random black and white pixels)
     u32 *noise;
 
+public:
+
+    // Number of words in the damage bitmaps of a screen buffer
+    static const isize dirtyWords = (VPIXELS + 63) / 64;
+
+private:
+
+    /* Line signatures. A signature is a hash over all data colorize() depends
+     * on. For each screen buffer, the signatures of the lines it contains are
+     * kept. If a line is to be drawn with the signature it already has in the
+     * working buffer, colorize() is skipped. If the signature differs from the
+     * signature of the same line in the most recently completed buffer, the
+     * line has changed.
+     * A signature of 0 marks a line with unknown contents.
+     */
+    u64 signature[3][VPIXELS] = { };
+
+    // Incremented whenever the lookup tables change (invalidates all signatures)
+    u64 generation = 0;
+
     
     //
     // Color management
@@ -187,9 +236,35 @@ private:
 
 public:
 
-    // Returns the stable frame buffer for long frames
+    /* Returns the stable buffer. If a newer frame is available, it becomes the
+     * new stable buffer. The function is lock-free and meant to be called by a
+     * single consumer thread, e.g., the GPU renderer. The returned buffer is
+     * not modified by the emulator until the next call.
+     */
     ScreenBuffer getStableBuffer();
 
+    /* Returns the most recently completed buffer. This function must be called
+     * on the emulator thread or while the emulator is not running. It doesn't
+     * interfere with the consumer of getStableBuffer().
+     */
+    ScreenBuffer getCompletedBuffer() const;
+
+    // Checks if a frame is available the consumer hasn't seen yet
+    bool isFrameAvailable() const { return slot.load() & newFrameBit; }
+
+    // Returns the sequence number of the most recently completed frame
+    i64 getFrameNr() const { return frameNr.load(); }
+
+    /* Registers a function that is called on the emulator thread whenever a
+     * frame has been completed. The notification bypasses the message queue.
+     * The listener should be registered while the emulator is not running.
+     * It can be removed at any time.
+     */
+    void setFrameListener(const void *listener, FrameCallback *func);
+
+    // Unregisters the frame listener
+    void removeFrameListener();
+
     // Returns a pointer to randon noise
     u32 *getNoise() const;
     
@@ -197,12 +272,34 @@ public:
     u32 *pixelAddr(isize pixel) const;
 
     // Called after each line in the VBLANK area
-    void endOfVBlankLine();
+    void endOfVBlankLine(isize line);
 
-    // Called after each frame to switch the frame buffers
+    // Called after each frame to publish the completed frame
     void beginOfFrame();
 
 
+    //
+    // Tracking damage
+    //
+
+public:
+
+    /* Marks a line of the working buffer as modified outside colorize(). The
+     * line is reported as changed and is redrawn when the buffer is used again.
+     */
+    void invalidate(isize line);
+
+private:
+
+    // Computes the signature of a line
+    u64 computeSignature(isize line);
+
+    /* Records the signature of a line in the working buffer and updates the
+     * changed-line bitmap. Returns true if the line needs to be redrawn.
+     */
+    bool recordSignature(isize line, u64 signature);
+
+
     //
     // Working with recorded register changes
     //
@@ -63,9 +63,27 @@ typedef struct
 {
     u32 *data;
     bool longFrame;
+
+    // Sequence number of the frame (counts all completed frames)
+    i64 nr;
+
+    /* Damage information. Both bitmaps contain a bit for each rasterline (bit
+     * i % 64 in word i / 64). In the changed bitmap, a set bit indicates that
+     * the line differs from the line in the previously completed frame. In the
+     * dirty bitmap, a set bit indicates that the line differs from the line in
+     * the frame the consumer of getStableBuffer() has taken before. The damage
+     * of frames the consumer has skipped is included. Hence, skipped frames
+     * (nr has advanced by more than one) need no special treatment. The first
+     * frame a consumer takes has to be drawn entirely.
+     */
+    u64 *changed;
+    u64 *dirty;
 }
 ScreenBuffer;
 
+// Callback function signature for frame notifications
+typedef void FrameCallback(const void *, i64);
+
 typedef struct
 {
     Palette palette;
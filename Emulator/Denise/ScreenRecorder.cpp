@@ -265,7 +265,7 @@ ScreenRecorder::vsyncHandler(Cycle target)
         // Video
         //
         
-        ScreenBuffer buffer = denise.pixelEngine.getStableBuffer();
+        ScreenBuffer buffer = denise.pixelEngine.getCompletedBuffer();
         
         isize width = sizeof(u32) * (cutout.x2 - cutout.x1);
         isize height = cutout.y2 - cutout.y1;
@@ -10,9 +10,21 @@
 #include "config.h"
 #include "Disk.h"
 #include "DiskFile.h"
+#include "Checksum.h"
+#include <algorithm>
+#include <atomic>
 
-Disk::Disk(DiskDiameter type, DiskDensity density)
-{    
+Disk::Disk(DiskDiameter type, DiskDensity density) : Disk(type, density, allocData())
+{
+    clearDisk();
+}
+
+// Source of the unique disk identifiers
+static std::atomic<u64> nextId { 1 };
+
+Disk::Disk(DiskDiameter type, DiskDensity density, DiskData &data) : data(data)
+{
+    this->id = nextId++;
     this->diameter = type;
     this->density = density;
     
@@ -23,12 +35,20 @@ Disk::Disk(DiskDiameter type, DiskDensity density)
 
     assert(trackLength != 0);
     for (isize i = 0; i < 168; i++) length.track[i] = trackLength;
-    
-    clearDisk();
 }
 
 Disk::~Disk()
 {
+    util::freeMappable(&data, sizeof(DiskData));
+}
+
+Disk::DiskData &
+Disk::allocData()
+{
+    u8 *result = util::allocMappable(sizeof(DiskData));
+    if (!result) throw std::bad_alloc();
+
+    return *(DiskData *)result;
 }
 
 Disk *
@@ -49,12 +69,78 @@ Disk::makeWithFile(DiskFile *file)
 Disk *
 Disk::makeWithReader(util::SerReader &reader, DiskDiameter type, DiskDensity density)
 {
-    Disk *disk = new Disk(type, density);
+    // The disk data is overwritten. Hence, there is no need to clear it
+    Disk *disk = new Disk(type, density, allocData());
     disk->applyToPersistentItems(reader);
     
     return disk;
 }
 
+isize
+Disk::serializedSize()
+{
+    // The size does not depend on the disk contents
+    static const isize result = [] {
+
+        Disk disk(INCH_35, DISK_DD, allocData());
+        util::SerCounter counter;
+        disk.applyToPersistentItems(counter);
+        return counter.count;
+    }();
+
+    return result;
+}
+
+bool
+Disk::isValidType(DiskDiameter type, DiskDensity density)
+{
+    // Only these combinations have a track length (see constructor)
+    return
+    (type == INCH_35  && density == DISK_DD) ||
+    (type == INCH_35  && density == DISK_HD) ||
+    (type == INCH_525 && density == DISK_DD);
+}
+
+Disk *
+Disk::fork()
+{
+    // Freeze the disk data if it has been modified since the last fork
+    if (thawed) {
+
+        auto file = std::make_shared<util::AnonymousFile>(data.raw, isizeof(data));
+
+        if (file->isValid() && file->map(&data)) {
+
+            frozen = file;
+            thawed = false;
+
+        } else {
+
+            frozen = nullptr;
+        }
+    }
+
+    // Share the frozen data or copy the data if freezing has failed
+    DiskData *copy = frozen ? (DiskData *)frozen->map() : nullptr;
+    if (!copy) {
+
+        copy = &allocData();
+        memcpy(copy->raw, data.raw, sizeof(data.raw));
+    }
+
+    Disk *disk = new Disk(diameter, density, *copy);
+    disk->length = length;
+    disk->writeProtected = writeProtected;
+    disk->modified = modified;
+    disk->fnv = fnv;
+    disk->frozen = frozen;
+    disk->thawed = frozen == nullptr;
+    std::copy(std::begin(trackHash), std::end(trackHash), disk->trackHash);
+    std::copy(std::begin(trackHashed), std::end(trackHashed), disk->trackHashed);
+
+    return disk;
+}
+
 void
 Disk::dump()
 {
@@ -70,6 +156,31 @@ Disk::dump()
     msg("             fnv : %llu\n", fnv);
 }
 
+u64
+Disk::hash()
+{
+    // Hash the disk parameters
+    u64 result = util::fnv_1a_init64();
+    result = util::fnv_1a_it64(result, diameter);
+    result = util::fnv_1a_it64(result, density);
+    result = util::fnv_1a_it64(result, writeProtected);
+    result = util::fnv_1a_it64(result, modified);
+    result = util::fnv_1a_it64(result, fnv);
+
+    // Hash the disk data, rehashing all tracks that have been modified
+    for (isize t = 0; t < 168; t++) {
+
+        if (!trackHashed[t]) {
+
+            trackHash[t] = util::fnv_1a_64(data.track[t], isizeof(data.track[t]));
+            trackHashed[t] = true;
+        }
+        result = util::fnv_1a_it64(result, trackHash[t]);
+    }
+
+    return result;
+}
+
 u8
 Disk::readByte(Track t, u16 offset) const
 {
@@ -96,6 +207,7 @@ Disk::writeByte(u8 value, Track t, u16 offset)
     assert(offset < length.track[t]);
 
     data.track[t][offset] = value;
+    touch(t);
 }
 
 void
@@ -106,12 +218,34 @@ Disk::writeByte(u8 value, Cylinder c, Side s, u16 offset)
     assert(offset < length.cylinder[c][s]);
 
     data.cylinder[c][s][offset] = value;
+    touch(2 * c + s);
+}
+
+void
+Disk::touch(Track t)
+{
+    trackHashed[t] = false;
+    trackStamp[t] = ++stamp;
+    thawed = true;
+}
+
+void
+Disk::touchAll()
+{
+    stamp++;
+    for (Track t = 0; t < 168; t++) {
+
+        trackHashed[t] = false;
+        trackStamp[t] = stamp;
+    }
+    thawed = true;
 }
 
 void
 Disk::clearDisk()
 {
     fnv = 0;
+    touchAll();
 
     // Initialize with random data
     srand(0);
@@ -135,6 +269,7 @@ void
 Disk::clearTrack(Track t)
 {
     assert(t < numTracks());
+    touch(t);
 
     srand(0);
     for (isize i = 0; i < length.track[t]; i++) {
@@ -146,6 +281,7 @@ void
 Disk::clearTrack(Track t, u8 value)
 {
     assert(t < numTracks());
+    touch(t);
 
     for (isize i = 0; i < isizeof(data.track[t]); i++) {
         data.track[t][i] = value;
@@ -156,6 +292,7 @@ void
 Disk::clearTrack(Track t, u8 value1, u8 value2)
 {
     assert(t < numTracks());
+    touch(t);
 
     for (isize i = 0; i < length.track[t]; i++) {
         data.track[t][i] = (i % 2) ? value2 : value1;
@@ -172,7 +309,11 @@ Disk::encodeDisk(DiskFile *df)
     clearDisk();
 
     // Call the MFM encoder
-    return df->encodeDisk(this);
+    bool result = df->encodeDisk(this);
+
+    // The encoder writes into the disk data directly
+    touchAll();
+    return result;
 }
 
 void
@@ -266,6 +407,8 @@ Disk::addClockBits(u8 value, u8 previous)
 void
 Disk::repeatTracks()
 {
+    touchAll();
+
     for (Track t = 0; t < 168; t++) {
         
         isize end = length.track[t];
@@ -11,6 +11,8 @@
 
 #include "DiskTypes.h"
 #include "HardwareComponent.h"
+#include "SharedMemory.h"
+#include <memory>
 
 /* MFM encoded disk data of a standard 3.5" DD disk:
  *
@@ -52,6 +54,8 @@ class Disk : public AmigaObject {
     friend class Drive;
     friend class ADFFile;
     friend class IMGFile;
+    friend class InputRecorder;
+    friend class DeltaSnapshot;
     
 public:
     
@@ -64,11 +68,41 @@ public:
 private:
     
     // The MFM encoded disk data
-    union {
+    union DiskData {
         u8 raw[168*32768];
         u8 cylinder[84][2][32768];
         u8 track[168][32768];
-    } data;
+    };
+
+    /* The disk data is allocated separately, because it can be shared
+     * copy-on-write with the disks of forked emulator instances.
+     * See also: fork()
+     */
+    DiskData &data;
+
+    // Frozen disk data shared with forked disks (if any)
+    std::shared_ptr<util::AnonymousFile> frozen;
+
+    // Indicates if the disk data differs from the frozen copy
+    bool thawed = true;
+
+    /* Checksums of all tracks. A checksum is only valid if the corresponding
+     * flag is set. The flag is cleared whenever the track is modified.
+     * See also: hash()
+     */
+    u64 trackHash[168] = {};
+    bool trackHashed[168] = {};
+
+    /* Modification stamps of all tracks. Whenever a track is modified, it is
+     * assigned the next value of the stamp counter. Together with the unique
+     * disk id, the stamps enable delta snapshots to record modified tracks
+     * only. See also: DeltaSnapshot
+     */
+    u64 trackStamp[168] = {};
+    u64 stamp = 0;
+
+    // Unique identifier of this disk object (never 0)
+    u64 id;
         
     // Length of each track in bytes
     union {
@@ -96,10 +130,32 @@ public:
     Disk(DiskDiameter type, DiskDensity density);
     ~Disk();
 
+    Disk(const Disk &) = delete;
+    Disk &operator=(const Disk &) = delete;
+
     const char *getDescription() const override { return "Disk"; }
 
     static Disk *makeWithFile(class DiskFile *file);
     static Disk *makeWithReader(util::SerReader &reader, DiskDiameter type, DiskDensity density);
+
+    /* Creates a copy of this disk. The disk data is not copied. It is shared
+     * copy-on-write between both disks instead. To make this possible, the
+     * data is frozen, i.e., written into an anonymous file which is mapped by
+     * both disks. Subsequent forks reuse the frozen data as long as the disk
+     * has not been written to. After the disk has been created, the disk data
+     * must only be modified by the functions of this class.
+     */
+    Disk *fork();
+
+private:
+
+    // Creates a disk with the provided disk data
+    Disk(DiskDiameter type, DiskDensity density, DiskData &data);
+
+    // Allocates the disk data
+    static DiskData &allocData();
+
+public:
         
     void dump();
     
@@ -123,6 +179,14 @@ private:
         << fnv;
     }
 
+public:
+
+    // Returns the number of bytes written by applyToPersistentItems()
+    static isize serializedSize();
+
+    // Checks if a disk with the given geometry can be created
+    static bool isValidType(DiskDiameter type, DiskDensity density);
+
 
     //
     // Accessing disk parameters
@@ -145,6 +209,25 @@ public:
     
     u64 getFnv() const { return fnv; }
     
+    /* Computes a checksum over the serialized state of this disk. Only the
+     * tracks that have been modified since the last call are rehashed.
+     */
+    u64 hash();
+
+    // Returns the unique identifier of this disk
+    u64 getId() const { return id; }
+
+    // Returns the value the stamp counter had when a track was last modified
+    u64 getStamp() const { return stamp; }
+
+private:
+
+    // Marks a single track or all tracks as modified
+    void touch(Track t);
+    void touchAll();
+
+public:
+    
 
     //
     // Reading and writing
@@ -11,6 +11,7 @@
 #include "Drive.h"
 #include "Agnus.h"
 #include "BootBlockImage.h"
+#include "Checksum.h"
 #include "CIA.h"
 #include "DiskFile.h"
 #include "FSDevice.h"
@@ -236,7 +237,7 @@ Drive::_size()
     // Add the size of the boolean indicating whether a disk is inserted
     counter.count += sizeof(bool);
 
-    if (hasDisk()) {
+    if (hasDisk() && serializeDisk) {
 
         // Add the disk type and disk state
         counter << disk->getDiameter() << disk->getDensity();
@@ -258,16 +259,25 @@ Drive::_load(const u8 *buffer)
     applyToHardResetItems(reader);
     applyToResetItems(reader);
 
+    // Check if the snapshot includes a disk
+    bool diskInSnapshot;
+    reader << diskInSnapshot;
+
+    // Keep the current disk if the disk is not part of the state
+    if (!serializeDisk) {
+        
+        assert(diskInSnapshot == hasDisk());
+        result = (isize)(reader.ptr - buffer);
+        trace(SNP_DEBUG, "Recreated from %zd bytes\n", result);
+        return result;
+    }
+    
     // Delete the current disk
     if (disk) {
         delete disk;
         disk = nullptr;
     }
 
-    // Check if the snapshot includes a disk
-    bool diskInSnapshot;
-    reader << diskInSnapshot;
-
     // If yes, create recreate the disk
     if (diskInSnapshot) {
         DiskDiameter type;
@@ -296,7 +306,7 @@ Drive::_save(u8 *buffer)
     // Indicate whether this drive has a disk is inserted
     writer << hasDisk();
 
-    if (hasDisk()) {
+    if (hasDisk() && serializeDisk) {
 
         // Write the disk type
         writer << disk->getDiameter() << disk->getDensity();
@@ -310,6 +320,39 @@ Drive::_save(u8 *buffer)
     return result;
 }
 
+u64
+Drive::_hash()
+{
+    // Hash the drive state without the disk
+    serializeDisk = false;
+    u64 result = HardwareComponent::_hash();
+    serializeDisk = true;
+
+    // Hash the disk separately to only rehash modified tracks
+    if (hasDisk()) result = util::fnv_1a_it64(result, disk->hash());
+
+    return result;
+}
+
+void
+Drive::startJournal()
+{
+    journal.clear();
+    journaling = true;
+}
+
+void
+Drive::rollbackJournal()
+{
+    assert(journal.empty() || disk);
+    
+    for (auto it = journal.rbegin(); it != journal.rend(); it++) {
+        disk->writeByte(it->value, it->head.cylinder, it->head.side, it->head.offset);
+    }
+    journal.clear();
+    journaling = false;
+}
+
 bool
 Drive::idMode() const
 {
@@ -493,6 +536,10 @@ void
 Drive::writeByte(u8 value)
 {
     if (disk) {
+        
+        if (journaling) {
+            journal.push_back({ head, disk->readByte(head.cylinder, head.side, head.offset) });
+        }
         disk->writeByte(value, head.cylinder, head.side, head.offset);
     }
 }
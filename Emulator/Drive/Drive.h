@@ -72,6 +72,22 @@ public:
     // The currently inserted disk (nullptr if the drive is empty)
     Disk *disk = nullptr;
 
+    /* Indicates if the inserted disk is part of the serialized state. The flag
+     * is cleared temporarily by the run-ahead mechanism. In this case, the
+     * disk stays in place when the state is restored and all disk writes are
+     * reverted with the help of the undo journal.
+     */
+    bool serializeDisk = true;
+
+private:
+
+    // Undo journal storing the overwritten bytes of all recorded disk writes
+    struct JournalEntry { DriveHead head; u8 value; };
+    std::vector<JournalEntry> journal;
+
+    // Indicates if disk writes are recorded in the undo journal
+    bool journaling = false;
+
     
     //
     // Initializing
@@ -161,6 +177,7 @@ private:
     isize _size() override;
     isize _load(const u8 *buffer) override;
     isize _save(u8 *buffer) override;
+    u64 _hash() override;
 
 
     //
@@ -225,6 +242,19 @@ public:
     // Rotates the disk to the next sync mark
     void findSyncMark();
 
+
+    //
+    // Recording disk writes
+    //
+
+public:
+
+    // Starts recording all disk writes in the undo journal
+    void startJournal();
+
+    // Reverts all disk writes recorded since the journal has been started
+    void rollbackJournal();
+
     //
     // Moving the drive head
     //
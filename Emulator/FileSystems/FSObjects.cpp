@@ -12,6 +12,7 @@
 #include "FSBlock.h"
 #include <algorithm>
 #include <cstring>
+#include <ctime>
 
 FSString::FSString(const char *str, isize l) : limit(l)
 {
@@ -19,6 +19,9 @@
 #include "HDFFile.h"
 #include "RomFile.h"
 #include "ExtendedRomFile.h"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
 
 AmigaFile::AmigaFile(isize capacity)
 {
@@ -149,15 +152,34 @@ isize
 AmigaFile::writeToFile(const char *path)
 {
     assert(path);
-        
-    std::ofstream stream(path);
+
+    /* Write into a temporary file first which replaces the target file
+     * afterwards. Hence, an existing file is never left in a partially written
+     * state. Furthermore, it stays intact if it has been mapped into memory,
+     * e.g., by a mapped snapshot.
+     */
+    string tmpPath = string(path) + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream stream(tmpPath, std::ios::binary);
 
     if (!stream.is_open()) {
         throw VAError(ERROR_FILE_CANT_WRITE);
     }
     
-    isize result = writeToStream(stream);
+    isize result;
+    try { result = writeToStream(stream); } catch (...) {
+
+        stream.close();
+        std::remove(tmpPath.c_str());
+        throw;
+    }
     assert(result == size);
+    stream.close();
+
+    if (!stream || std::rename(tmpPath.c_str(), path) != 0) {
+
+        std::remove(tmpPath.c_str());
+        throw VAError(ERROR_FILE_CANT_WRITE);
+    }
     
     return result;
 }
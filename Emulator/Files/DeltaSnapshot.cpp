@@ -0,0 +1,303 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "DeltaSnapshot.h"
+#include "Amiga.h"
+
+static void
+append(std::vector<u8> &buffer, const void *src, isize count)
+{
+    const u8 *bytes = (const u8 *)src;
+    buffer.insert(buffer.end(), bytes, bytes + count);
+}
+
+template <class T> static T
+extract(const u8 *&ptr)
+{
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return value;
+}
+
+DeltaSnapshot *
+DeltaSnapshot::makeWithAmiga(Amiga *amiga, DeltaChain &chain, bool keyframe)
+{
+    DeltaSnapshot *delta = new DeltaSnapshot();
+    std::vector<u8> &data = delta->data;
+
+    // Serialize the current component state
+    std::vector<u8> current;
+    saveImage(amiga, current);
+
+    Header header;
+    header.keyframe = keyframe;
+    header.fullImage = keyframe || chain.image.size() != current.size();
+    header.imageSize = (i64)current.size();
+    header.numTracks = 0;
+    header.numBlocks = 0;
+    header.numPages = 0;
+    append(data, &header, sizeof(header));
+
+    // Record the changes of all disks
+    for (isize i = 0; i < 4; i++) saveDisk(amiga, i, chain, keyframe, data, header);
+
+    // Record all component blocks that have changed
+    for (isize offset = 0; offset < isize(current.size()); offset += BLOCK_SIZE) {
+
+        isize count = std::min(BLOCK_SIZE, isize(current.size()) - offset);
+        if (!header.fullImage &&
+            memcmp(current.data() + offset, chain.image.data() + offset, count) == 0) {
+            continue;
+        }
+
+        u32 nr = (u32)(offset / BLOCK_SIZE);
+        append(data, &nr, sizeof(nr));
+        append(data, current.data() + offset, count);
+        header.numBlocks++;
+    }
+
+    // Record all memory pages that have changed
+    Memory &mem = amiga->mem;
+
+    DirtyRegion regions[MEM_REGION_COUNT];
+    mem.getDirtyRegions(regions);
+
+    for (u8 r = 0; r < MEM_REGION_COUNT; r++) {
+
+        if (!regions[r].ptr) continue;
+
+        for (isize offset = 0; offset < regions[r].size; offset += MEM_PAGE_SIZE) {
+
+            u32 nr = (u32)(offset >> MEM_PAGE_SHIFT);
+            if (!keyframe && regions[r].dirty[nr] < chain.epoch) continue;
+
+            isize count = std::min((isize)MEM_PAGE_SIZE, regions[r].size - offset);
+            append(data, &r, sizeof(r));
+            append(data, &nr, sizeof(nr));
+            append(data, regions[r].ptr + offset, count);
+            header.numPages++;
+        }
+    }
+
+    // Update the header
+    memcpy(data.data(), &header, sizeof(header));
+
+    // The current state becomes the base of the next delta snapshot
+    chain.image.swap(current);
+    chain.epoch = mem.nextDirtyEpoch();
+
+    return delta;
+}
+
+DeltaSnapshot *
+DeltaSnapshot::makeWithBuffer(const u8 *buffer, isize size)
+{
+    assert(size >= isizeof(Header));
+
+    DeltaSnapshot *delta = new DeltaSnapshot();
+    delta->data.assign(buffer, buffer + size);
+
+    return delta;
+}
+
+void
+DeltaSnapshot::apply(Amiga *amiga) const
+{
+    const Header &header = *getHeader();
+    const u8 *ptr = data.data() + sizeof(Header);
+
+    // Get the current component state
+    std::vector<u8> image;
+    saveImage(amiga, image);
+
+    if (!header.fullImage && (i64)image.size() != header.imageSize) {
+        throw VAError(ERROR_SNP_MISMATCH);
+    }
+    image.resize(header.imageSize);
+
+    // Patch the disks (must precede loading the component state)
+    for (isize i = 0; i < 4; i++) loadDisk(amiga, i, ptr);
+
+    // Patch the component state
+    for (isize i = 0; i < header.numBlocks; i++) {
+
+        isize offset = extract<u32>(ptr) * BLOCK_SIZE;
+        isize count = std::min(BLOCK_SIZE, isize(image.size()) - offset);
+        memcpy(image.data() + offset, ptr, count);
+        ptr += count;
+    }
+    loadImage(amiga, image);
+
+    // Patch the memory (the memory layout may have changed)
+    DirtyRegion regions[MEM_REGION_COUNT];
+    amiga->mem.getDirtyRegions(regions);
+
+    for (isize i = 0; i < header.numPages; i++) {
+
+        DirtyRegion &region = regions[extract<u8>(ptr)];
+        u32 nr = extract<u32>(ptr);
+        isize offset = (isize)nr << MEM_PAGE_SHIFT;
+        isize count = std::min((isize)MEM_PAGE_SIZE, region.size - offset);
+
+        assert(region.ptr && count > 0);
+        memcpy(region.ptr + offset, ptr, count);
+        region.dirty[nr] = amiga->mem.dirtyEpoch;
+        ptr += count;
+    }
+}
+
+void
+DeltaSnapshot::saveImage(Amiga *amiga, std::vector<u8> &image)
+{
+    util::NativeByteOrder native;
+    amiga->mem.serializeContents = false;
+    for (isize i = 0; i < 4; i++) amiga->df[i]->serializeDisk = false;
+
+    image.resize(amiga->size());
+    amiga->save(image.data());
+
+    amiga->mem.serializeContents = true;
+    for (isize i = 0; i < 4; i++) amiga->df[i]->serializeDisk = true;
+}
+
+void
+DeltaSnapshot::loadImage(Amiga *amiga, const std::vector<u8> &image)
+{
+    util::NativeByteOrder native;
+    amiga->mem.serializeContents = false;
+    for (isize i = 0; i < 4; i++) amiga->df[i]->serializeDisk = false;
+
+    amiga->load(image.data());
+
+    amiga->mem.serializeContents = true;
+    for (isize i = 0; i < 4; i++) amiga->df[i]->serializeDisk = true;
+}
+
+void
+DeltaSnapshot::saveDisk(Amiga *amiga, isize nr, DeltaChain &chain, bool keyframe,
+                        std::vector<u8> &data, Header &header)
+{
+    Disk *disk = amiga->df[nr]->disk;
+
+    if (!disk) {
+
+        data.push_back(DISK_NONE);
+        chain.diskId[nr] = 0;
+        return;
+    }
+
+    if (keyframe || disk->getId() != chain.diskId[nr]) {
+
+        // Record the entire disk
+        util::SerCounter counter;
+        disk->applyToPersistentItems(counter);
+
+        std::vector<u8> buffer(counter.count);
+        util::SerWriter writer(buffer.data());
+        disk->applyToPersistentItems(writer);
+
+        i64 size = (i64)buffer.size();
+        data.push_back(DISK_FULL);
+        append(data, &disk->diameter, sizeof(disk->diameter));
+        append(data, &disk->density, sizeof(disk->density));
+        append(data, &size, sizeof(size));
+        append(data, buffer.data(), size);
+        header.numTracks += disk->numTracks();
+
+    } else {
+
+        // Record the disk flags and all tracks that have been written to
+        u8 count = 0;
+        for (Track t = 0; t < 168; t++) count += disk->trackStamp[t] > chain.diskStamp[nr];
+
+        data.push_back(DISK_TRACKS);
+        append(data, &disk->writeProtected, sizeof(disk->writeProtected));
+        append(data, &disk->modified, sizeof(disk->modified));
+        append(data, &disk->fnv, sizeof(disk->fnv));
+        append(data, &count, sizeof(count));
+
+        for (Track t = 0; t < 168; t++) {
+
+            if (disk->trackStamp[t] <= chain.diskStamp[nr]) continue;
+
+            u8 track = (u8)t;
+            append(data, &track, sizeof(track));
+            append(data, disk->data.track[t], sizeof(disk->data.track[t]));
+        }
+        header.numTracks += count;
+    }
+
+    chain.diskId[nr] = disk->getId();
+    chain.diskStamp[nr] = disk->getStamp();
+}
+
+void
+DeltaSnapshot::loadDisk(Amiga *amiga, isize nr, const u8 *&ptr)
+{
+    Drive &drive = *amiga->df[nr];
+
+    switch (extract<u8>(ptr)) {
+
+        case DISK_NONE:
+
+            delete drive.disk;
+            drive.disk = nullptr;
+            break;
+
+        case DISK_FULL:
+        {
+            auto diameter = extract<DiskDiameter>(ptr);
+            auto density = extract<DiskDensity>(ptr);
+            auto size = extract<i64>(ptr);
+
+            util::SerReader reader(ptr);
+            delete drive.disk;
+            drive.disk = Disk::makeWithReader(reader, diameter, density);
+            ptr += size;
+            break;
+        }
+        case DISK_TRACKS:
+        {
+            // Deltas of this kind are always preceded by a full disk record
+            if (!drive.disk) throw VAError(ERROR_SNP_MISMATCH);
+
+            Disk &disk = *drive.disk;
+            disk.writeProtected = extract<bool>(ptr);
+            disk.modified = extract<bool>(ptr);
+            disk.fnv = extract<u64>(ptr);
+
+            for (u8 count = extract<u8>(ptr); count > 0; count--) {
+
+                Track t = extract<u8>(ptr);
+                memcpy(disk.data.track[t], ptr, sizeof(disk.data.track[t]));
+                disk.touch(t);
+                ptr += sizeof(disk.data.track[t]);
+            }
+            break;
+        }
+        default:
+            throw VAError(ERROR_SNP_MISMATCH);
+    }
+}
+
+void
+DeltaSnapshot::rebase(Amiga *amiga, DeltaChain &chain)
+{
+    saveImage(amiga, chain.image);
+    chain.epoch = amiga->mem.nextDirtyEpoch();
+
+    for (isize i = 0; i < 4; i++) {
+
+        Disk *disk = amiga->df[i]->disk;
+        chain.diskId[i] = disk ? disk->getId() : 0;
+        chain.diskStamp[i] = disk ? disk->getStamp() : 0;
+    }
+}
@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "AmigaObject.h"
+#include <vector>
+
+class Amiga;
+
+// State of a delta snapshot chain
+struct DeltaChain {
+
+    // Component state at the time the most recent delta snapshot was taken
+    std::vector<u8> image;
+
+    // Memory pages written in this epoch or later have changed
+    u32 epoch = 0;
+
+    // Identifiers of the disks in df0 to df3 (0 = no disk)
+    u64 diskId[4] = {};
+
+    // Disk tracks with a higher modification stamp have changed
+    u64 diskStamp[4] = {};
+};
+
+/* A delta snapshot records the changes of the emulator state since the
+ * previous delta snapshot has been taken. It consists of three parts:
+ *
+ *          Disk tracks: For each drive, all tracks that have been written to
+ *                       since the previous delta snapshot was taken. If a
+ *                       different disk has been inserted, the entire disk is
+ *                       stored.
+ *
+ *     Component blocks: The state of all components is serialized without the
+ *                       memory contents and disks. The resulting image is
+ *                       divided into blocks of BLOCK_SIZE bytes and only those
+ *                       blocks are stored that differ from the image taken
+ *                       before.
+ *
+ *         Memory pages: All Ram and Rom pages that have been written to since
+ *                       the previous delta snapshot was taken.
+ *
+ * Delta snapshots form a chain. Applying a delta snapshot transfers the
+ * emulator from the state the previous delta snapshot was taken in to the
+ * state the delta snapshot was taken in. Hence, delta snapshots need to be
+ * applied in the same order as they were taken. A keyframe is a delta
+ * snapshot which stores all component blocks and all memory pages. It can be
+ * applied to any emulator state and serves as the starting point of a chain.
+ */
+class DeltaSnapshot : public AmigaObject {
+
+public:
+
+    // Granularity of the component state comparison
+    static constexpr isize BLOCK_SIZE = 256;
+
+private:
+
+    struct Header {
+
+        // Indicates if all component blocks are stored
+        bool fullImage;
+
+        // Indicates if all memory pages are stored
+        bool keyframe;
+
+        // Size of the serialized component state in bytes
+        i64 imageSize;
+
+        // Number of stored disk tracks, component blocks, and memory pages
+        i64 numTracks;
+        i64 numBlocks;
+        i64 numPages;
+    };
+
+    // Types of the disk records stored for each drive
+    enum DiskRecord : u8 { DISK_NONE, DISK_FULL, DISK_TRACKS };
+
+    // Serialized changes (header, disk records, component blocks, memory pages)
+    std::vector<u8> data;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    /* Records the changes since the previous delta snapshot of a chain. The
+     * chain is advanced to the current state. If the chain is empty, all
+     * component blocks and memory pages are recorded.
+     */
+    static DeltaSnapshot *makeWithAmiga(Amiga *amiga,
+                                        DeltaChain &chain,
+                                        bool keyframe = false);
+
+    // Recreates a delta snapshot from a buffer that was obtained by getData()
+    static DeltaSnapshot *makeWithBuffer(const u8 *buffer, isize size);
+
+    const char *getDescription() const override { return "DeltaSnapshot"; }
+
+
+    //
+    // Accessing
+    //
+
+public:
+
+    const Header *getHeader() const { return (const Header *)data.data(); }
+
+    // Returns a pointer to the serialized changes
+    const u8 *getData() const { return data.data(); }
+
+    // Returns the number of bytes occupied by this delta snapshot
+    isize size() const { return (isize)data.size(); }
+
+    // Returns true if this delta snapshot does not depend on its predecessors
+    bool isKeyframe() const { return getHeader()->keyframe; }
+
+    // Returns the number of stored disk tracks, component blocks, and memory pages
+    isize numTracks() const { return (isize)getHeader()->numTracks; }
+    isize numBlocks() const { return (isize)getHeader()->numBlocks; }
+    isize numPages() const { return (isize)getHeader()->numPages; }
+
+
+    //
+    // Restoring
+    //
+
+public:
+
+    /* Applies the recorded changes to the current emulator state. The function
+     * throws ERROR_SNP_MISMATCH if the delta snapshot cannot be applied,
+     * because the component state has a different layout.
+     */
+    void apply(Amiga *amiga) const throws;
+
+
+    //
+    // Helpers
+    //
+
+public:
+
+    // Serializes the state of all components without memory contents and disks
+    static void saveImage(Amiga *amiga, std::vector<u8> &image);
+
+    // Restores the state of all components without memory contents and disks
+    static void loadImage(Amiga *amiga, const std::vector<u8> &image);
+
+    /* Advances a chain to the current state without recording the changes.
+     * This function is called after the emulator state has been restored to
+     * the state the most recent delta snapshot of the chain was taken in.
+     */
+    static void rebase(Amiga *amiga, DeltaChain &chain);
+
+private:
+
+    // Records the changes of the disk in a drive
+    static void saveDisk(Amiga *amiga, isize nr, DeltaChain &chain, bool keyframe,
+                         std::vector<u8> &data, Header &header);
+
+    // Applies the recorded changes of the disk in a drive
+    static void loadDisk(Amiga *amiga, isize nr, const u8 *&ptr);
+};
@@ -0,0 +1,182 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "MappedSnapshot.h"
+#include "Amiga.h"
+#include "IO.h"
+#include <fstream>
+#include <sys/mman.h>
+
+SnapshotFileHeader
+MappedSnapshot::peek(const string &path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_NOT_FOUND);
+
+    u8 buffer[SnapshotFileHeader::size];
+    if (!stream.read((char *)buffer, sizeof(buffer))) throw VAError(ERROR_FILE_TYPE_MISMATCH);
+
+    SnapshotFileHeader result;
+    result.read(buffer);
+    result.verify(util::streamLength(stream));
+
+    return result;
+}
+
+MappedSnapshot::MappedSnapshot(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw VAError(ERROR_FILE_NOT_FOUND);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SnapshotFileHeader::size) {
+        close(fd);
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+
+    void *addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) { close(fd); throw VAError(ERROR_FILE_CANT_READ); }
+
+    // Keep the file open to map Ram blocks later
+    this->fd = fd;
+    base = (const u8 *)addr;
+    length = (isize)st.st_size;
+    mapped = true;
+
+    try { parse(); } catch (VAError &err) {
+        munmap((void *)base, (size_t)length);
+        close(fd);
+        throw err;
+    }
+}
+
+MappedSnapshot::MappedSnapshot(const u8 *buffer, isize length) : base(buffer), length(length)
+{
+    if (length < SnapshotFileHeader::size) throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    parse();
+}
+
+MappedSnapshot::~MappedSnapshot()
+{
+    if (mapped) munmap((void *)base, (size_t)length);
+    if (fd >= 0) close(fd);
+}
+
+void
+MappedSnapshot::parse()
+{
+    header.read(base);
+    header.verify(length);
+
+    // Locate the directory with the help of the trailer
+    const u8 *ptr = base + length - 8;
+    isize position = (isize)util::read64(ptr);
+    if (position < SnapshotFileHeader::size || position > length - 8) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+
+    sections = SnapshotSection::parseDirectory(base + position, length - 8 - position,
+                                               position, header);
+}
+
+isize
+MappedSnapshot::findSection(const string &name) const
+{
+    for (isize i = 0; i < (isize)sections.size(); i++) {
+        if (sections[i].name == name) return i;
+    }
+    return -1;
+}
+
+void
+MappedSnapshot::readSection(isize nr, u8 *buffer) const
+{
+    assert(nr >= 0 && nr < (isize)sections.size());
+
+    auto &section = sections[nr];
+
+    if (section.raw) {
+
+        memcpy(buffer, base + section.offset, section.rawSize);
+
+    } else {
+
+        isize count = util::decompressBlocks(base + section.offset, section.packedSize,
+                                             buffer, section.rawSize);
+
+        if (count != section.rawSize) throw VAError(ERROR_SNP_CORRUPTED);
+    }
+}
+
+void
+MappedSnapshot::readThumbnail(Thumbnail &thumbnail) const
+{
+    readSection(0, (u8 *)thumbnail.screen);
+
+    thumbnail.width = header.width;
+    thumbnail.height = header.height;
+    thumbnail.timestamp = (time_t)header.timestamp;
+}
+
+void
+MappedSnapshot::loadComponent(HardwareComponent &component) const
+{
+    isize nr = findSection(component.getDescription());
+    if (nr < 1) throw VAError(ERROR_SNP_MISMATCH);
+
+    // Raw sections can be loaded in place
+    if (sections[nr].raw) {
+
+        component.load(base + sections[nr].offset);
+        return;
+    }
+
+    std::vector<u8> buffer(sections[nr].rawSize);
+    readSection(nr, buffer.data());
+    component.load(buffer.data());
+}
+
+void
+MappedSnapshot::restore(Amiga &amiga) const
+{
+    auto &components = amiga.subComponents;
+    if (components.size() + 1 != sections.size()) throw VAError(ERROR_SNP_MISMATCH);
+
+    std::vector<u8> buffer;
+
+    for (isize i = 0; i < (isize)components.size(); i++) {
+
+        HardwareComponent *c = components[i];
+        auto &section = sections[i + 1];
+
+        if (!section.raw) {
+
+            buffer.resize(section.rawSize);
+            readSection(i + 1, buffer.data());
+            c->load(buffer.data());
+            continue;
+        }
+
+        if (c != &amiga.mem || fd < 0) {
+
+            c->load(base + section.offset);
+            continue;
+        }
+
+        /* Restore the memory state without the memory contents. Afterwards,
+         * map the memory blocks from the remainder of the section.
+         */
+        amiga.mem.serializeContents = false;
+        isize count = c->load(base + section.offset);
+        amiga.mem.serializeContents = true;
+
+        amiga.mem.mapContents(fd, section.offset + count, section.rawSize - count);
+    }
+}
@@ -0,0 +1,109 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Snapshot.h"
+
+class Amiga;
+class HardwareComponent;
+
+/* Provides random access to the sections of a snapshot container. In contrast
+ * to the Snapshot class, the container is not decompressed as a whole. It is
+ * mapped into memory and a section is only decompressed when it is requested.
+ * This makes it possible to extract a single component, e.g., the CPU or the
+ * memory, or the thumbnail from a snapshot file without deserializing the
+ * rest of the emulator state.
+ *
+ * If the memory section is stored uncompressed, restoring a mapped snapshot
+ * doesn't copy the Ram contents. The Ram blocks are mapped copy-on-write from
+ * the file instead. As a result, the restore time is almost independent of
+ * the Ram size. Note that pages which have not been modified yet are still
+ * backed by the file. Hence, the file must not be modified while the emulator
+ * is running. Overwriting it in place crashes the process or changes the
+ * emulated Ram silently. Snapshot files are therefore always replaced by
+ * writing a temporary file which is renamed afterwards. The mapped pages stay
+ * attached to the old file contents in this case.
+ */
+class MappedSnapshot {
+
+    // The container contents
+    const u8 *base = nullptr;
+    isize length = 0;
+
+    // Indicates if the container has been mapped into memory by this object
+    bool mapped = false;
+
+    // File descriptor of the mapped file (-1 if a buffer is accessed)
+    int fd = -1;
+
+    // The container header
+    SnapshotFileHeader header;
+
+    // The section directory
+    std::vector<SnapshotSection> sections;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    /* Reads the header of a snapshot file. This is the fastest way to obtain
+     * the metadata of a snapshot, because no other part of the file is read.
+     */
+    static SnapshotFileHeader peek(const string &path) throws;
+
+    // Maps a snapshot file into memory
+    MappedSnapshot(const string &path) throws;
+
+    // Accesses a snapshot container in a buffer provided by the caller
+    MappedSnapshot(const u8 *buffer, isize length) throws;
+
+    MappedSnapshot(const MappedSnapshot &) = delete;
+    MappedSnapshot &operator=(const MappedSnapshot &) = delete;
+    ~MappedSnapshot();
+
+private:
+
+    // Parses the header and the section directory
+    void parse() throws;
+
+
+    //
+    // Accessing
+    //
+
+public:
+
+    const SnapshotFileHeader &getHeader() const { return header; }
+    const std::vector<SnapshotSection> &getSections() const { return sections; }
+
+    // Returns the number of a section with a given name or -1
+    isize findSection(const string &name) const;
+
+    /* Decompresses a section. The target buffer must be large enough to hold
+     * the uncompressed section as specified by its rawSize.
+     */
+    void readSection(isize nr, u8 *buffer) const throws;
+
+    // Decompresses the thumbnail
+    void readThumbnail(Thumbnail &thumbnail) const throws;
+
+    /* Restores the state of a single top-level component. The section is
+     * identified by the description of the component.
+     */
+    void loadComponent(HardwareComponent &component) const throws;
+
+    /* Restores the complete emulator state. This function is called by
+     * Amiga::loadFromSnapshotUnsafe() which should be used instead.
+     */
+    void restore(Amiga &amiga) const throws;
+};
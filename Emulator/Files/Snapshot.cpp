@@ -11,6 +11,7 @@
 #include "Snapshot.h"
 #include "Amiga.h"
 #include "IO.h"
+#include <memory>
 
 Thumbnail *
 Thumbnail::makeWithAmiga(Amiga *amiga, isize dx, isize dy)
@@ -24,7 +25,7 @@ Thumbnail::makeWithAmiga(Amiga *amiga, isize dx, isize dy)
 void
 Thumbnail::take(Amiga *amiga, isize dx, isize dy)
 {
-    u32 *source = (u32 *)amiga->denise.pixelEngine.getStableBuffer().data;
+    u32 *source = (u32 *)amiga->denise.pixelEngine.getCompletedBuffer().data;
     u32 *target = screen;
     
     isize xStart = 4 * HBLANK_MAX + 1, xEnd = HPIXELS + 4 * HBLANK_MIN;
@@ -57,10 +58,20 @@ Snapshot::isCompatibleStream(std::istream &stream)
 {
     const u8 magicBytes[] = { 'V', 'A', 'S', 'N', 'A', 'P' };
     
+    if (isCompressedStream(stream)) return true;
     if (util::streamLength(stream) < 0x15) return false;
     return util::matchingStreamHeader(stream, magicBytes, sizeof(magicBytes));
 }
 
+bool
+Snapshot::isCompressedStream(std::istream &stream)
+{
+    const u8 magicBytes[] = { 'V', 'A', 'S', 'N', 'P', 'Z' };
+
+    if (util::streamLength(stream) < SnapshotFileHeader::size) return false;
+    return util::matchingStreamHeader(stream, magicBytes, sizeof(magicBytes));
+}
+
 Snapshot::Snapshot()
 {
 }
@@ -89,6 +100,11 @@ Snapshot::makeWithAmiga(Amiga *amiga)
     snapshot->takeScreenshot(*amiga);
     amiga->save(snapshot->getData());
 
+    // Remember the component boundaries
+    for (HardwareComponent *c : amiga->subComponents) {
+        snapshot->sections.push_back(SnapshotSection { c->getDescription(), 0, 0, c->size(), false });
+    }
+
     return snapshot;
 }
 
@@ -97,3 +113,357 @@ Snapshot::takeScreenshot(Amiga &amiga)
 {
     ((SnapshotHeader *)data)->screenshot.take(&amiga);
 }
+
+void
+SnapshotFileHeader::read(const u8 *buffer)
+{
+    for (isize i = 0; i < 6; i++) magic[i] = (char)util::read8(buffer);
+    major = util::read8(buffer);
+    minor = util::read8(buffer);
+    subminor = util::read8(buffer);
+    format = util::read8(buffer);
+    width = util::read16(buffer);
+    height = util::read16(buffer);
+    timestamp = util::read64(buffer);
+    dataSize = util::read64(buffer);
+}
+
+void
+SnapshotFileHeader::write(u8 *buffer) const
+{
+    u8 *ptr = buffer;
+
+    for (isize i = 0; i < 6; i++) util::write8(ptr, (u8)magic[i]);
+    util::write8(ptr, major);
+    util::write8(ptr, minor);
+    util::write8(ptr, subminor);
+    util::write8(ptr, format);
+    util::write16(ptr, width);
+    util::write16(ptr, height);
+    util::write64(ptr, timestamp);
+    util::write64(ptr, dataSize);
+
+    assert(ptr - buffer == size);
+}
+
+void
+SnapshotFileHeader::verify(isize fileSize) const
+{
+    if (memcmp(magic, "VASNPZ", 6) != 0) throw VAError(ERROR_SNP_TOO_OLD);
+    if (format < SNP_FORMAT) throw VAError(ERROR_SNP_TOO_OLD);
+    if (format > SNP_FORMAT) throw VAError(ERROR_SNP_TOO_NEW);
+
+    // Reject headers that would make us write beyond the thumbnail buffer
+    if (width * height > (HPIXELS / 2) * VPIXELS) throw VAError(ERROR_SNP_CORRUPTED);
+
+    // The compressor doesn't achieve ratios beyond 255:1
+    if (dataSize > (u64)fileSize * 256) throw VAError(ERROR_SNP_CORRUPTED);
+}
+
+void
+SnapshotSection::read(const u8 *buffer)
+{
+    char chars[33] = { };
+    for (isize i = 0; i < 32; i++) chars[i] = (char)util::read8(buffer);
+
+    name = string(chars);
+    offset = (isize)util::read64(buffer);
+    packedSize = (isize)util::read64(buffer);
+    rawSize = (isize)util::read64(buffer);
+    raw = util::read64(buffer) & 1;
+}
+
+void
+SnapshotSection::write(u8 *buffer) const
+{
+    u8 *ptr = buffer;
+
+    for (isize i = 0; i < 32; i++) {
+        util::write8(ptr, i < (isize)name.size() ? (u8)name[i] : 0);
+    }
+    util::write64(ptr, (u64)offset);
+    util::write64(ptr, (u64)packedSize);
+    util::write64(ptr, (u64)rawSize);
+    util::write64(ptr, raw ? 1 : 0);
+
+    assert(ptr - buffer == entrySize);
+}
+
+std::vector<SnapshotSection>
+SnapshotSection::parseDirectory(const u8 *buffer, isize length, isize position,
+                                const SnapshotFileHeader &header)
+{
+    std::vector<SnapshotSection> result;
+
+    if (length < 4) throw VAError(ERROR_SNP_CORRUPTED);
+    isize count = (isize)util::read32(buffer);
+    if (count < 1 || count > (length - 4) / entrySize) throw VAError(ERROR_SNP_CORRUPTED);
+
+    isize total = 0;
+    for (isize i = 0; i < count; i++, buffer += entrySize) {
+
+        SnapshotSection section;
+        section.read(buffer);
+
+        // Reject sections that reach beyond the data area
+        if (section.offset < SnapshotFileHeader::size ||
+            section.packedSize < 0 || section.rawSize < 0 ||
+            section.offset + section.packedSize > position ||
+            (section.raw && section.packedSize != section.rawSize)) {
+            throw VAError(ERROR_SNP_CORRUPTED);
+        }
+
+        result.push_back(section);
+        if (i > 0) total += section.rawSize;
+    }
+
+    // The component sections must add up to the emulator state
+    if (total != (isize)header.dataSize ||
+        result[0].rawSize != 4 * header.width * header.height) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+
+    return result;
+}
+
+/* Helper class for writing a snapshot container. The header is written on
+ * construction, the directory and the trailer are written by finish().
+ */
+class ContainerWriter {
+
+    std::ostream &stream;
+    util::LZ4Writer writer;
+    std::vector<SnapshotSection> directory;
+
+    // Number of bytes written outside of the compressor
+    isize uncompressed = SnapshotFileHeader::size;
+
+public:
+
+    ContainerWriter(std::ostream &stream, const SnapshotFileHeader &header) :
+    stream(stream), writer(stream)
+    {
+        u8 buffer[SnapshotFileHeader::size];
+        header.write(buffer);
+        stream.write((const char *)buffer, sizeof(buffer));
+    }
+
+    isize position() const { return uncompressed + writer.bytesWritten(); }
+
+    void writeSection(const string &name, const u8 *buffer, isize count)
+    {
+        isize offset = position();
+
+        writer.write(buffer, count);
+        writer.flush();
+
+        directory.push_back(SnapshotSection {
+            name, offset, position() - offset, count, false });
+    }
+
+    void writeRawSection(const string &name, const u8 *buffer, isize count)
+    {
+        // Pad the file to let the section end at an aligned position
+        isize padding = (SNP_MAPPING_ALIGN - (position() + count) % SNP_MAPPING_ALIGN) % SNP_MAPPING_ALIGN;
+        std::vector<u8> zeroes(padding);
+        stream.write((const char *)zeroes.data(), padding);
+        uncompressed += padding;
+
+        directory.push_back(SnapshotSection {
+            name, position(), count, count, true });
+
+        stream.write((const char *)buffer, count);
+        uncompressed += count;
+    }
+
+    void writeThumbnail(const Thumbnail &thumbnail)
+    {
+        // Only the visible part of the texture is stored
+        writeSection("Thumbnail", (const u8 *)thumbnail.screen,
+                     4 * thumbnail.width * thumbnail.height);
+    }
+
+    isize finish()
+    {
+        isize start = position();
+        std::vector<u8> buffer(4 + directory.size() * SnapshotSection::entrySize + 8);
+        u8 *ptr = buffer.data();
+
+        util::write32(ptr, (u32)directory.size());
+        for (auto &section : directory) {
+            section.write(ptr);
+            ptr += SnapshotSection::entrySize;
+        }
+        util::write64(ptr, (u64)start);
+
+        stream.write((const char *)buffer.data(), buffer.size());
+        if (!stream) throw VAError(ERROR_FILE_CANT_WRITE);
+
+        return start + (isize)buffer.size();
+    }
+};
+
+isize
+Snapshot::readFromStream(std::istream &stream)
+{
+    // Snapshots from older releases are stored uncompressed
+    if (!isCompressedStream(stream)) return AmigaFile::readFromStream(stream);
+
+    auto fileHeader = readFileHeader(stream);
+    auto directory = readDirectory(stream, fileHeader);
+
+    // Allocate memory for the uncompressed snapshot
+    assert(data == nullptr);
+    size = isizeof(SnapshotHeader) + (isize)fileHeader.dataSize;
+    data = new u8[size]();
+
+    // Set up the header
+    SnapshotHeader *header = (SnapshotHeader *)data;
+    memcpy(header->magic, "VASNAP", 6);
+    header->major = fileHeader.major;
+    header->minor = fileHeader.minor;
+    header->subminor = fileHeader.subminor;
+    header->screenshot.width = fileHeader.width;
+    header->screenshot.height = fileHeader.height;
+    header->screenshot.timestamp = (time_t)fileHeader.timestamp;
+
+    // Decompress the thumbnail and the emulator state in place
+    util::LZ4Reader reader(stream);
+    u8 *ptr = getData();
+
+    for (isize i = 0; i < (isize)directory.size(); i++) {
+
+        auto &section = directory[i];
+        u8 *dst = i ? ptr : (u8 *)header->screenshot.screen;
+
+        stream.clear();
+        stream.seekg(section.offset, std::ios::beg);
+
+        bool success = section.raw ?
+        (bool)stream.read((char *)dst, section.rawSize) :
+        reader.read(dst, section.rawSize);
+
+        if (!success) throw VAError(ERROR_SNP_CORRUPTED);
+
+        if (i) {
+            sections.push_back(section);
+            ptr += section.rawSize;
+        }
+    }
+
+    return size;
+}
+
+isize
+Snapshot::writeToStream(std::ostream &stream)
+{
+    const SnapshotHeader *header = getHeader();
+    isize dataSize = size - isizeof(SnapshotHeader);
+
+    ContainerWriter writer(stream, SnapshotFileHeader {
+        { 'V', 'A', 'S', 'N', 'P', 'Z' },
+        header->major, header->minor, header->subminor, SNP_FORMAT,
+        header->screenshot.width, header->screenshot.height,
+        (u64)header->screenshot.timestamp,
+        (u64)dataSize
+    });
+
+    writer.writeThumbnail(header->screenshot);
+
+    if (sections.empty()) {
+
+        // The component boundaries are unknown
+        writer.writeSection("Amiga", getData(), dataSize);
+
+    } else {
+
+        u8 *ptr = getData();
+        for (auto &section : sections) {
+
+            if (section.raw) {
+                writer.writeRawSection(section.name, ptr, section.rawSize);
+            } else {
+                writer.writeSection(section.name, ptr, section.rawSize);
+            }
+            ptr += section.rawSize;
+        }
+        assert(ptr == getData() + dataSize);
+    }
+
+    return writer.finish();
+}
+
+isize
+Snapshot::writeAmigaToStream(Amiga &amiga, std::ostream &stream, bool mappable)
+{
+    auto thumbnail = std::make_unique<Thumbnail>();
+    thumbnail->take(&amiga);
+
+    ContainerWriter writer(stream, SnapshotFileHeader {
+        { 'V', 'A', 'S', 'N', 'P', 'Z' },
+        V_MAJOR, V_MINOR, V_SUBMINOR, SNP_FORMAT,
+        thumbnail->width, thumbnail->height,
+        (u64)thumbnail->timestamp,
+        (u64)amiga.size()
+    });
+
+    writer.writeThumbnail(*thumbnail);
+
+    /* The Amiga class has no state of its own. Hence, the emulator state is
+     * the concatenation of the states of all top-level components.
+     */
+    std::vector<u8> buffer;
+
+    for (HardwareComponent *c : amiga.subComponents) {
+
+        buffer.resize(c->size());
+        isize count = c->save(buffer.data());
+
+        if (mappable && c == &amiga.mem) {
+            writer.writeRawSection(c->getDescription(), buffer.data(), count);
+        } else {
+            writer.writeSection(c->getDescription(), buffer.data(), count);
+        }
+    }
+
+    return writer.finish();
+}
+
+SnapshotFileHeader
+Snapshot::readFileHeader(std::istream &stream)
+{
+    SnapshotFileHeader header;
+    u8 buffer[SnapshotFileHeader::size];
+
+    isize length = util::streamLength(stream);
+    stream.seekg(0, std::ios::beg);
+    if (!stream.read((char *)buffer, sizeof(buffer))) throw VAError(ERROR_SNP_CORRUPTED);
+
+    header.read(buffer);
+    header.verify(length);
+
+    return header;
+}
+
+std::vector<SnapshotSection>
+Snapshot::readDirectory(std::istream &stream, const SnapshotFileHeader &header)
+{
+    isize length = util::streamLength(stream);
+    u8 trailer[8];
+
+    // Locate the directory with the help of the trailer
+    stream.seekg(length - 8, std::ios::beg);
+    if (!stream.read((char *)trailer, sizeof(trailer))) throw VAError(ERROR_SNP_CORRUPTED);
+
+    const u8 *ptr = trailer;
+    isize position = (isize)util::read64(ptr);
+    if (position < SnapshotFileHeader::size || position > length - 8) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+
+    std::vector<u8> buffer(length - 8 - position);
+    stream.seekg(position, std::ios::beg);
+    if (!stream.read((char *)buffer.data(), buffer.size())) throw VAError(ERROR_SNP_CORRUPTED);
+
+    return SnapshotSection::parseDirectory(buffer.data(), (isize)buffer.size(), position, header);
+}
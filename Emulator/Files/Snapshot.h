@@ -11,6 +11,7 @@
 
 #include "AmigaFile.h"
 #include "Constants.h"
+#include "Compression.h"
 
 class Amiga;
 
@@ -46,8 +47,104 @@ struct SnapshotHeader {
     Thumbnail screenshot;
 };
 
+/* On disk, snapshots are stored in a compressed container:
+ *
+ *     Header     SnapshotFileHeader::size bytes
+ *     Sections   The thumbnail, followed by one section per top-level component
+ *     Directory  Number of sections, followed by one entry per section
+ *     Trailer    Position of the directory (8 bytes)
+ *
+ * Sections are usually compressed block by block with a util::LZ4Writer. Each
+ * section starts with a new block. Hence, a single section can be decompressed
+ * without touching any other part of the file. The component sections appear
+ * in the order of Amiga::subComponents. Only the visible part of the thumbnail
+ * is stored. All numbers are stored in big-endian byte order, the thumbnail
+ * pixels are stored in memory order.
+ *
+ * Optionally, the memory section is stored uncompressed. Such a section is
+ * padded to end at a multiple of SNP_MAPPING_ALIGN. Because the memory
+ * contents make up the end of the section and all Ram sizes are multiples of
+ * this value, each Ram block starts at a page boundary of the host. This makes
+ * it possible to map the Ram blocks into memory directly (see MappedSnapshot).
+ *
+ * Snapshot files written by older releases are stored uncompressed. They start
+ * with the in-memory SnapshotHeader and can still be read.
+ */
+#define SNP_FORMAT 3
+#define SNP_MAPPING_ALIGN KB(16)
+
+struct SnapshotFileHeader {
+
+    // Magic bytes ('V','A','S','N','P','Z')
+    char magic[6];
+
+    // Version number (V major.minor.subminor)
+    u8 major;
+    u8 minor;
+    u8 subminor;
+
+    // Container format revision
+    u8 format;
+
+    // Thumbnail size
+    u16 width;
+    u16 height;
+
+    // Date and time of screenshot creation
+    u64 timestamp;
+
+    // Size of the uncompressed emulator state in bytes
+    u64 dataSize;
+
+    // Size of the header in the container
+    static constexpr isize size = 30;
+
+    // Converts the header from or to the container representation
+    void read(const u8 *buffer);
+    void write(u8 *buffer) const;
+
+    // Checks the header of a container with the specified size
+    void verify(isize fileSize) const throws;
+};
+
+struct SnapshotSection {
+
+    // Section name (the description of the serialized component)
+    string name;
+
+    // Position and size of the section data in the container
+    isize offset;
+    isize packedSize;
+
+    // Size of the uncompressed data
+    isize rawSize;
+
+    // Indicates if the data is stored uncompressed
+    bool raw;
+
+    // Size of a directory entry in the container
+    static constexpr isize entrySize = 32 + 4 * 8;
+
+    // Converts a directory entry from or to the container representation
+    void read(const u8 *buffer);
+    void write(u8 *buffer) const;
+
+    /* Parses the section directory of a container. The directory has been
+     * read from the specified position of the container.
+     */
+    static std::vector<SnapshotSection> parseDirectory(const u8 *buffer, isize length,
+                                                       isize position,
+                                                       const SnapshotFileHeader &header) throws;
+};
+
 class Snapshot : public AmigaFile {
- 
+
+    /* Names and sizes of the components the emulator state is composed of.
+     * The list is empty if the snapshot has been read from a file written by
+     * an older release.
+     */
+    std::vector<SnapshotSection> sections;
+
     //
     // Class methods
     //
@@ -57,6 +154,9 @@ public:
     static bool isCompatiblePath(const string &path);
     static bool isCompatibleStream(std::istream &stream);
 
+    // Checks if a stream contains a compressed snapshot container
+    static bool isCompressedStream(std::istream &stream);
+
             
     //
     // Initializing
@@ -77,6 +177,35 @@ public:
     //
     
     FileType type() const override { return FILETYPE_SNAPSHOT; }
+    using AmigaFile::writeToStream;
+    isize readFromStream(std::istream &stream) throws override;
+    isize writeToStream(std::ostream &stream) throws override;
+
+
+    //
+    // Streaming
+    //
+
+public:
+
+    /* Writes the current state of an Amiga as a snapshot container. In
+     * contrast to makeWithAmiga(), the emulator state is never held in memory
+     * as a whole. The components are serialized one after another and passed
+     * through the compressor right away. If mappable is true, the memory
+     * section is stored uncompressed to enable mapping the Ram blocks into
+     * memory when the snapshot is restored.
+     */
+    static isize writeAmigaToStream(Amiga &amiga, std::ostream &stream,
+                                    bool mappable = false) throws;
+
+private:
+
+    // Reads the header of a snapshot container
+    static SnapshotFileHeader readFileHeader(std::istream &stream) throws;
+
+    // Reads the section directory of a snapshot container
+    static std::vector<SnapshotSection> readDirectory(std::istream &stream,
+                                                      const SnapshotFileHeader &header) throws;
     
     
     //
@@ -93,6 +222,9 @@ public:
     
     // Returns pointer to core data
     u8 *getData() { return data + sizeof(SnapshotHeader); }
+
+    // Returns the sections of the core data
+    const std::vector<SnapshotSection> &getSections() const { return sections; }
     
     // Takes a screenshot
     void takeScreenshot(Amiga &amiga);
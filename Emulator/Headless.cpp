@@ -0,0 +1,1276 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Headless.h"
+#include "Checksum.h"
+#include "DeltaSnapshot.h"
+#include "Chrono.h"
+#include "IO.h"
+#include "Parser.h"
+#include "MappedSnapshot.h"
+#include "Snapshot.h"
+#include "SSEUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+int
+main(int argc, char *argv[])
+{
+    return Headless().main(argc, argv);
+}
+
+static void
+process(const void *listener, long type, long data)
+{
+    auto headless = (const bool *)listener;
+
+    if (*headless) {
+        printf("Message: %s (%ld)\n", MsgTypeEnum::key((MsgType)type), data);
+    }
+}
+
+int
+Headless::main(int argc, char *argv[])
+{
+    try {
+
+        if (!parseArguments(argc, argv)) return 1;
+
+        if (peekPath != "") {
+
+            runPeek();
+
+        } else if (kernelCheck) {
+
+            if (!runKernelCheck()) return 1;
+
+        } else if (instances > 1) {
+
+            runFleet();
+
+        } else {
+
+            Amiga amiga;
+            amiga.queue.setListener(&verbose, process);
+
+            configure(amiga);
+            if (deltaInterval) {
+                runDeltaCheck(amiga);
+            } else if (rewindSeconds) {
+                runRewindCheck(amiga);
+            } else if (runAheadFrames) {
+                runRunAheadCheck(amiga);
+            } else if (forks) {
+                runForkCheck(amiga);
+            } else if (recordPath != "") {
+                runRecordCheck(amiga);
+            } else if (hashCheck) {
+                runHashCheck(amiga);
+            } else {
+                runBenchmark(amiga);
+            }
+
+            release(amiga);
+        }
+
+    } catch (VAError &err) {
+
+        fprintf(stderr, "Error: %s\n", err.what());
+        return 1;
+
+    } catch (ConfigError &err) {
+
+        fprintf(stderr, "Configuration error: %s\n", err.what());
+        return 1;
+
+    } catch (util::ParseError &err) {
+
+        fprintf(stderr, "Invalid argument: %s\n", err.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+bool
+Headless::parseArguments(int argc, char *argv[])
+{
+    auto number = [&](isize i) { string token = argv[i]; return util::parseNum(token); };
+
+    for (isize i = 1; i < argc; i++) {
+
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return false;
+        }
+        if (arg == "-v" || arg == "--verbose") {
+            verbose = true;
+            continue;
+        }
+        if (arg == "--map") {
+            mapSnapshot = true;
+            continue;
+        }
+        if (arg == "--mappable") {
+            mappable = true;
+            continue;
+        }
+        if (arg == "--kernels") {
+            kernelCheck = true;
+            continue;
+        }
+        if (arg == "--consumer") {
+            consumer = true;
+            continue;
+        }
+        if (arg == "--hash") {
+            hashCheck = true;
+            continue;
+        }
+        if (arg == "--profile") {
+            profile = true;
+            continue;
+        }
+        if (arg.size() > 1 && arg[0] == '-' && !hasValue) {
+            usage(argv[0]);
+            return false;
+        }
+
+        if (arg == "-r" || arg == "--rom") {
+            romPath = argv[++i];
+        } else if (arg == "-e" || arg == "--ext") {
+            extPath = argv[++i];
+        } else if (arg == "-s" || arg == "--snapshot") {
+            snapshotPath = argv[++i];
+        } else if (arg == "-o" || arg == "--output") {
+            outputPath = argv[++i];
+        } else if (arg == "--peek") {
+            peekPath = argv[++i];
+        } else if (arg == "-x" || arg == "--script") {
+            scriptPath = argv[++i];
+        } else if (arg == "--record") {
+            recordPath = argv[++i];
+        } else if (arg == "--replay") {
+            replayPath = argv[++i];
+        } else if (arg == "--trace") {
+            tracePath = argv[++i];
+        } else if (arg == "-f" || arg == "--frames") {
+            frames = number(++i);
+        } else if (arg == "-n" || arg == "--instances") {
+            instances = number(++i);
+        } else if (arg == "--delta") {
+            deltaInterval = number(++i);
+        } else if (arg == "--rewind") {
+            rewindSeconds = number(++i);
+        } else if (arg == "--runahead") {
+            runAheadFrames = number(++i);
+        } else if (arg == "--bootcache") {
+            bootCachePath = argv[++i];
+        } else if (arg == "--bootframes") {
+            bootFrames = number(++i);
+        } else if (arg == "--fork") {
+            forks = number(++i);
+        } else if (arg == "--chip") {
+            chipRam = number(++i);
+        } else if (arg == "--slow") {
+            slowRam = number(++i);
+        } else if (arg == "--fast") {
+            fastRam = number(++i);
+        } else if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'd' &&
+                   arg[2] >= '0' && arg[2] <= '3') {
+            diskPath[arg[2] - '0'] = argv[++i];
+        } else if (arg[0] != '-') {
+
+            // Guess the type of a file provided without an option
+            if (AmigaFile::type(arg) == FILETYPE_SNAPSHOT) {
+                snapshotPath = arg;
+            } else {
+                diskPath[0] = arg;
+            }
+
+        } else {
+
+            usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (romPath == "" && snapshotPath == "" && peekPath == "" && !kernelCheck) {
+
+        fprintf(stderr, "Error: A Kickstart Rom or a snapshot is required\n\n");
+        usage(argv[0]);
+        return false;
+    }
+
+    if (frames <= 0) {
+
+        fprintf(stderr, "Error: The number of frames must be positive\n");
+        return false;
+    }
+
+    if (deltaInterval < 0) {
+
+        fprintf(stderr, "Error: The delta interval must not be negative\n");
+        return false;
+    }
+
+    if (rewindSeconds < 0) {
+
+        fprintf(stderr, "Error: The rewind period must not be negative\n");
+        return false;
+    }
+
+    if (runAheadFrames < 0) {
+
+        fprintf(stderr, "Error: The number of run-ahead frames must not be negative\n");
+        return false;
+    }
+
+    if (bootFrames <= 0) {
+
+        fprintf(stderr, "Error: The number of boot frames must be positive\n");
+        return false;
+    }
+
+    if (forks < 0) {
+
+        fprintf(stderr, "Error: The number of forked instances must not be negative\n");
+        return false;
+    }
+
+    if (instances <= 0) {
+
+        fprintf(stderr, "Error: The number of instances must be positive\n");
+        return false;
+    }
+
+    if (recordPath != "" && replayPath != "") {
+
+        fprintf(stderr, "Error: Input can't be recorded and replayed at the same time\n");
+        return false;
+    }
+
+    return true;
+}
+
+void
+Headless::usage(const char *name)
+{
+    printf("Usage: %s [options] [disk or snapshot]\n", name);
+    printf("\n");
+    printf("  -r, --rom <file>       Kickstart Rom\n");
+    printf("  -e, --ext <file>       Extension Rom\n");
+    printf("  -d<n> <file>           Disk to insert into df<n> (n = 0 ... 3)\n");
+    printf("  -s, --snapshot <file>  Snapshot to restore\n");
+    printf("  -o, --output <file>    Snapshot to write after the run\n");
+    printf("      --map              Restore the snapshot by mapping it into memory\n");
+    printf("      --mappable         Write the snapshot with uncompressed memory\n");
+    printf("  -x, --script <file>    RetroShell script to run before power-up\n");
+    printf("  -f, --frames <n>       Number of frames to emulate (default: 500)\n");
+    printf("  -n, --instances <n>    Number of instances to run in parallel\n");
+    printf("      --chip <kb>        Chip Ram in KB (default: 512)\n");
+    printf("      --slow <kb>        Slow Ram in KB (default: 512)\n");
+    printf("      --fast <kb>        Fast Ram in KB (default: 0)\n");
+    printf("      --delta <n>        Verify delta snapshots taken every n frames\n");
+    printf("      --rewind <s>       Verify travelling back in time by s seconds\n");
+    printf("      --runahead <n>     Run n frames ahead and verify the result\n");
+    printf("      --fork <n>         Fork off n instances and verify their state\n");
+    printf("      --bootcache <dir>  Cache the state after booting in a directory\n");
+    printf("      --bootframes <n>   Number of frames to boot (default: 250)\n");
+    printf("      --record <file>    Record synthetic input and verify the replay\n");
+    printf("      --replay <file>    Replay recorded input during the run\n");
+    printf("      --hash             Hash the state in each frame and verify the hash\n");
+    printf("      --profile          Print the host time spent in each subsystem\n");
+    printf("      --trace <file>     Write all serviced events into a Chrome trace file\n");
+    printf("      --consumer         Read all frames on a separate thread and check them\n");
+    printf("      --peek <file>      Print the metadata and sections of a snapshot\n");
+    printf("      --kernels          Verify and benchmark the SIMD kernels\n");
+    printf("  -v, --verbose          Print emulator messages\n");
+    printf("  -h, --help             Print this message\n");
+}
+
+void
+Headless::configure(Amiga &amiga)
+{
+    // Configure the memory
+    amiga.configure(OPT_AGNUS_REVISION, AGNUS_ECS_1MB);
+    amiga.configure(OPT_CHIP_RAM, chipRam);
+    amiga.configure(OPT_SLOW_RAM, slowRam);
+    amiga.configure(OPT_FAST_RAM, fastRam);
+
+    // Remove the real-time clock to make runs independent of the host time
+    amiga.configure(OPT_RTC_MODEL, RTC_NONE);
+
+    // Connect the internal drive
+    amiga.configure(OPT_DRIVE_CONNECT, 0, true);
+
+    // Install Roms
+    if (romPath != "") amiga.mem.loadRomFromFile(romPath.c_str());
+    if (extPath != "") amiga.mem.loadExtFromFile(extPath.c_str());
+
+    // Run the configuration script
+    if (scriptPath != "") {
+
+        std::ifstream stream(scriptPath);
+        if (!stream.is_open()) throw ConfigFileReadError(scriptPath);
+        amiga.retroShell.exec(stream);
+    }
+
+    // Configure the boot cache
+    if (bootCachePath != "") {
+
+        amiga.bootCache.setDirectory(bootCachePath);
+        amiga.configure(OPT_BOOT_CACHE, bootFrames);
+    }
+
+    auto insertDisks = [&]() {
+
+        for (isize i = 0; i < 4; i++) {
+
+            if (diskPath[i] == "") continue;
+            amiga.configure(OPT_DRIVE_CONNECT, i, true);
+            amiga.paula.diskController.insertDisk(diskPath[i], i);
+        }
+    };
+
+    // Restore the snapshot
+    if (snapshotPath != "") {
+
+        /* The snapshot contains the Roms. Hence, we restore it once before
+         * powering on to pass the readiness check and once afterwards, because
+         * powering on performs a hard reset.
+         */
+        if (mapSnapshot) {
+
+            util::Clock clock;
+            MappedSnapshot snapshot(snapshotPath);
+            amiga.loadFromSnapshotUnsafe(snapshot);
+            amiga.powerOn();
+            clock.restart();
+            amiga.loadFromSnapshotUnsafe(snapshot);
+            restoreTime = clock.restart().asMicroseconds();
+
+        } else {
+
+            util::Clock clock;
+            Snapshot *snapshot = AmigaFile::make <Snapshot> (snapshotPath.c_str());
+            amiga.loadFromSnapshotUnsafe(snapshot);
+            amiga.powerOn();
+            clock.restart();
+            amiga.loadFromSnapshotUnsafe(snapshot);
+            restoreTime = clock.restart().asMicroseconds();
+            delete snapshot;
+        }
+
+        // Replace the disks from the snapshot
+        insertDisks();
+
+    } else {
+
+        ErrorCode ec;
+        if (!amiga.isReady(&ec)) throw VAError(ec);
+
+        // Insert the disks first to make them part of the boot cache key
+        insertDisks();
+
+        util::Clock clock;
+        amiga.powerOn();
+        powerOnTime = clock.getElapsedTime().asMicroseconds();
+    }
+
+    // Replay recorded input
+    if (replayPath != "") {
+
+        amiga.inputRecorder.loadFromFile(replayPath);
+        amiga.inputRecorder.startReplay();
+    }
+}
+
+void
+Headless::runPeek()
+{
+    util::Clock clock;
+    auto header = MappedSnapshot::peek(peekPath);
+    double peekTime = clock.restart().asMicroseconds();
+
+    MappedSnapshot map(peekPath);
+    double mapTime = clock.restart().asMicroseconds();
+
+    char date[64];
+    time_t timestamp = (time_t)header.timestamp;
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&timestamp));
+
+    printf("         Version : %d.%d.%d (container format %d)\n",
+           header.major, header.minor, header.subminor, header.format);
+    printf("         Created : %s\n", date);
+    printf("       Thumbnail : %d x %d\n", header.width, header.height);
+    printf("      State size : %llu bytes\n", (unsigned long long)header.dataSize);
+    printf("       Peek time : %.0f usec (%.0f usec to map the file)\n", peekTime, mapTime);
+
+    for (auto &section : map.getSections()) {
+
+        std::vector<u8> buffer(section.rawSize);
+        clock.restart();
+        map.readSection(map.findSection(section.name), buffer.data());
+        double time = clock.restart().asMicroseconds();
+
+        printf("%16s : %zd bytes (%zd compressed, %.0f usec)\n",
+               section.name.c_str(), section.rawSize, section.packedSize, time);
+    }
+}
+
+bool
+Headless::runKernelCheck()
+{
+    bool success = true;
+
+    // Use a fixed seed to generate the same matrices in each run
+    u32 seed = 0x2f6b1e35;
+    auto random = [&]() {
+        seed = seed * 1103515245 + 12345;
+        return (u16)(seed >> 8);
+    };
+
+    const isize count = 4096;
+    std::vector<u16> matrices(8 * count);
+    for (auto &row : matrices) row = random();
+
+    // Create color tables and valid input data for the pixel engine kernels
+    std::vector<u32> table(4096);
+    for (auto &entry : table) entry = random() << 16 | random();
+    std::vector<u8> indices8(16 * count), bpl(16 * count), index(16 * count);
+    std::vector<u16> indices16(16 * count);
+    u16 colreg[32];
+    for (auto &i : indices8) i = random() % 73;
+    for (auto &i : indices16) i = random() & 0xFFF;
+    for (auto &c : colreg) c = random() & 0xFFF;
+    for (isize i = 0; i < 16 * count; i++) {
+
+        bpl[i] = random() & 0x3F;
+        index[i] = (bpl[i] & 0x30) ? (random() & 0x3F) : (bpl[i] & 0xF);
+    }
+
+    for (isize k = 0; k < (isize)util::SIMD::Count; k++) {
+
+        auto simd = (util::SIMD)k;
+        auto name = util::simdName(simd);
+
+        if (!util::simdIsSupported(simd)) {
+
+            printf("%16s : Not supported by this CPU\n", name);
+            continue;
+        }
+
+        auto &kernels = util::kernels(simd);
+        auto transpose = kernels.transpose;
+        alignas(16) u16 rows[8];
+        alignas(16) u8 expected[16];
+        alignas(16) u8 result[16];
+        i64 errors = 0;
+
+        /* Each column value depends on a single bit in each row. Hence, we run
+         * through all values of one row while the others are kept fixed.
+         */
+        for (isize r = 0; r < 8; r++) {
+            for (u16 background : { (u16)0x0000, (u16)0xFFFF }) {
+                for (isize value = 0; value < 0x10000; value++) {
+
+                    for (isize i = 0; i < 8; i++) rows[i] = background;
+                    rows[r] = (u16)value;
+
+                    util::transposeScalar(rows, expected);
+                    transpose(rows, result);
+                    if (memcmp(expected, result, 16)) errors++;
+                }
+            }
+        }
+        for (isize m = 0; m < count; m++) {
+
+            memcpy(rows, &matrices[8 * m], sizeof(rows));
+            util::transposeScalar(rows, expected);
+            transpose(rows, result);
+            if (memcmp(expected, result, 16)) errors++;
+        }
+
+        // Convert all matrices en bloc and write the result to an odd address
+        auto transposeBlock = kernels.transposeBlock;
+        std::vector<u8> expectedBlock(32 * count);
+        std::vector<u8> resultBlock(32 * count + 1);
+
+        for (bool doubled : { false, true }) {
+            for (u8 mask : { (u8)0xFF, (u8)0x3F, (u8)0x15, (u8)0x2A }) {
+
+                util::transposeBlockScalar(matrices.data(), count, mask, doubled,
+                                           expectedBlock.data());
+                transposeBlock(matrices.data(), count, mask, doubled,
+                               resultBlock.data() + 1);
+                if (memcmp(expectedBlock.data(), resultBlock.data() + 1,
+                           (doubled ? 32 : 16) * count)) errors++;
+            }
+        }
+
+        // Run the pixel engine kernels with all start offsets of a vector
+        std::vector<u32> expectedRgba(16 * count), resultRgba(16 * count);
+        std::vector<u16> expectedHam(16 * count), resultHam(16 * count);
+
+        for (isize offset = 0; offset < 32; offset++) {
+
+            isize n = 16 * count - offset;
+
+            util::lookup8Scalar(table.data(), 73, indices8.data() + offset,
+                                expectedRgba.data(), n);
+            kernels.lookup8(table.data(), 73, indices8.data() + offset, resultRgba.data(), n);
+            if (memcmp(expectedRgba.data(), resultRgba.data(), 4 * n)) errors++;
+
+            util::lookup16Scalar(table.data(), indices16.data() + offset,
+                                 expectedRgba.data(), n);
+            kernels.lookup16(table.data(), indices16.data() + offset, resultRgba.data(), n);
+            if (memcmp(expectedRgba.data(), resultRgba.data(), 4 * n)) errors++;
+
+            u16 hold = colreg[offset];
+            u16 expectedHold = util::decodeHAMScalar(bpl.data() + offset, index.data() + offset,
+                                                     colreg, expectedHam.data(), n, hold);
+            u16 resultHold = kernels.decodeHAM(bpl.data() + offset, index.data() + offset,
+                                               colreg, resultHam.data(), n, hold);
+            if (memcmp(expectedHam.data(), resultHam.data(), 2 * n)) errors++;
+            if (expectedHold != resultHold) errors++;
+        }
+
+        // Measure the speed
+        util::Clock clock;
+        const isize rounds = 1000;
+        u32 checksum = 0;
+        for (isize i = 0; i < rounds; i++) {
+            for (isize m = 0; m < count; m++) {
+
+                transpose(&matrices[8 * m], result);
+                checksum += result[m & 15];
+            }
+        }
+        double time = (double)clock.restart().asNanoseconds() / (rounds * count);
+
+        for (isize i = 0; i < rounds; i++) {
+
+            transposeBlock(matrices.data(), count, 0x3F, true, resultBlock.data());
+            checksum += resultBlock[i & 1023];
+        }
+        double blockTime = (double)clock.restart().asNanoseconds() / (rounds * count);
+
+        // Measure the speed of the pixel engine kernels (per 16 pixels)
+        for (isize i = 0; i < rounds; i++) {
+
+            kernels.lookup8(table.data(), 73, indices8.data(), resultRgba.data(), 16 * count);
+            checksum += resultRgba[i & 1023];
+        }
+        double lookup8Time = (double)clock.restart().asNanoseconds() / (rounds * count);
+
+        for (isize i = 0; i < rounds; i++) {
+
+            kernels.lookup16(table.data(), indices16.data(), resultRgba.data(), 16 * count);
+            checksum += resultRgba[i & 1023];
+        }
+        double lookup16Time = (double)clock.restart().asNanoseconds() / (rounds * count);
+
+        for (isize i = 0; i < rounds; i++) {
+
+            checksum += kernels.decodeHAM(bpl.data(), index.data(), colreg,
+                                          resultHam.data(), 16 * count, colreg[i & 31]);
+        }
+        double hamTime = (double)clock.restart().asNanoseconds() / (rounds * count);
+
+        printf("%16s : %s (%08x)\n", name, errors ? "MISMATCH" : "verified", checksum);
+        printf("%16s   Transpose : %.2f nsec per matrix, %.2f nsec en bloc\n", "", time, blockTime);
+        printf("%16s   Lookup    : %.2f nsec (8 bit), %.2f nsec (16 bit) per 16 pixels\n",
+               "", lookup8Time, lookup16Time);
+        printf("%16s   HAM       : %.2f nsec per 16 pixels\n", "", hamTime);
+        if (errors) success = false;
+    }
+    printf("        Selected : %s\n", util::simdName(util::bestSIMD()));
+
+    return success;
+}
+
+void
+Headless::runBenchmark(Amiga &amiga)
+{
+    util::Clock wallClock;
+    std::clock_t cpuStart = std::clock();
+
+    /* If requested, frames are read on a separate thread while the emulator
+     * is running. Each received frame is hashed twice. If the hashes differ,
+     * the emulator has written into the buffer while the consumer owned it.
+     * Furthermore, the consumer keeps a copy of the previously received frame
+     * and updates the dirty lines only. If the copy differs from the received
+     * frame afterwards, damage information has been lost.
+     */
+    std::atomic<bool> stop { false };
+    std::atomic<i64> notified { 0 };
+    i64 received = 0, skipped = 0, torn = 0, damaged = 0;
+    std::thread reader;
+
+    if (consumer) {
+
+        amiga.denise.pixelEngine.setFrameListener(&notified, [](const void *listener, i64 nr) {
+            ((std::atomic<i64> *)listener)->fetch_add(1);
+        });
+        reader = std::thread([&]() {
+
+            i64 last = amiga.denise.pixelEngine.getFrameNr();
+            std::vector<u32> image;
+
+            while (!stop) {
+
+                ScreenBuffer buffer = amiga.denise.pixelEngine.getStableBuffer();
+                if (buffer.nr <= last) { std::this_thread::yield(); continue; }
+
+                u64 hash = util::fnv_1a_64((u8 *)buffer.data, PIXELS * sizeof(u32));
+                std::this_thread::yield();
+                if (hash != util::fnv_1a_64((u8 *)buffer.data, PIXELS * sizeof(u32))) torn++;
+
+                // Update the copy of the previous frame
+                if (image.empty()) {
+                    image.assign(buffer.data, buffer.data + PIXELS);
+                }
+                for (isize line = 0; line < VPIXELS; line++) {
+
+                    if (buffer.dirty[line >> 6] & (1ULL << (line & 63))) {
+
+                        u32 *src = buffer.data + line * HPIXELS;
+                        std::copy(src, src + HPIXELS, image.data() + line * HPIXELS);
+                    }
+                }
+                if (!std::equal(image.begin(), image.end(), buffer.data)) {
+
+                    image.assign(buffer.data, buffer.data + PIXELS);
+                    damaged++;
+                }
+
+                received++;
+                skipped += buffer.nr - last - 1;
+                last = buffer.nr;
+            }
+        });
+    }
+
+    // Run the emulator on this thread as fast as possible
+    if (profile) amiga.profiler.start();
+    if (tracePath != "") amiga.tracer.start(tracePath);
+    i64 emulated = emulate(amiga);
+    if (tracePath != "") amiga.tracer.stop();
+    if (profile) amiga.profiler.stop();
+
+    if (consumer) {
+
+        stop = true;
+        reader.join();
+        amiga.denise.pixelEngine.removeFrameListener();
+    }
+
+    double wallTime = wallClock.getElapsedTime().asSeconds();
+    double cpuTime = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    double fps = wallTime > 0 ? emulated / wallTime : 0;
+
+    printf("          Frames : %lld\n", (long long)emulated);
+    printf("       Wall time : %.3f sec\n", wallTime);
+    printf("   Host CPU time : %.3f sec\n", cpuTime);
+    printf(" Emulated frames : %.1f frames/sec (%.2fx real time)\n",
+           fps, fps / 50.0);
+    printf("      State hash : %016llx\n", (unsigned long long)stateHash(amiga));
+    printf("   Changed lines : %.1f of %d per frame\n",
+           emulated ? (double)changedLines / emulated : 0.0, VPIXELS);
+    if (replayPath != "") {
+        auto info = amiga.inputRecorder.getInfo();
+        printf("  Replayed input : %zd of %zd events\n", info.replayed, info.events);
+    }
+    if (snapshotPath != "") {
+        printf("    Restore time : %.0f usec%s\n", restoreTime, mapSnapshot ? " (mapped)" : "");
+    }
+    if (bootCachePath != "") {
+        auto info = amiga.bootCache.getInfo();
+        printf("      Boot cache : %s (key %016llx), power-on took %.0f usec\n",
+               info.hits ? "hit" : info.stored ? "miss, state stored" : "miss",
+               (unsigned long long)info.key, powerOnTime);
+    }
+    if (tracePath != "" && !EventTracer::isAvailable()) {
+        printf("    Traced events : none (define EVENT_TRACER in config.h)\n");
+    } else if (tracePath != "") {
+        auto info = amiga.tracer.getInfo();
+        printf("    Traced events : %lld written, %lld dropped\n",
+               (long long)info.written, (long long)info.dropped);
+    }
+    if (consumer) {
+        printf("        Consumer : %lld frames received, %lld skipped, %lld torn, "
+               "%lld with lost damage (%s)\n",
+               (long long)received, (long long)skipped, (long long)torn, (long long)damaged,
+               torn == 0 && damaged == 0 && received + skipped <= notified ? "OK" : "FAILED");
+        printf("   Notifications : %lld\n", (long long)notified.load());
+    }
+
+    // Measure how long it takes to serialize the emulator state
+    std::vector<u8> buffer(amiga.size());
+    auto measure = [&]() {
+
+        util::Clock clock;
+        for (isize i = 0; i < 10; i++) amiga.save(buffer.data());
+        return clock.getElapsedTime().asSeconds() * 100000.0;
+    };
+    double portable = measure();
+    double native = [&]() { util::NativeByteOrder native; return measure(); }();
+
+    printf("   Snapshot time : %.1f usec (%.1f usec in native byte order)\n",
+           portable, native);
+
+    // Measure the size of a compressed snapshot file
+    util::Clock clock;
+    std::stringstream stream;
+    isize fileSize = Snapshot::writeAmigaToStream(amiga, stream);
+    double writeTime = clock.restart().asMicroseconds() / 1000.0;
+
+    string contents = stream.str();
+    std::unique_ptr<Snapshot> snapshot(AmigaFile::make <Snapshot> ((const u8 *)contents.data(), fileSize));
+    double readTime = clock.restart().asMicroseconds() / 1000.0;
+
+    amiga.save(buffer.data());
+    bool match = memcmp(snapshot->getData(), buffer.data(), buffer.size()) == 0;
+
+    // Writing the snapshot back must reproduce the file
+    std::stringstream copy;
+    snapshot->writeToStream(copy);
+    match &= copy.str() == contents;
+
+    // Extract the components one by one
+    MappedSnapshot map((const u8 *)contents.data(), fileSize);
+    std::vector<u8> section;
+    isize offset = 0;
+
+    clock.restart();
+    for (isize i = 1; i < (isize)map.getSections().size(); i++) {
+
+        section.resize(map.getSections()[i].rawSize);
+        map.readSection(i, section.data());
+        match &= memcmp(section.data(), buffer.data() + offset, section.size()) == 0;
+        offset += (isize)section.size();
+    }
+    double sectionTime = clock.restart().asMicroseconds() / 1000.0;
+
+    printf("   Snapshot file : %zd bytes (%zd bytes uncompressed)%s\n",
+           fileSize, snapshot->size, match ? "" : " MISMATCH");
+    printf("                   %.2f msec to write, %.2f msec to read\n",
+           writeTime, readTime);
+    printf("                   %.2f msec to extract %zd sections\n",
+           sectionTime, map.getSections().size() - 1);
+
+    /* Write the snapshot to disk if requested. The snapshot is written into a
+     * temporary file which replaces the output file afterwards. The output
+     * file must not be overwritten in place, because it might be the file
+     * the Ram contents have been mapped from (--map).
+     */
+    if (outputPath != "") {
+
+        string tmpPath = outputPath + "." + std::to_string(getpid()) + ".tmp";
+
+        std::ofstream file(tmpPath, std::ios::binary);
+        if (!file.is_open()) throw VAError(ERROR_FILE_CANT_CREATE);
+
+        try { Snapshot::writeAmigaToStream(amiga, file, mappable); } catch (...) {
+
+            file.close();
+            std::remove(tmpPath.c_str());
+            throw;
+        }
+        file.close();
+
+        if (!file || std::rename(tmpPath.c_str(), outputPath.c_str()) != 0) {
+
+            std::remove(tmpPath.c_str());
+            throw VAError(ERROR_FILE_CANT_WRITE);
+        }
+    }
+
+    // Print the collected profiling data
+    if (profile) {
+
+        printf("\n");
+        amiga.profiler.dump(Dump::State);
+    }
+}
+
+void
+Headless::runFleet()
+{
+    // Determine the fleet sizes to measure (1, 2, 4, ..., instances)
+    std::vector<isize> sizes;
+    for (isize n = 1; n < instances; n *= 2) sizes.push_back(n);
+    sizes.push_back(instances);
+
+    printf("Instances   Frames/sec   Per instance   Scaling\n");
+
+    double base = 0;
+    for (auto n : sizes) {
+
+        // Create and configure the fleet
+        std::vector<std::unique_ptr<Amiga>> fleet;
+        for (isize i = 0; i < n; i++) {
+
+            fleet.push_back(std::make_unique<Amiga>());
+            fleet.back()->queue.setListener(&verbose, process);
+            configure(*fleet.back());
+        }
+
+        // Schedule all instances over a pool of worker threads
+        isize workers = std::min(n, (isize)std::max(1U, std::thread::hardware_concurrency()));
+        std::atomic<isize> next { 0 };
+        std::atomic<i64> emulated { 0 };
+        std::vector<std::thread> pool;
+
+        util::Clock wallClock;
+
+        for (isize i = 0; i < workers; i++) {
+
+            pool.emplace_back([&]() {
+
+                isize nr;
+                while ((nr = next++) < n) emulated += emulate(*fleet[nr]);
+            });
+        }
+        for (auto &thread : pool) thread.join();
+
+        double wallTime = wallClock.getElapsedTime().asSeconds();
+        double fps = wallTime > 0 ? emulated / wallTime : 0;
+        if (base == 0) base = fps;
+
+        printf("%9zd %12.1f %14.1f %8.2fx\n", n, fps, fps / n, base ? fps / base : 0);
+
+        // Tear down the fleet
+        for (auto &amiga : fleet) release(*amiga);
+    }
+}
+
+void
+Headless::runDeltaCheck(Amiga &amiga)
+{
+    std::vector<std::unique_ptr<DeltaSnapshot>> chain;
+    util::Clock clock;
+    isize total = 0;
+    isize tracks = 0;
+    double elapsed = 0;
+
+    // Record the initial state and the changes in regular intervals
+    auto take = [&](bool keyframe) {
+
+        clock.restart();
+        chain.emplace_back(amiga.takeDeltaSnapshot(keyframe));
+        elapsed += clock.getElapsedTime().asSeconds() * 1000.0;
+        total += chain.back()->size();
+        if (!keyframe) tracks += chain.back()->numTracks();
+    };
+
+    take(true);
+    for (i64 i = 0; i < frames; i += deltaInterval) {
+
+        for (i64 j = 0; j < deltaInterval; j++) amiga.executeFrame();
+        take(false);
+    }
+
+    // Replay the chain on a second instance
+    u64 expected = stateHash(amiga), actual = 0;
+    runReplica([&](Amiga &replica) {
+
+        for (auto &delta : chain) replica.loadFromDeltaSnapshotUnsafe(delta.get());
+        actual = stateHash(replica);
+    });
+
+    printf(" Delta snapshots : %zu\n", chain.size());
+    printf("       Full size : %zu bytes\n", (size_t)amiga.size());
+    printf("   Keyframe size : %zd bytes\n", chain.front()->size());
+    printf("      Delta size : %zd bytes (average)\n",
+           chain.size() > 1 ? (total - chain.front()->size()) / isize(chain.size() - 1) : 0);
+    printf("    Time / delta : %.3f msec\n", elapsed / chain.size());
+    printf("     Disk tracks : %zd (in all deltas after the keyframe)\n", tracks);
+    printf("      State hash : %016llx\n", (unsigned long long)expected);
+    printHash("Replica hash", actual, expected);
+}
+
+void
+Headless::runRewindCheck(Amiga &amiga)
+{
+    amiga.configure(OPT_REWIND, true);
+
+    // Run the emulator and remember where we ended up
+    i64 emulated = emulate(amiga);
+    i64 targetFrame = amiga.agnus.frame.nr;
+    u64 expected = stateHash(amiga);
+    RewindBufferInfo info = amiga.rewindBuffer.getInfo();
+
+    // Travel back in time
+    util::Clock clock;
+    bool reached = amiga.rewind(rewindSeconds);
+    double elapsed = clock.getElapsedTime().asSeconds() * 1000.0;
+    i64 restoredFrame = amiga.agnus.frame.nr;
+
+    // Emulate the same frames again
+    while (amiga.agnus.frame.nr < targetFrame) {
+        if (!amiga.executeFrame()) break;
+    }
+    u64 actual = stateHash(amiga);
+
+    printf("          Frames : %lld\n", (long long)emulated);
+    printf("     Checkpoints : %zd (%zd keyframes)\n", info.checkpoints, info.keyframes);
+    printf("     Memory used : %zd KB\n", info.bytesUsed / 1024);
+    printf("  Restored frame : %lld%s\n",
+           (long long)restoredFrame, reached ? "" : " (history too short)");
+    printf("  Time / restore : %.3f msec\n", elapsed);
+    printf("      State hash : %016llx\n", (unsigned long long)expected);
+    printHash("Replay hash", actual, expected);
+}
+
+void
+Headless::runRunAheadCheck(Amiga &amiga)
+{
+    amiga.configure(OPT_RUN_AHEAD, runAheadFrames);
+
+    util::Clock wallClock;
+
+    // Run the emulator in run-ahead mode
+    i64 emulated = emulate(amiga);
+
+    double wallTime = wallClock.getElapsedTime().asSeconds();
+    double fps = wallTime > 0 ? emulated / wallTime : 0;
+    RunAheadInfo info = amiga.runAhead.getInfo();
+
+    // Run a second instance without run-ahead
+    u64 expectedState = 0, expectedScreen = 0;
+    runReplica([&](Amiga &reference) {
+
+        emulate(reference);
+        expectedState = stateHash(reference);
+        for (i64 i = 0; i < runAheadFrames; i++) reference.executeFrame();
+        expectedScreen = screenHash(reference);
+    });
+
+    u64 state = stateHash(amiga);
+    u64 screen = screenHash(amiga);
+
+    printf("          Frames : %lld\n", (long long)emulated);
+    printf(" Emulated frames : %.1f frames/sec (%.2fx real time)\n", fps, fps / 50.0);
+    printf("          Passes : %lld (%lld skipped)\n",
+           (long long)info.passes, (long long)info.skipped);
+    printf(" Component state : %zd bytes\n", info.imageSize);
+    printf("     Time / save : %.1f usec\n", info.saveTime);
+    printf("  Time / restore : %.1f usec\n", info.restoreTime);
+    printHash("State hash", state, expectedState);
+    printHash("Screen hash", screen, expectedScreen);
+}
+
+void
+Headless::runForkCheck(Amiga &amiga)
+{
+    // Run the emulator up to the point where the instances are forked off
+    emulate(amiga);
+
+    // Fork off all instances
+    std::vector<std::unique_ptr<Amiga>> children;
+    std::vector<double> forkTimes;
+
+    for (isize i = 0; i < forks; i++) {
+
+        util::Clock clock;
+        children.emplace_back(amiga.fork());
+        forkTimes.push_back(clock.getElapsedTime().asMicroseconds());
+        children.back()->queue.setListener(&verbose, process);
+    }
+
+    // Run all instances in parallel
+    util::Clock wallClock;
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() { emulate(amiga); });
+    for (auto &child : children) {
+        threads.emplace_back([&]() { emulate(*child); });
+    }
+    for (auto &thread : threads) thread.join();
+
+    double wallTime = wallClock.getElapsedTime().asSeconds();
+    double fps = wallTime > 0 ? (forks + 1) * frames / wallTime : 0;
+    u64 expected = stateHash(amiga);
+
+    printf("          Frames : %lld\n", (long long)frames);
+    printf("       Instances : %zd forked\n", forks);
+    printf(" Emulated frames : %.1f frames/sec (all instances)\n", fps);
+    printf("      State hash : %016llx\n", (unsigned long long)expected);
+
+    for (isize i = 0; i < forks; i++) {
+
+        u64 state = stateHash(*children[i]);
+        printf("        Fork %3zd : %.1f usec, %016llx (%s)\n", i + 1, forkTimes[i],
+               (unsigned long long)state, state == expected ? "match" : "MISMATCH");
+
+        release(*children[i]);
+    }
+}
+
+void
+Headless::runRecordCheck(Amiga &amiga)
+{
+    // Run the emulator and record the injected input
+    amiga.inputRecorder.startRecording();
+    i64 emulated = exercise(amiga);
+    amiga.inputRecorder.stop();
+    amiga.inputRecorder.saveToFile(recordPath);
+    u64 expected = stateHash(amiga);
+
+    // Replay the recording on a second instance
+    u64 actual = 0;
+    double loadTime = 0, fps = 0;
+    InputRecorderInfo info = { };
+
+    runReplica([&](Amiga &replica) {
+
+        util::Clock clock;
+        replica.inputRecorder.loadFromFile(recordPath);
+        replica.inputRecorder.startReplay();
+        loadTime = clock.restart().asMicroseconds() / 1000.0;
+
+        emulate(replica);
+        double wallTime = clock.getElapsedTime().asSeconds();
+        fps = wallTime > 0 ? emulated / wallTime : 0;
+        info = replica.inputRecorder.getInfo();
+        actual = stateHash(replica);
+    });
+
+    printf("          Frames : %lld\n", (long long)emulated);
+    printf("  Recorded input : %zd events, %zd disks\n", info.events, info.disks);
+    printf("  Recording file : %zd bytes (%.2f msec to load)\n",
+           util::getSizeOfFile(recordPath), loadTime);
+    printf("   Replay frames : %.1f frames/sec (%.2fx real time)\n", fps, fps / 50.0);
+    printf("      State hash : %016llx\n", (unsigned long long)expected);
+    printHash("Replay hash", actual, expected);
+}
+
+void
+Headless::runHashCheck(Amiga &amiga)
+{
+    util::Clock clock;
+    double hashTime = 0;
+    i64 emulated = 0, diverged = -1;
+
+    // Run a second instance in lockstep
+    runReplica([&](Amiga &twin) {
+
+        for (; emulated < frames; emulated++) {
+
+            if (!amiga.executeFrame() || !twin.executeFrame()) break;
+
+            clock.restart();
+            u64 hash = amiga.hash();
+            hashTime += clock.getElapsedTime().asMicroseconds();
+
+            if (diverged < 0 && hash != twin.hash()) diverged = emulated;
+        }
+    });
+
+    // Compare with the time needed to hash the serialized state
+    clock.restart();
+    stateHash(amiga);
+    double fullTime = clock.getElapsedTime().asMicroseconds();
+
+    // Restore the state in an instance that hasn't computed any hashes yet
+    std::unique_ptr<Snapshot> snapshot(Snapshot::makeWithAmiga(&amiga));
+    u64 actual = amiga.hash(), expected = 0;
+
+    runReplica([&](Amiga &replica) {
+
+        replica.loadFromSnapshotUnsafe(snapshot.get());
+        expected = replica.hash();
+    });
+
+    printf("          Frames : %lld\n", (long long)emulated);
+    printf("     Time / hash : %.1f usec (%.1f usec serialized)\n",
+           emulated ? hashTime / emulated : 0, fullTime);
+    if (diverged < 0) {
+        printf("     Twin states : identical in all frames\n");
+    } else {
+        printf("     Twin states : DIVERGED in frame %lld\n", (long long)diverged);
+    }
+    printf("      State hash : %016llx\n", (unsigned long long)actual);
+    printHash("Replica hash", expected, actual);
+}
+
+void
+Headless::runReplica(std::function<void(Amiga &)> step)
+{
+    Amiga replica;
+    replica.queue.setListener(&verbose, process);
+
+    try {
+
+        configure(replica);
+        step(replica);
+
+    } catch (...) {
+
+        release(replica);
+        throw;
+    }
+
+    release(replica);
+}
+
+void
+Headless::release(Amiga &amiga)
+{
+    amiga.powerOff();
+    amiga.shutdown();
+    amiga.queue.removeListener();
+}
+
+void
+Headless::printHash(const char *label, u64 value, u64 expected)
+{
+    printf("%16s : %016llx (%s)\n",
+           label, (unsigned long long)value, value == expected ? "match" : "MISMATCH");
+}
+
+i64
+Headless::emulate(Amiga &amiga)
+{
+    i64 startFrame = amiga.agnus.frame.nr;
+    i64 targetFrame = startFrame + frames;
+
+    while (amiga.agnus.frame.nr < targetFrame) {
+
+        if (!amiga.executeFrame()) break;
+
+        // Count the lines that differ from the previous frame
+        ScreenBuffer buffer = amiga.denise.pixelEngine.getCompletedBuffer();
+        for (isize i = 0; i < PixelEngine::dirtyWords; i++) {
+            changedLines += __builtin_popcountll(buffer.changed[i]);
+        }
+    }
+
+    return amiga.agnus.frame.nr - startFrame;
+}
+
+i64
+Headless::exercise(Amiga &amiga)
+{
+    i64 startFrame = amiga.agnus.frame.nr;
+    i64 targetFrame = startFrame + frames;
+
+    // Use a fixed seed to generate the same input in each run
+    u32 seed = 0x2f6b1e35;
+    auto random = [&](u32 range) {
+        seed = seed * 1103515245 + 12345;
+        return (isize)((seed >> 16) % range);
+    };
+
+    // Modifier keys (Left Shift, Right Shift, Left Alt, Right Alt)
+    static const long keys[] = { 0x60, 0x61, 0x64, 0x65 };
+
+    static const GamePadAction actions[] = {
+        PULL_UP, PULL_DOWN, PULL_LEFT, PULL_RIGHT, RELEASE_XY,
+        PRESS_FIRE, RELEASE_FIRE
+    };
+
+    while (amiga.agnus.frame.nr < targetFrame) {
+
+        // Stop somewhere inside the current frame
+        isize line = random(300);
+        isize vpos = amiga.agnus.pos.v;
+        if (line > vpos) {
+            amiga.executeCycles(DMA_CYCLES((line - vpos) * HPOS_CNT + random(HPOS_CNT)));
+        }
+
+        switch (random(16)) {
+
+            case 0:
+            case 1:
+            {
+                long key = keys[random(4)];
+                if (amiga.keyboard.keyIsPressed(key)) {
+                    amiga.keyboard.releaseKey(key);
+                } else {
+                    amiga.keyboard.pressKey(key);
+                }
+                break;
+            }
+            case 2:
+            case 3:
+
+                amiga.controlPort1.mouse.setDeltaXY(random(17) - 8.0, random(17) - 8.0);
+                break;
+
+            case 4:
+
+                amiga.controlPort1.mouse.setLeftButton(!amiga.controlPort1.mouse.leftButton);
+                break;
+
+            case 5:
+            case 6:
+
+                amiga.controlPort2.joystick.trigger(actions[random(7)]);
+                break;
+
+            case 7:
+
+                amiga.configure(OPT_AUDVOLL, random(101));
+                break;
+
+            case 8:
+
+                // Swap the disk in df0 now and then
+                if (diskPath[0] != "" && random(8) == 0) {
+
+                    if (amiga.df0.hasDisk()) {
+                        amiga.paula.diskController.ejectDisk(0);
+                    } else {
+                        amiga.paula.diskController.insertDisk(diskPath[0], 0);
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        if (!amiga.executeFrame()) break;
+    }
+
+    return amiga.agnus.frame.nr - startFrame;
+}
+
+u64
+Headless::stateHash(Amiga &amiga)
+{
+    std::vector<u8> buffer(amiga.size());
+    amiga.save(buffer.data());
+
+    return util::fnv_1a_64(buffer.data(), (isize)buffer.size());
+}
+
+u64
+Headless::screenHash(Amiga &amiga)
+{
+    ScreenBuffer buffer = amiga.denise.pixelEngine.getCompletedBuffer();
+
+    // The last line is only drawn in long frames and is therefore skipped
+    return util::fnv_1a_64((u8 *)buffer.data, VPOS_MAX * HPIXELS * sizeof(u32));
+}
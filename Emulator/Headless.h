@@ -0,0 +1,220 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Amiga.h"
+#include <functional>
+
+/* Headless command-line frontend. This class drives the emulator core without
+ * any GUI attached. It constructs an Amiga, installs the media provided on the
+ * command line, runs the emulator synchronously for a certain number of frames
+ * and reports the achieved emulation speed. It is meant as a reproducible
+ * baseline for measuring performance on machines without a macOS host.
+ *
+ *     vAmiga -r kick.rom [-e ext.rom] [-d0 disk.adf] [-s snapshot] [-f frames]
+ *            [-o snapshot] [-n instances] [--record file | --replay file]
+ *            [--hash] [--profile] [--trace file] [--consumer] [file]
+ *     vAmiga --peek snapshot
+ *     vAmiga --kernels
+ */
+class Headless {
+
+    // Paths to the Rom images
+    string romPath;
+    string extPath;
+
+    // Paths to the disks to insert into df0 to df3
+    string diskPath[4];
+
+    // Path to a snapshot to start from
+    string snapshotPath;
+
+    // Path to a snapshot that is written after the run
+    string outputPath;
+
+    // Indicates if the written snapshot should be mappable
+    bool mappable = false;
+
+    // Indicates if the snapshot should be restored via a memory mapping
+    bool mapSnapshot = false;
+
+    // Time needed to restore the snapshot in usec
+    double restoreTime = 0;
+
+    // Directory of the boot cache (empty = boot cache is disabled)
+    string bootCachePath;
+
+    // Number of frames emulated before the boot state is cached
+    i64 bootFrames = 250;
+
+    // Time needed to power on the emulator in usec
+    double powerOnTime = 0;
+
+    // Number of changed lines in all frames emulated by emulate()
+    i64 changedLines = 0;
+
+    // Path to a snapshot whose metadata is printed
+    string peekPath;
+
+    // Indicates if the SIMD kernels should be verified and benchmarked
+    bool kernelCheck = false;
+
+    // Path to a RetroShell script that is executed before powering on
+    string scriptPath;
+
+    // Path to a file storing recorded input
+    string recordPath;
+
+    // Path to a file with input to replay during the run
+    string replayPath;
+
+    // Memory configuration in KB
+    long chipRam = 512;
+    long slowRam = 512;
+    long fastRam = 0;
+
+    // Number of emulated frames to run
+    i64 frames = 500;
+
+    // Number of emulator instances to run in parallel
+    isize instances = 1;
+
+    // Interval in frames for taking delta snapshots (0 = no delta snapshots)
+    i64 deltaInterval = 0;
+
+    // Number of seconds to travel back in time (0 = no time travel)
+    i64 rewindSeconds = 0;
+
+    // Number of frames to run ahead (0 = run-ahead is disabled)
+    i64 runAheadFrames = 0;
+
+    // Number of instances to fork off (0 = no forking)
+    isize forks = 0;
+
+    // Indicates if the state should be hashed in each frame
+    bool hashCheck = false;
+
+    // Indicates if the benchmark should be profiled
+    bool profile = false;
+
+    // Chrome trace file to write during the benchmark
+    string tracePath;
+
+    // Indicates if frames should be read on a separate thread during the benchmark
+    bool consumer = false;
+
+    // Indicates if messages from the emulator should be printed
+    bool verbose = false;
+
+
+    //
+    // Running
+    //
+
+public:
+
+    // Main entry point
+    int main(int argc, char *argv[]);
+
+private:
+
+    // Parses the command line. Returns false if the emulator shouldn't run
+    bool parseArguments(int argc, char *argv[]) throws;
+
+    // Prints a usage string
+    void usage(const char *name);
+
+    // Sets up the emulator according to the provided arguments
+    void configure(Amiga &amiga) throws;
+
+    // Prints the metadata and the section directory of a snapshot file
+    void runPeek() throws;
+
+    /* Compares all SIMD kernels supported by the host CPU with their scalar
+     * counterparts and measures their speed. Returns false if a kernel
+     * produces a different result.
+     */
+    bool runKernelCheck();
+
+    // Runs the emulator and prints the benchmark results
+    void runBenchmark(Amiga &amiga);
+
+    /* Runs a fleet of independent emulator instances over a thread pool. The
+     * benchmark is repeated with 1, 2, 4, ... instances to report how the
+     * aggregate frame rate scales with the number of cores.
+     */
+    void runFleet();
+
+    /* Takes a delta snapshot in regular intervals while running the emulator.
+     * Afterwards, the recorded chain is applied to a second instance to verify
+     * that both instances end up in the same state.
+     */
+    void runDeltaCheck(Amiga &amiga);
+
+    /* Runs the emulator with the rewind buffer enabled, travels back in time
+     * and emulates the same frames again. Afterwards, the resulting state is
+     * compared with the state reached in the first run.
+     */
+    void runRewindCheck(Amiga &amiga);
+
+    /* Runs the emulator in run-ahead mode. Afterwards, a second instance is
+     * run without run-ahead to verify that the emulated state is unaffected
+     * and that the presented frame is the one from the future.
+     */
+    void runRunAheadCheck(Amiga &amiga);
+
+    /* Forks off a couple of instances after running the emulator. Afterwards,
+     * all instances are run in parallel to verify that each of them ends up
+     * in the same state.
+     */
+    void runForkCheck(Amiga &amiga);
+
+    /* Records a session with some synthetic input and writes the recording
+     * into a file. Afterwards, the recording is replayed on a second instance
+     * to verify that both instances end up in the same state.
+     */
+    void runRecordCheck(Amiga &amiga);
+
+    /* Runs two instances in lockstep and compares their state hashes in each
+     * frame. Afterwards, the state is restored in a third instance to verify
+     * that the incrementally updated hash matches a hash computed from scratch.
+     */
+    void runHashCheck(Amiga &amiga);
+
+    /* Creates a second instance with the same configuration and passes it to
+     * the provided function. The checks above use this instance to run or
+     * replay the emulator and compare the outcome with the first instance.
+     */
+    void runReplica(std::function<void(Amiga &)> step) throws;
+
+    // Powers off and shuts down an instance and removes the message listener
+    void release(Amiga &amiga);
+
+    // Prints a hash and whether it matches the expected value
+    void printHash(const char *label, u64 value, u64 expected);
+
+    // Emulates the requested number of frames and returns the frames emulated
+    i64 emulate(Amiga &amiga);
+
+    /* Emulates the requested number of frames like emulate() does. In each
+     * frame, the emulator is stopped at a pseudo-random position to inject
+     * some keyboard, mouse, joystick, disk, or configuration input.
+     */
+    i64 exercise(Amiga &amiga);
+
+    /* Computes a checksum over the serialized emulator state. Two runs with
+     * the same input are expected to produce the same value, regardless of
+     * the compile-time options selected for the CPU core.
+     */
+    u64 stateHash(Amiga &amiga);
+
+    // Computes a checksum over the frame that is currently shown
+    u64 screenHash(Amiga &amiga);
+};
@@ -53,8 +53,8 @@ Oscillator::synchronize()
 {
     syncCounter++;
     
-    // Only proceed if we are not running in warp mode
-    if (warpMode) return;
+    // Only proceed if the emulator thread is running in real-time mode
+    if (warpMode || !isRunning()) return;
     
     auto now          = util::Time::now();
     auto elapsedCyles = agnus.clock - clockBase;
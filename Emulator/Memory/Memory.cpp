@@ -21,6 +21,8 @@
 #include "RomFile.h"
 #include "RTC.h"
 #include "ZorroManager.h"
+#include <sys/mman.h>
+#include <unistd.h>
 
 Memory::Memory(Amiga& ref) : AmigaComponent(ref)
 {
@@ -41,12 +43,33 @@ Memory::~Memory()
 void
 Memory::dealloc()
 {
-    if (rom) { delete[] rom; rom = nullptr; }
-    if (wom) { delete[] wom; wom = nullptr; }
-    if (ext) { delete[] ext; ext = nullptr; }
-    if (chip) { delete[] chip; chip = nullptr; }
-    if (slow) { delete[] slow; slow = nullptr; }
-    if (fast) { delete[] fast; fast = nullptr; }
+    release(rom);
+    release(wom);
+    release(ext);
+    release(chip);
+    release(slow);
+    release(fast);
+}
+
+void
+Memory::release(u8 *&ptr)
+{
+    if (!ptr) return;
+
+    // Check if the block has been mapped from a file
+    for (auto it = mappedBlocks.begin(); it != mappedBlocks.end(); it++) {
+
+        if (it->ptr == ptr) {
+
+            munmap(ptr, (size_t)it->size);
+            mappedBlocks.erase(it);
+            ptr = nullptr;
+            return;
+        }
+    }
+
+    delete[] ptr;
+    ptr = nullptr;
 }
 
 void
@@ -223,12 +246,15 @@ Memory::_size()
     << config.slowSize
     << config.fastSize;
     
-    counter.count += config.romSize;
-    counter.count += config.womSize;
-    counter.count += config.extSize;
-    counter.count += config.chipSize;
-    counter.count += config.slowSize;
-    counter.count += config.fastSize;
+    if (serializeContents) {
+        
+        counter.count += config.romSize;
+        counter.count += config.womSize;
+        counter.count += config.extSize;
+        counter.count += config.chipSize;
+        counter.count += config.slowSize;
+        counter.count += config.fastSize;
+    }
 
     return counter.count;
 }
@@ -237,6 +263,7 @@ isize
 Memory::didLoadFromBuffer(const u8 *buffer)
 {
     util::SerReader reader(buffer);
+    MemoryConfig old = config;
 
     // Load memory size information
     reader
@@ -255,24 +282,52 @@ Memory::didLoadFromBuffer(const u8 *buffer)
     if (config.slowSize > KB(512)) { config.slowSize = 0; assert(false); }
     if (config.fastSize > MB(8)) { config.fastSize = 0; assert(false); }
 
-    // Free previously allocated memory
-    dealloc();
+    if (serializeContents) {
+        
+        // Free previously allocated memory
+        dealloc();
+
+        // Allocate new memory
+        if (config.romSize) rom = new (std::nothrow) u8[config.romSize];
+        if (config.womSize) wom = new (std::nothrow) u8[config.womSize];
+        if (config.extSize) ext = new (std::nothrow) u8[config.extSize];
+        if (config.chipSize) chip = new (std::nothrow) u8[config.chipSize];
+        if (config.slowSize) slow = new (std::nothrow) u8[config.slowSize];
+        if (config.fastSize) fast = new (std::nothrow) u8[config.fastSize];
+
+        // Load memory contents from buffer
+        reader.copy(rom, config.romSize);
+        reader.copy(wom, config.womSize);
+        reader.copy(ext, config.extSize);
+        reader.copy(chip, config.chipSize);
+        reader.copy(slow, config.slowSize);
+        reader.copy(fast, config.fastSize);
+        
+        markAllPagesDirty();
 
-    // Allocate new memory
-    if (config.romSize) rom = new (std::nothrow) u8[config.romSize];
-    if (config.womSize) wom = new (std::nothrow) u8[config.womSize];
-    if (config.extSize) ext = new (std::nothrow) u8[config.extSize];
-    if (config.chipSize) chip = new (std::nothrow) u8[config.chipSize];
-    if (config.slowSize) slow = new (std::nothrow) u8[config.slowSize];
-    if (config.fastSize) fast = new (std::nothrow) u8[config.fastSize];
-
-    // Load memory contents from buffer
-    reader.copy(rom, config.romSize);
-    reader.copy(wom, config.womSize);
-    reader.copy(ext, config.extSize);
-    reader.copy(chip, config.chipSize);
-    reader.copy(slow, config.slowSize);
-    reader.copy(fast, config.fastSize);
+    } else {
+        
+        /* The buffer contains no memory contents. We only need to adjust the
+         * allocation of all memory types whose size has changed. The contents
+         * are restored page by page by the caller.
+         */
+        auto resize = [this](u8 *&ptr, isize oldSize, isize newSize) {
+            
+            if (oldSize == newSize) return;
+            release(ptr);
+            if (newSize) ptr = new (std::nothrow) u8[newSize];
+        };
+        
+        resize(rom, old.romSize, config.romSize);
+        resize(wom, old.womSize, config.womSize);
+        resize(ext, old.extSize, config.extSize);
+        resize(chip, old.chipSize, config.chipSize);
+        resize(slow, old.slowSize, config.slowSize);
+        resize(fast, old.fastSize, config.fastSize);
+    }
+    
+    // Memory has been reallocated. Hence, all host pointers need an update
+    updateMemPtrTables();
 
     return (isize)(reader.ptr - buffer);
 }
@@ -291,16 +346,57 @@ Memory::didSaveToBuffer(u8 *buffer) const
     << config.fastSize;
     
     // Save memory contents
-    writer.copy(rom, config.romSize);
-    writer.copy(wom, config.womSize);
-    writer.copy(ext, config.extSize);
-    writer.copy(chip, config.chipSize);
-    writer.copy(slow, config.slowSize);
-    writer.copy(fast, config.fastSize);
+    if (serializeContents) {
+        
+        writer.copy(rom, config.romSize);
+        writer.copy(wom, config.womSize);
+        writer.copy(ext, config.extSize);
+        writer.copy(chip, config.chipSize);
+        writer.copy(slow, config.slowSize);
+        writer.copy(fast, config.fastSize);
+    }
     
     return (isize)(writer.ptr - buffer);
 }
 
+u64
+Memory::_hash()
+{
+    // Hash the memory layout and the remaining state
+    serializeContents = false;
+    u64 result = HardwareComponent::_hash();
+    serializeContents = true;
+
+    // Hash the memory contents page by page
+    DirtyRegion regions[MEM_REGION_COUNT];
+    getDirtyRegions(regions);
+    u64 *hashes[MEM_REGION_COUNT] = {
+        romHash, womHash, extHash, chipHash, slowHash, fastHash };
+
+    for (isize r = 0; r < MEM_REGION_COUNT; r++) {
+
+        auto &region = regions[r];
+
+        for (isize offset = 0; offset < region.size; offset += MEM_PAGE_SIZE) {
+
+            isize nr = offset >> MEM_PAGE_SHIFT;
+
+            // Only rehash the pages that have been modified in the meantime
+            if (region.dirty[nr] >= hashEpoch) {
+
+                isize count = std::min((isize)MEM_PAGE_SIZE, region.size - offset);
+                hashes[r][nr] = util::fnv_1a_64(region.ptr + offset, count);
+            }
+            result = util::fnv_1a_it64(result, hashes[r][nr]);
+        }
+    }
+
+    // Open a new epoch to spot the pages modified until the next run
+    hashEpoch = nextDirtyEpoch();
+
+    return result;
+}
+
 void
 Memory::_dump(Dump::Category category, std::ostream& os) const
 {
@@ -417,7 +513,7 @@ Memory::alloc(i32 bytes, u8 *&ptr, i32 &size, u32 &mask)
     if (bytes == size) return true;
     
     // Delete previous allocation
-    if (ptr) { delete[] ptr; ptr = nullptr; size = 0; mask = 0; }
+    if (ptr) { release(ptr); size = 0; mask = 0; }
     
     // Allocate memory
     if (bytes) {
@@ -437,10 +533,138 @@ Memory::alloc(i32 bytes, u8 *&ptr, i32 &size, u32 &mask)
             assert(false);
         }
     }
+    markAllPagesDirty();
     updateMemSrcTables();
     return true;
 }
 
+void
+Memory::mapContents(int fd, isize offset, isize count)
+{
+    isize pageSize = (isize)sysconf(_SC_PAGESIZE);
+
+    // Check if the file contains all memory blocks
+    isize total = 0;
+    total += config.romSize + config.womSize + config.extSize;
+    total += config.chipSize + config.slowSize + config.fastSize;
+    if (count != total) throw VAError(ERROR_SNP_CORRUPTED);
+
+    auto install = [&](u8 *&ptr, isize size) {
+
+        if (size == 0) return;
+
+        // Map the block if it starts at a page boundary
+        if (offset % pageSize == 0) {
+
+            void *addr = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE, fd, (off_t)offset);
+
+            if (addr != MAP_FAILED) {
+
+                release(ptr);
+                ptr = (u8 *)addr;
+                mappedBlocks.push_back({ ptr, size, nullptr, 0 });
+                offset += size;
+                return;
+            }
+        }
+
+        // Otherwise, read the block
+        assert(ptr);
+        if (pread(fd, ptr, (size_t)size, (off_t)offset) != (ssize_t)size) {
+            throw VAError(ERROR_FILE_CANT_READ);
+        }
+        offset += size;
+    };
+
+    install(rom, config.romSize);
+    install(wom, config.womSize);
+    install(ext, config.extSize);
+    install(chip, config.chipSize);
+    install(slow, config.slowSize);
+    install(fast, config.fastSize);
+
+    markAllPagesDirty();
+    updateMemPtrTables();
+}
+
+void
+Memory::cloneContents(Memory &other)
+{
+    assert(config.romSize == other.config.romSize);
+    assert(config.womSize == other.config.womSize);
+    assert(config.extSize == other.config.extSize);
+    assert(config.chipSize == other.config.chipSize);
+    assert(config.slowSize == other.config.slowSize);
+    assert(config.fastSize == other.config.fastSize);
+
+    // All pages change in the current epoch. Copied pages change in the next
+    markAllPagesDirty();
+    u32 epoch = nextDirtyEpoch();
+
+    auto clone = [&](u8 *&ptr, u32 *dirty, u8 *&src, const u32 *srcDirty, isize size) {
+
+        if (size == 0) return;
+
+        const MappedBlock *block = other.freeze(src, size, srcDirty);
+        u8 *addr = block ? block->frozen->map() : nullptr;
+
+        // Copy the whole block if it can't be shared
+        if (!addr) { memcpy(ptr, src, size); return; }
+
+        // Copy all pages that have been modified since the block was frozen
+        for (isize offset = 0; offset < size; offset += MEM_PAGE_SIZE) {
+
+            if (srcDirty[offset >> MEM_PAGE_SHIFT] < block->epoch) continue;
+
+            isize count = std::min((isize)MEM_PAGE_SIZE, size - offset);
+            memcpy(addr + offset, src + offset, count);
+            dirty[offset >> MEM_PAGE_SHIFT] = epoch;
+        }
+
+        release(ptr);
+        ptr = addr;
+        mappedBlocks.push_back({ ptr, size, block->frozen, epoch });
+    };
+
+    clone(rom, romDirty, other.rom, other.romDirty, config.romSize);
+    clone(wom, womDirty, other.wom, other.womDirty, config.womSize);
+    clone(ext, extDirty, other.ext, other.extDirty, config.extSize);
+    clone(chip, chipDirty, other.chip, other.chipDirty, config.chipSize);
+    clone(slow, slowDirty, other.slow, other.slowDirty, config.slowSize);
+    clone(fast, fastDirty, other.fast, other.fastDirty, config.fastSize);
+
+    updateMemPtrTables();
+    other.updateMemPtrTables();
+}
+
+const Memory::MappedBlock *
+Memory::freeze(u8 *&ptr, isize size, const u32 *dirty)
+{
+    // Reuse the frozen file if most pages are still unmodified
+    for (auto &block : mappedBlocks) {
+
+        if (block.ptr != ptr || !block.frozen) continue;
+
+        isize pages = 0, modified = 0;
+        for (isize offset = 0; offset < size; offset += MEM_PAGE_SIZE, pages++) {
+            if (dirty[offset >> MEM_PAGE_SHIFT] >= block.epoch) modified++;
+        }
+        if (4 * modified < pages) return &block;
+    }
+
+    // Write the block into a new anonymous file and map it
+    auto file = std::make_shared<util::AnonymousFile>(ptr, size);
+    u8 *addr = file->isValid() ? file->map() : nullptr;
+    if (!addr) return nullptr;
+
+    release(ptr);
+    ptr = addr;
+    mappedBlocks.push_back({ ptr, size, file, nextDirtyEpoch() });
+
+    return &mappedBlocks.back();
+}
+
 void
 Memory::fillRamWithInitPattern()
 {
@@ -473,6 +697,30 @@ Memory::fillRamWithInitPattern()
         default:
             assert(false);
     }
+    
+    markAllPagesDirty();
+}
+
+void
+Memory::markAllPagesDirty()
+{
+    std::fill(std::begin(romDirty), std::end(romDirty), dirtyEpoch);
+    std::fill(std::begin(womDirty), std::end(womDirty), dirtyEpoch);
+    std::fill(std::begin(extDirty), std::end(extDirty), dirtyEpoch);
+    std::fill(std::begin(chipDirty), std::end(chipDirty), dirtyEpoch);
+    std::fill(std::begin(slowDirty), std::end(slowDirty), dirtyEpoch);
+    std::fill(std::begin(fastDirty), std::end(fastDirty), dirtyEpoch);
+}
+
+void
+Memory::getDirtyRegions(DirtyRegion (&regions)[MEM_REGION_COUNT])
+{
+    regions[0] = { rom, config.romSize, romDirty };
+    regions[1] = { wom, config.womSize, womDirty };
+    regions[2] = { ext, config.extSize, extDirty };
+    regions[3] = { chip, config.chipSize, chipDirty };
+    regions[4] = { slow, config.slowSize, slowDirty };
+    regions[5] = { fast, config.fastSize, fastDirty };
 }
 
 u32
@@ -669,6 +917,7 @@ Memory::loadRom(AmigaFile *file, u8 *target, isize length)
         }
         
         memcpy(target, file->data, std::min(file->size, length));
+        markAllPagesDirty();
     }
 }
 
@@ -847,6 +1096,7 @@ Memory::updateCpuMemSrcTable()
             cpuMemSrc[i] = cpuMemSrc[0xF8 + i];
     }
 
+    updateMemPtrTables();
     messageQueue.put(MSG_MEM_LAYOUT);
 }
 
@@ -871,6 +1121,72 @@ Memory::updateAgnusMemSrcTable()
             agnusMemSrc[i] = MEM_SLOW_MIRROR;
         }
     }
+    
+    updateMemPtrTables();
+}
+
+void
+Memory::updateMemPtrTables()
+{
+    for (isize i = 0x00; i <= 0xFF; i++) {
+        
+        u32 addr = (u32)i << 16;
+        
+        cpuReadPtr[i] = nullptr;
+        cpuWritePtr[i] = nullptr;
+        cpuReadCnt[i] = nullptr;
+        cpuWriteCnt[i] = nullptr;
+        cpuWriteDirty[i] = nullptr;
+
+        switch (cpuMemSrc[i]) {
+                
+            case MEM_FAST:
+                
+                cpuReadPtr[i] = fast + (addr - FAST_RAM_STRT);
+                cpuWritePtr[i] = cpuReadPtr[i];
+                cpuReadCnt[i] = &stats.fastReads.raw;
+                cpuWriteCnt[i] = &stats.fastWrites.raw;
+                cpuWriteDirty[i] = fastDirty + ((addr - FAST_RAM_STRT) >> MEM_PAGE_SHIFT);
+                break;
+                
+            case MEM_ROM:
+            case MEM_ROM_MIRROR:
+                
+                if (romMask < 0xFFFF) break;
+                cpuReadPtr[i] = rom + (addr & romMask);
+                cpuReadCnt[i] = &stats.kickReads.raw;
+                break;
+                
+            case MEM_WOM:
+                
+                if (womMask < 0xFFFF) break;
+                cpuReadPtr[i] = wom + (addr & womMask);
+                cpuReadCnt[i] = &stats.kickReads.raw;
+                if (!womIsLocked) {
+                    cpuWritePtr[i] = cpuReadPtr[i];
+                    cpuWriteCnt[i] = &stats.kickWrites.raw;
+                    cpuWriteDirty[i] = womDirty + ((addr & womMask) >> MEM_PAGE_SHIFT);
+                }
+                break;
+                
+            case MEM_EXT:
+                
+                if (extMask < 0xFFFF) break;
+                cpuReadPtr[i] = ext + (addr & extMask);
+                cpuReadCnt[i] = &stats.kickReads.raw;
+                break;
+                
+            default:
+                break;
+        }
+        
+        agnusPtr[i] = nullptr;
+        agnusDirty[i] = nullptr;
+        if (agnusMemSrc[i] == MEM_CHIP && chipMask >= 0xFFFF) {
+            agnusPtr[i] = chip + (addr & chipMask);
+            agnusDirty[i] = chipDirty + ((addr & chipMask) >> MEM_PAGE_SHIFT);
+        }
+    }
 }
 
 //
@@ -1188,7 +1504,17 @@ template<> u8
 Memory::peek8 <ACCESSOR_CPU> (u32 addr)
 {
     u8 result;
-        
+    
+    // Take the fast path if the bank is backed by plain host memory
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    if (u8 *ptr = cpuReadPtr[bank]) {
+        (*cpuReadCnt[bank])++;
+        return R8BE_ALIGNED(ptr + (addr & 0xFFFF));
+    }
+    
+    // Make sure that Agnus has caught up with the CPU
+    agnus.syncWithCPU();
+    
     switch (cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
             
         case MEM_NONE:          result = peek8 <ACCESSOR_CPU, MEM_NONE>     (addr); break;
@@ -1221,6 +1547,16 @@ Memory::peek16 <ACCESSOR_CPU> (u32 addr)
     
     assert(IS_EVEN(addr));
     
+    // Take the fast path if the bank is backed by plain host memory
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    if (u8 *ptr = cpuReadPtr[bank]) {
+        (*cpuReadCnt[bank])++;
+        return R16BE_ALIGNED(ptr + (addr & 0xFFFF));
+    }
+    
+    // Make sure that Agnus has caught up with the CPU
+    agnus.syncWithCPU();
+    
     switch (cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
             
         case MEM_NONE:          result = peek16 <ACCESSOR_CPU, MEM_NONE>     (addr); break;
@@ -1334,6 +1670,12 @@ Memory::peek16 <ACCESSOR_AGNUS> (u32 addr)
     assert(IS_EVEN(addr));
     addr &= agnus.ptrMask;
 
+    // Take the fast path if the bank is backed by Chip Ram
+    if (u8 *ptr = agnusPtr[addr >> 16]) {
+        dataBus = R16BE_ALIGNED(ptr + (addr & 0xFFFF));
+        return dataBus;
+    }
+    
     switch (agnusMemSrc[addr >> 16]) {
             
         case MEM_NONE:        result = peek16 <ACCESSOR_AGNUS, MEM_NONE> (addr); break;
@@ -1607,6 +1949,18 @@ Memory::poke16 <ACCESSOR_CPU, MEM_EXT> (u32 addr, u16 value)
 template<> void
 Memory::poke8 <ACCESSOR_CPU> (u32 addr, u8 value)
 {
+    // Take the fast path if the bank is backed by plain host memory
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    if (u8 *ptr = cpuWritePtr[bank]) {
+        (*cpuWriteCnt[bank])++;
+        W8BE_ALIGNED(ptr + (addr & 0xFFFF), value);
+        MARK_DIRTY(cpuWriteDirty[bank], addr & 0xFFFF);
+        return;
+    }
+    
+    // Make sure that Agnus has caught up with the CPU
+    agnus.syncWithCPU();
+    
     switch (cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
             
         case MEM_NONE:          poke8 <ACCESSOR_CPU, MEM_NONE>     (addr, value); return;
@@ -1652,6 +2006,18 @@ Memory::poke16 <ACCESSOR_CPU> (u32 addr, u16 value)
     }
     */
     
+    // Take the fast path if the bank is backed by plain host memory
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    if (u8 *ptr = cpuWritePtr[bank]) {
+        (*cpuWriteCnt[bank])++;
+        W16BE_ALIGNED(ptr + (addr & 0xFFFF), value);
+        MARK_DIRTY(cpuWriteDirty[bank], addr & 0xFFFF);
+        return;
+    }
+    
+    // Make sure that Agnus has caught up with the CPU
+    agnus.syncWithCPU();
+    
     switch (cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
             
         case MEM_NONE:          poke16 <ACCESSOR_CPU, MEM_NONE>     (addr, value); return;
@@ -1712,6 +2078,14 @@ Memory::poke16 <ACCESSOR_AGNUS> (u32 addr, u16 value)
     assert(IS_EVEN(addr));
     addr &= agnus.ptrMask;
     
+    // Take the fast path if the bank is backed by Chip Ram
+    if (u8 *ptr = agnusPtr[addr >> 16]) {
+        dataBus = value;
+        W16BE_ALIGNED(ptr + (addr & 0xFFFF), value);
+        MARK_DIRTY(agnusDirty[addr >> 16], addr & 0xFFFF);
+        return;
+    }
+    
     switch (agnusMemSrc[addr >> 16]) {
             
         case MEM_NONE:          poke16 <ACCESSOR_AGNUS, MEM_NONE> (addr, value); return;
@@ -12,10 +12,22 @@
 #include "MemoryTypes.h"
 #include "AmigaComponent.h"
 #include "RomFileTypes.h"
+#include "SharedMemory.h"
+#include <memory>
 
 // DEPRECATED. TODO: GET VALUE FROM ZORRO CARD MANANGER
 const u32 FAST_RAM_STRT = 0x200000;
 
+// Granularity of the dirty page tracking (4 KB pages)
+#define MEM_PAGE_SHIFT 12
+#define MEM_PAGE_SIZE (1 << MEM_PAGE_SHIFT)
+
+// Number of memory types covered by the dirty page tracking
+#define MEM_REGION_COUNT 6
+
+// Host memory and dirty page map of a single memory type
+struct DirtyRegion { u8 *ptr; isize size; u32 *dirty; };
+
 // Verifies address ranges
 #define ASSERT_CHIP_ADDR(x) \
 assert(((x) % config.chipSize) == ((x) & chipMask));
@@ -70,25 +82,39 @@ assert((x) >= 0xE80000 && (x) <= 0xE8FFFF);
 // Writing
 //
 
+// Marks the page containing a certain memory offset as modified
+#define MARK_DIRTY(map,x) \
+do { (map)[(x) >> MEM_PAGE_SHIFT] = dirtyEpoch; } while (0)
+
 // Writes a value into Chip RAM in big endian format
-#define WRITE_CHIP_8(x,y)  W8BE_ALIGNED (chip + ((x) & chipMask), (y))
-#define WRITE_CHIP_16(x,y) W16BE_ALIGNED(chip + ((x) & chipMask), (y))
+#define WRITE_CHIP_8(x,y) \
+do { W8BE_ALIGNED (chip + ((x) & chipMask), (y)); MARK_DIRTY(chipDirty, (x) & chipMask); } while (0)
+#define WRITE_CHIP_16(x,y) \
+do { W16BE_ALIGNED(chip + ((x) & chipMask), (y)); MARK_DIRTY(chipDirty, (x) & chipMask); } while (0)
 
 // Writes a value into Fast RAM in big endian format
-#define WRITE_FAST_8(x,y)  W8BE_ALIGNED (fast + ((x) - FAST_RAM_STRT), (y))
-#define WRITE_FAST_16(x,y) W16BE_ALIGNED(fast + ((x) - FAST_RAM_STRT), (y))
+#define WRITE_FAST_8(x,y) \
+do { W8BE_ALIGNED (fast + ((x) - FAST_RAM_STRT), (y)); MARK_DIRTY(fastDirty, (x) - FAST_RAM_STRT); } while (0)
+#define WRITE_FAST_16(x,y) \
+do { W16BE_ALIGNED(fast + ((x) - FAST_RAM_STRT), (y)); MARK_DIRTY(fastDirty, (x) - FAST_RAM_STRT); } while (0)
 
 // Writes a value into Slow RAM in big endian format
-#define WRITE_SLOW_8(x,y)  W8BE_ALIGNED (slow + ((x) & slowMask), (y))
-#define WRITE_SLOW_16(x,y) W16BE_ALIGNED(slow + ((x) & slowMask), (y))
+#define WRITE_SLOW_8(x,y) \
+do { W8BE_ALIGNED (slow + ((x) & slowMask), (y)); MARK_DIRTY(slowDirty, (x) & slowMask); } while (0)
+#define WRITE_SLOW_16(x,y) \
+do { W16BE_ALIGNED(slow + ((x) & slowMask), (y)); MARK_DIRTY(slowDirty, (x) & slowMask); } while (0)
 
 // Writes a value into Kickstart WOM in big endian format
-#define WRITE_WOM_8(x,y)  W8BE_ALIGNED (wom + ((x) & womMask), (y))
-#define WRITE_WOM_16(x,y) W16BE_ALIGNED(wom + ((x) & womMask), (y))
+#define WRITE_WOM_8(x,y) \
+do { W8BE_ALIGNED (wom + ((x) & womMask), (y)); MARK_DIRTY(womDirty, (x) & womMask); } while (0)
+#define WRITE_WOM_16(x,y) \
+do { W16BE_ALIGNED(wom + ((x) & womMask), (y)); MARK_DIRTY(womDirty, (x) & womMask); } while (0)
 
 // Writes a value into Extended ROM in big endian format
-#define WRITE_EXT_8(x,y)  W8BE_ALIGNED (ext + ((x) & extMask), (y))
-#define WRITE_EXT_16(x,y) W16BE_ALIGNED(ext + ((x) & extMask), (y))
+#define WRITE_EXT_8(x,y) \
+do { W8BE_ALIGNED (ext + ((x) & extMask), (y)); MARK_DIRTY(extDirty, (x) & extMask); } while (0)
+#define WRITE_EXT_16(x,y) \
+do { W16BE_ALIGNED(ext + ((x) & extMask), (y)); MARK_DIRTY(extDirty, (x) & extMask); } while (0)
 
 
 class Memory : public AmigaComponent {
@@ -151,6 +177,21 @@ public:
     u8 *slow = nullptr;
     u8 *fast = nullptr;
 
+    /* Memory blocks which have been mapped from a file instead of being
+     * allocated on the heap. Such blocks are released with munmap(). If the
+     * block has been frozen, each page that has been modified in the frozen
+     * epoch or later differs from the contents of the frozen file.
+     * See also: mapContents(), cloneContents()
+     */
+    struct MappedBlock {
+
+        u8 *ptr;
+        isize size;
+        std::shared_ptr<util::AnonymousFile> frozen;
+        u32 epoch;
+    };
+    std::vector<MappedBlock> mappedBlocks;
+
     u32 romMask = 0;
     u32 womMask = 0;
     u32 extMask = 0;
@@ -173,6 +214,70 @@ public:
     MemorySource cpuMemSrc[256];
     MemorySource agnusMemSrc[256];
 
+    /* Direct access tables. For all banks that are backed by plain host memory
+     * without any side effects (Fast Ram, Roms, and Chip Ram as seen by Agnus),
+     * these tables point to the host memory of the bank start. For all other
+     * banks, the pointer is nullptr and the access is routed through the
+     * handler selected by the memory source tables. Because the tables are
+     * derived from the memory source tables, they are not serialized.
+     * See also: updateMemPtrTables()
+     */
+    u8 *cpuReadPtr[256] = {};
+    u8 *cpuWritePtr[256] = {};
+    u8 *agnusPtr[256] = {};
+
+    // Statistics counters to update when a direct access is performed
+    long *cpuReadCnt[256] = {};
+    long *cpuWriteCnt[256] = {};
+
+    /* Dirty page maps. Each memory type is divided into pages of MEM_PAGE_SIZE
+     * bytes. Whenever a page is written to, the corresponding map entry is set
+     * to the current epoch. The maps are utilized by delta snapshots which
+     * only store the pages that have changed since the previous snapshot was
+     * taken. Each delta snapshot chain remembers the epoch it started in and
+     * opens a new one. By comparing epochs instead of clearing the maps,
+     * multiple chains can track changes independently. Memory which is
+     * modified in bulk (e.g., by installing a Rom or by restoring a snapshot)
+     * is marked as dirty as a whole.
+     * See also: DeltaSnapshot
+     */
+    u32 romDirty[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u32 womDirty[KB(256) >> MEM_PAGE_SHIFT] = {};
+    u32 extDirty[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u32 chipDirty[MB(2) >> MEM_PAGE_SHIFT] = {};
+    u32 slowDirty[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u32 fastDirty[MB(8) >> MEM_PAGE_SHIFT] = {};
+    
+    // The current epoch of the dirty page maps
+    u32 dirtyEpoch = 1;
+
+    /* Checksums of all memory pages. When the state is hashed, all pages that
+     * have been modified since the previous run are rehashed. To find these
+     * pages, the checksums remember the epoch opened by the previous run.
+     * See also: _hash()
+     */
+    u64 romHash[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u64 womHash[KB(256) >> MEM_PAGE_SHIFT] = {};
+    u64 extHash[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u64 chipHash[MB(2) >> MEM_PAGE_SHIFT] = {};
+    u64 slowHash[KB(512) >> MEM_PAGE_SHIFT] = {};
+    u64 fastHash[MB(8) >> MEM_PAGE_SHIFT] = {};
+    u32 hashEpoch = 0;
+
+    /* Dirty page pointers for all banks in the direct access tables. For each
+     * bank with a non-null write pointer, the table points to the dirty map
+     * entry of the first page inside this bank.
+     */
+    u32 *cpuWriteDirty[256] = {};
+    u32 *agnusDirty[256] = {};
+
+    /* Indicates if memory contents are part of the serialized state. The flag
+     * is cleared temporarily by delta snapshots to serialize the state of all
+     * components without the (large) memory blocks which are handled
+     * separately on a per-page basis.
+     */
+    bool serializeContents = true;
+
     // The last value on the data bus
     u16 dataBus;
 
@@ -266,6 +371,7 @@ private:
     isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
     isize didLoadFromBuffer(const u8 *buffer) override;
     isize didSaveToBuffer(u8 *buffer) const override;
+    u64 _hash() override;
 
     
     //
@@ -288,6 +394,9 @@ private:
      */
     bool alloc(i32 bytes, u8 *&ptr, i32 &size, u32 &mask);
 
+    // Frees a memory block, regardless of how it has been allocated
+    void release(u8 *&ptr);
+
 public:
 
     bool allocChip(i32 bytes) { return alloc(bytes, chip, config.chipSize, chipMask); }
@@ -306,6 +415,38 @@ public:
     void deleteWom() { allocWom(0); }
     void deleteExt() { allocExt(0); }
 
+    /* Installs the memory contents from a file. The memory blocks are stored
+     * back to back in the order Rom, Wom, Ext, Chip, Slow, Fast, starting at
+     * the specified offset. Each block is mapped copy-on-write. Hence, a page
+     * is not read before it is accessed and not copied before it is modified.
+     * Blocks that don't start at a page boundary are read from the file. The
+     * function expects the memory layout to be set up already. It is utilized
+     * to restore snapshots with the memory stored in a raw section. Pages that
+     * have not been modified are backed by the file as long as the memory
+     * exists. Hence, the file must not be modified in place afterwards. It
+     * can only be replaced by renaming another file over it.
+     * See also: MappedSnapshot
+     */
+    void mapContents(int fd, isize offset, isize count) throws;
+
+    /* Shares the memory contents of another memory copy-on-write. The memory
+     * blocks of the other memory are frozen, i.e., written into anonymous
+     * files which are mapped by both memories. A block is only frozen again
+     * if a larger part of it has been modified since it was frozen the last
+     * time. Otherwise, the modified pages are copied. The function expects
+     * both memories to have the same layout. It is utilized by Amiga::fork().
+     */
+    void cloneContents(Memory &other);
+
+private:
+
+    /* Freezes a memory block if needed. The function returns the mapping
+     * information or nullptr if the block could not be frozen.
+     */
+    const MappedBlock *freeze(u8 *&ptr, isize size, const u32 *dirty);
+
+public:
+
 
     //
     // Managing RAM
@@ -324,6 +465,15 @@ public:
     isize fastRamSize() const { return config.fastSize; }
     isize ramSize() const { return config.chipSize + config.slowSize + config.fastSize; }
 
+    // Marks all pages of all memory types as modified in the current epoch
+    void markAllPagesDirty();
+    
+    // Starts a new epoch and returns the epoch number
+    u32 nextDirtyEpoch() { return ++dirtyEpoch; }
+
+    // Collects the host memory and dirty page maps of all memory types
+    void getDirtyRegions(DirtyRegion (&regions)[MEM_REGION_COUNT]);
+
 private:
     
     void fillRamWithInitPattern();
@@ -360,9 +510,9 @@ public:
     bool hasExt() { return ext != nullptr; }
 
     // Erases an installed Rom
-    void eraseRom() { memset(rom, 0, config.romSize); }
-    void eraseWom() { memset(wom, 0, config.womSize); }
-    void eraseExt() { memset(ext, 0, config.extSize); }
+    void eraseRom() { memset(rom, 0, config.romSize); markAllPagesDirty(); }
+    void eraseWom() { memset(wom, 0, config.womSize); markAllPagesDirty(); }
+    void eraseExt() { memset(ext, 0, config.extSize); markAllPagesDirty(); }
     
     // Installs a Boot Rom or Kickstart Rom
     void loadRom(class RomFile *rom) throws;
@@ -412,6 +562,9 @@ private:
     void updateCpuMemSrcTable();
     void updateAgnusMemSrcTable();
 
+    // Updates the direct access tables
+    void updateMemPtrTables();
+
     
     //
     // Accessing memory
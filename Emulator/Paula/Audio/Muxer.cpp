@@ -13,10 +13,25 @@
 #include "IO.h"
 #include "MsgQueue.h"
 #include "Oscillator.h"
+#include "Profiler.h"
 #include <cmath>
 
 Muxer::Muxer(Amiga& ref) : AmigaComponent(ref)
 {
+    config.samplingMethod = SMP_NONE;
+    config.filterType = FILTER_BUTTERWORTH;
+    config.filterAlwaysOn = false;
+    config.volL = 50;
+    config.volR = 50;
+    volL = 1.0;
+    volR = 1.0;
+    for (isize i = 0; i < 4; i++) {
+        config.vol[i] = 100;
+        config.pan[i] = 0;
+        vol[i] = 1.0;
+        pan[i] = 0.5;
+    }
+    
     subComponents = std::vector<HardwareComponent *> {
 
         &filterL,
@@ -331,6 +346,8 @@ Muxer::synthesize(Cycle clock, Cycle target)
 template <SamplingMethod method> void
 Muxer::synthesize(Cycle clock, long count, double cyclesPerSample)
 {
+    PROFILE(PROF_SYNTHESIZE);
+
     assert(count > 0);
 
     stream.lock();
@@ -54,7 +54,7 @@ class Muxer : public AmigaComponent {
     double cyclesPerSample = 0;
 
     // Fraction of a sample that hadn't been generated in synthesize
-    double fraction;
+    double fraction = 0;
 
     // Time stamp of the last write pointer alignment
     util::Time lastAlignment;
@@ -12,6 +12,7 @@
 #include "Agnus.h"
 #include "DiskFile.h"
 #include "Drive.h"
+#include "InputRecorder.h"
 #include "MsgQueue.h"
 #include "Paula.h"
 #include <algorithm>
@@ -282,8 +283,10 @@ DiskController::ejectDisk(isize nr, Cycle delay)
 {
     assert(nr >= 0 && nr <= 3);
 
+    inputRecorder.recordDiskEject(nr, delay);
+
     suspend();
-    agnus.scheduleRel<SLOT_DCH>(delay, DCH_EJECT, nr);
+    scheduleDiskEject(nr, delay);
     resume();
 }
 
@@ -295,17 +298,31 @@ DiskController::insertDisk(class Disk *disk, isize nr, Cycle delay)
 
     debug(DSK_DEBUG, "insertDisk(%p, %zd, %lld)\n", disk, nr, delay);
 
+    inputRecorder.recordDiskInsert(disk, nr, delay);
+
     // The easy case: The emulator is not running
     if (!isRunning()) {
 
-        df[nr]->ejectDisk();
-        df[nr]->insertDisk(disk);
+        insertDiskNow(disk, nr);
         return;
     }
 
     // The not so easy case: The emulator is running
     suspend();
+    scheduleDiskInsert(disk, nr, delay);
+    resume();
+}
+
+void
+DiskController::insertDiskNow(class Disk *disk, isize nr)
+{
+    df[nr]->ejectDisk();
+    df[nr]->insertDisk(disk);
+}
 
+void
+DiskController::scheduleDiskInsert(class Disk *disk, isize nr, Cycle delay)
+{
     if (df[nr]->hasDisk()) {
 
         // Eject the old disk first
@@ -318,8 +335,12 @@ DiskController::insertDisk(class Disk *disk, isize nr, Cycle delay)
 
     diskToInsert = disk;
     agnus.scheduleRel<SLOT_DCH>(delay, DCH_INSERT, nr);
-    
-    resume();
+}
+
+void
+DiskController::scheduleDiskEject(isize nr, Cycle delay)
+{
+    agnus.scheduleRel<SLOT_DCH>(delay, DCH_EJECT, nr);
 }
 
 void
@@ -16,6 +16,7 @@
 class DiskController : public AmigaComponent {
 
     friend class Drive;
+    friend class InputRecorder;
     
     // Current configuration
     DiskControllerConfig config;
@@ -257,6 +258,20 @@ public:
     // Write protects or unprotects a disk
     void setWriteProtection(isize nr, bool value);
 
+private:
+
+    /* The following functions do the actual work of ejectDisk() and
+     * insertDisk(). They neither suspend the emulator nor inform the input
+     * recorder. The input recorder calls them to replay recorded disk changes.
+     */
+
+    // Inserts a disk right away (the emulator must not be running)
+    void insertDiskNow(class Disk *disk, isize nr);
+
+    // Schedules the insertion or ejection of a disk
+    void scheduleDiskInsert(class Disk *disk, isize nr, Cycle delay);
+    void scheduleDiskEject(isize nr, Cycle delay);
+
         
     //
     // Serving events
@@ -12,6 +12,7 @@
 #include "Agnus.h"
 #include "CPU.h"
 #include "IO.h"
+#include "RunAhead.h"
 
 Paula::Paula(Amiga& ref) : AmigaComponent(ref)
 {
@@ -121,7 +122,8 @@ Paula::_warpOff()
 void
 Paula::executeUntil(Cycle target)
 {
-    muxer.synthesize(audioClock, target);
+    // Speculative frames remain silent (see RunAhead)
+    if (!runAhead.isActive()) muxer.synthesize(audioClock, target);
     audioClock = target;
 }
 
@@ -11,6 +11,7 @@
 #include "Joystick.h"
 #include "Agnus.h"
 #include "ControlPort.h"
+#include "InputRecorder.h"
 #include "IO.h"
 
 const char *
@@ -123,6 +124,8 @@ Joystick::trigger(GamePadAction event)
 
     debug(PORT_DEBUG, "trigger(%lld)\n", event);
      
+    inputRecorder.recordJoystick(port.nr, event);
+
     switch (event) {
             
         case PULL_UP:    axisY = -1; break;
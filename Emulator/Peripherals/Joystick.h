@@ -14,6 +14,8 @@
 
 class Joystick : public AmigaComponent {
 
+    friend class RunAhead;
+
     // Reference to control port this device belongs to
     ControlPort &port;
 
@@ -11,6 +11,7 @@
 #include "Keyboard.h"
 #include "Agnus.h"
 #include "CIA.h"
+#include "InputRecorder.h"
 #include "IO.h"
 #include "MsgQueue.h"
 
@@ -105,6 +106,7 @@ Keyboard::pressKey(long keycode)
 
         trace(KBD_DEBUG, "Pressing Amiga key %02lX\n", keycode);
 
+        inputRecorder.recordKey(keycode, true);
         keyDown[keycode] = true;
         writeToBuffer(keycode);
         
@@ -124,6 +126,7 @@ Keyboard::releaseKey(long keycode)
 
         trace(KBD_DEBUG, "Releasing Amiga key %02lX\n", keycode);
 
+        inputRecorder.recordKey(keycode, false);
         keyDown[keycode] = false;
         writeToBuffer(keycode | 0x80);
     }
@@ -11,6 +11,7 @@
 #include "Mouse.h"
 #include "Chrono.h"
 #include "ControlPort.h"
+#include "InputRecorder.h"
 #include "IO.h"
 #include "MsgQueue.h"
 #include "Oscillator.h"
@@ -192,6 +193,8 @@ Mouse::getXY()
 void
 Mouse::setXY(double x, double y)
 {
+    inputRecorder.recordMouseXY(port.nr, x, y);
+
     // Check for a shaking mouse
     if (config.shakeDetection && shakeDetector.isShakingAbs(x)) {
         messageQueue.put(MSG_SHAKING);
@@ -206,6 +209,8 @@ Mouse::setXY(double x, double y)
 void
 Mouse::setDeltaXY(double dx, double dy)
 {
+    inputRecorder.recordMouseDelta(port.nr, dx, dy);
+
     // Check for a shaking mouse
     if (shakeDetector.isShakingRel(dx)) messageQueue.put(MSG_SHAKING);
 
@@ -220,6 +225,7 @@ Mouse::setLeftButton(bool value)
 {
     trace(PORT_DEBUG, "setLeftButton(%d)\n", value);
     
+    inputRecorder.recordMouseButton(port.nr, true, value);
     leftButton = value;
     port.device = CPD_MOUSE;
 }
@@ -229,6 +235,7 @@ Mouse::setRightButton(bool value)
 {
     trace(PORT_DEBUG, "setRightButton(%d)\n", value);
     
+    inputRecorder.recordMouseButton(port.nr, false, value);
     rightButton = value;
     port.device = CPD_MOUSE;
 }
@@ -41,6 +41,8 @@ public:
 
 class Mouse : public AmigaComponent {
 
+    friend class RunAhead;
+
     // Reference to the control port this device belongs to
     ControlPort &port;
     
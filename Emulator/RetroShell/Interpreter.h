@@ -22,24 +22,27 @@ enum class Token
     none,
     
     // Components
-    agnus, amiga, audio, blitter, cia, controlport, copper, cpu, denise, dfn,
-    dc, keyboard, memory, monitor, mouse, paula, serial, rtc,
+    agnus, amiga, audio, blitter, bootcache, cia, controlport, copper, cpu,
+    denise, dfn, dc, keyboard, memory, monitor, mouse, paula, profile, recorder,
+    rewind, rtc, runahead, serial, tracer,
 
     // Commands
     about, audiate, autosync, clear, config, connect, disconnect, dsksync,
-    easteregg, eject, close, insert, inspect, list, load, lock, on, off, pause,
-    reset, run, set, source,
+    easteregg, eject, close, insert, inspect, jump, list, load, lock, on, off,
+    pause, record, replay, report, reset, run, save, set, source, start, stop,
     
     // Categories
     checksums, devices, events, registers, state,
     
     // Keys
-    accuracy, bankmap, brightness, chip, clxsprspr, clxsprplf, clxplfplf,
-    contrast, defaultbb, defaultfs, device, esync, extrom, extstart, fast,
-    filter, joystick, keyset, mechanics, model, palette, pan, poll, pullup,
-    raminitpattern, revision, rom, sampling, saturation, searchpath,
-    shakedetector, slow, slowramdelay, slowrammirror, speed, step, tod, todbug,
-    unmappingtype, velocity, volume, wom
+    accuracy, bankmap, brightness, budget, chip, clxsprspr, clxsprplf,
+    clxplfplf, contrast, defaultbb, defaultfs, device, directory, duration,
+    enable, esync,
+    extrom, extstart, fast, filter, frames, interval, joystick, keyset,
+    mechanics, model, palette, pan, poll, pullup, raminitpattern, revision, rom,
+    sampling, saturation, searchpath, shakedetector, slow, slowramdelay,
+    slowrammirror, speed, step, tod, todbug, unmappingtype, velocity, volume,
+    wom
 };
 
 struct TooFewArgumentsError : public util::ParseError {
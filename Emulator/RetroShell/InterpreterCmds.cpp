@@ -75,6 +75,10 @@ Interpreter::registerInstructions()
              "command", "Displays the component state",
              &RetroShell::exec <Token::amiga, Token::inspect>);
 
+    root.add({"amiga", "checksums"},
+             "command", "Computes checksums of the component states",
+             &RetroShell::exec <Token::amiga, Token::checksums>);
+
     
     //
     // Memory
@@ -732,4 +736,173 @@ Interpreter::registerInstructions()
     root.add({"df0", "df1", "df2", "df3", "dfn"}, {"", "inspect"},
              "command", "Displays the internal state",
              &RetroShell::exec <Token::dfn, Token::inspect>);
+
+    
+    //
+    // Rewind buffer
+    //
+
+    root.add({"rewind"},
+             "component", "Rewind buffer");
+
+    root.add({"rewind", "config"},
+             "command", "Displays the current configuration",
+             &RetroShell::exec <Token::rewind, Token::config>);
+
+    root.add({"rewind", "set"},
+             "command", "Configures the component");
+
+    root.add({"rewind", "set", "enable"},
+             "key", "Enables or disables the recording of checkpoints",
+             &RetroShell::exec <Token::rewind, Token::set, Token::enable>, 1);
+
+    root.add({"rewind", "set", "interval"},
+             "key", "Sets the number of frames between two checkpoints",
+             &RetroShell::exec <Token::rewind, Token::set, Token::interval>, 1);
+
+    root.add({"rewind", "set", "duration"},
+             "key", "Sets the number of seconds covered by the history",
+             &RetroShell::exec <Token::rewind, Token::set, Token::duration>, 1);
+
+    root.add({"rewind", "set", "budget"},
+             "key", "Sets the maximum memory usage in MB",
+             &RetroShell::exec <Token::rewind, Token::set, Token::budget>, 1);
+
+    root.add({"rewind", "jump"},
+             "command", "Travels back in time by the given number of seconds",
+             &RetroShell::exec <Token::rewind, Token::jump>, 1);
+
+    root.add({"rewind", "clear"},
+             "command", "Deletes all checkpoints",
+             &RetroShell::exec <Token::rewind, Token::clear>);
+
+    root.add({"rewind", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::rewind, Token::inspect>);
+
+    
+    //
+    // Run-ahead
+    //
+
+    root.add({"runahead"},
+             "component", "Run-ahead latency reduction");
+
+    root.add({"runahead", "config"},
+             "command", "Displays the current configuration",
+             &RetroShell::exec <Token::runahead, Token::config>);
+
+    root.add({"runahead", "set"},
+             "command", "Configures the component");
+
+    root.add({"runahead", "set", "frames"},
+             "key", "Sets the number of frames to run ahead (0 = off)",
+             &RetroShell::exec <Token::runahead, Token::set, Token::frames>, 1);
+
+    root.add({"runahead", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::runahead, Token::inspect>);
+
+    
+    //
+    // Boot cache
+    //
+
+    root.add({"bootcache"},
+             "component", "Cache for post-boot states");
+
+    root.add({"bootcache", "config"},
+             "command", "Displays the current configuration",
+             &RetroShell::exec <Token::bootcache, Token::config>);
+
+    root.add({"bootcache", "set"},
+             "command", "Configures the component");
+
+    root.add({"bootcache", "set", "frames"},
+             "key", "Sets the number of frames to emulate before caching (0 = off)",
+             &RetroShell::exec <Token::bootcache, Token::set, Token::frames>, 1);
+
+    root.add({"bootcache", "set", "directory"},
+             "key", "Sets the directory where cached states are stored",
+             &RetroShell::exec <Token::bootcache, Token::set, Token::directory>, 1);
+
+    root.add({"bootcache", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::bootcache, Token::inspect>);
+
+
+    //
+    // Input recorder
+    //
+
+    root.add({"recorder"},
+             "component", "Input recorder");
+
+    root.add({"recorder", "record"},
+             "command", "Starts recording all input",
+             &RetroShell::exec <Token::recorder, Token::record>);
+
+    root.add({"recorder", "replay"},
+             "command", "Replays the recorded input",
+             &RetroShell::exec <Token::recorder, Token::replay>);
+
+    root.add({"recorder", "stop"},
+             "command", "Stops recording or replaying",
+             &RetroShell::exec <Token::recorder, Token::stop>);
+
+    root.add({"recorder", "save"},
+             "command", "Writes the recorded input into a file",
+             &RetroShell::exec <Token::recorder, Token::save>, 1);
+
+    root.add({"recorder", "load"},
+             "command", "Reads recorded input from a file",
+             &RetroShell::exec <Token::recorder, Token::load>, 1);
+
+    root.add({"recorder", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::recorder, Token::inspect>);
+
+
+    //
+    // Profiler
+    //
+
+    root.add({"profile"},
+             "component", "Host time profiler");
+
+    root.add({"profile", "start"},
+             "command", "Starts collecting data",
+             &RetroShell::exec <Token::profile, Token::start>);
+
+    root.add({"profile", "stop"},
+             "command", "Stops collecting data",
+             &RetroShell::exec <Token::profile, Token::stop>);
+
+    root.add({"profile", "clear"},
+             "command", "Discards all collected data",
+             &RetroShell::exec <Token::profile, Token::clear>);
+
+    root.add({"profile", "report"},
+             "command", "Displays the host time spent in each section",
+             &RetroShell::exec <Token::profile, Token::report>);
+
+
+    //
+    // Event tracer
+    //
+
+    root.add({"tracer"},
+             "component", "Binary event tracer");
+
+    root.add({"tracer", "start"},
+             "command", "Starts writing a Chrome trace file",
+             &RetroShell::exec <Token::tracer, Token::start>, 1);
+
+    root.add({"tracer", "stop"},
+             "command", "Stops tracing and closes the trace file",
+             &RetroShell::exec <Token::tracer, Token::stop>);
+
+    root.add({"tracer", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::tracer, Token::inspect>);
 }
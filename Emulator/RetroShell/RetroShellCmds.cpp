@@ -97,6 +97,21 @@ RetroShell::exec <Token::amiga, Token::inspect> (Arguments &argv, long param)
     dump(amiga, Dump::State);
 }
 
+template <> void
+RetroShell::exec <Token::amiga, Token::checksums> (Arguments &argv, long param)
+{
+    std::stringstream ss; string line;
+
+    amiga.suspend();
+    for (HardwareComponent *c : amiga.subComponents) {
+        ss << DUMP(c->getDescription()) << HEX64 << c->hash() << std::endl;
+    }
+    ss << DUMP("Amiga") << HEX64 << amiga.hash() << std::endl;
+    amiga.resume();
+
+    while(std::getline(ss, line)) *this << line << '\n';
+}
+
 //
 // Memory
 //
@@ -847,3 +862,208 @@ RetroShell::exec <Token::dfn, Token::inspect> (Arguments& argv, long param)
 {
     dump(*amiga.df[param], Dump::State);
 }
+
+//
+// Rewind buffer
+//
+
+template <> void
+RetroShell::exec <Token::rewind, Token::config> (Arguments& argv, long param)
+{
+    dump(amiga.rewindBuffer, Dump::Config);
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::enable> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_REWIND, util::parseBool(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::interval> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_REWIND_INTERVAL, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::duration> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_REWIND_DURATION, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::budget> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_REWIND_BUDGET, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::jump> (Arguments &argv, long param)
+{
+    if (!amiga.rewind(util::parseNum(argv.front()))) {
+        retroShell << "The history does not reach back that far." << '\n';
+    }
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::clear> (Arguments& argv, long param)
+{
+    amiga.rewindBuffer.clear();
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.rewindBuffer, Dump::State);
+}
+
+//
+// Run-ahead
+//
+
+template <> void
+RetroShell::exec <Token::runahead, Token::config> (Arguments& argv, long param)
+{
+    dump(amiga.runAhead, Dump::Config);
+}
+
+template <> void
+RetroShell::exec <Token::runahead, Token::set, Token::frames> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_RUN_AHEAD, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::runahead, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.runAhead, Dump::State);
+}
+
+//
+// Boot cache
+//
+
+template <> void
+RetroShell::exec <Token::bootcache, Token::config> (Arguments& argv, long param)
+{
+    dump(amiga.bootCache, Dump::Config);
+}
+
+template <> void
+RetroShell::exec <Token::bootcache, Token::set, Token::frames> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_BOOT_CACHE, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::bootcache, Token::set, Token::directory> (Arguments &argv, long param)
+{
+    amiga.bootCache.setDirectory(argv.front());
+}
+
+template <> void
+RetroShell::exec <Token::bootcache, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.bootCache, Dump::State);
+}
+
+//
+// Input recorder
+//
+
+template <> void
+RetroShell::exec <Token::recorder, Token::record> (Arguments& argv, long param)
+{
+    amiga.inputRecorder.startRecording();
+}
+
+template <> void
+RetroShell::exec <Token::recorder, Token::replay> (Arguments& argv, long param)
+{
+    amiga.inputRecorder.startReplay();
+}
+
+template <> void
+RetroShell::exec <Token::recorder, Token::stop> (Arguments& argv, long param)
+{
+    amiga.inputRecorder.stop();
+}
+
+template <> void
+RetroShell::exec <Token::recorder, Token::save> (Arguments& argv, long param)
+{
+    amiga.inputRecorder.saveToFile(argv.front());
+}
+
+template <> void
+RetroShell::exec <Token::recorder, Token::load> (Arguments& argv, long param)
+{
+    auto path = argv.front();
+    if (!util::fileExists(path)) throw ConfigFileNotFoundError(path);
+
+    amiga.inputRecorder.loadFromFile(path);
+}
+
+template <> void
+RetroShell::exec <Token::recorder, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.inputRecorder, Dump::State);
+}
+
+//
+// Profiler
+//
+
+template <> void
+RetroShell::exec <Token::profile, Token::start> (Arguments& argv, long param)
+{
+    if (Profiler::isAvailable()) {
+        amiga.profiler.start();
+    } else {
+        *this << "The profiler is not compiled in. Define PROFILER in config.h." << '\n';
+    }
+}
+
+template <> void
+RetroShell::exec <Token::profile, Token::stop> (Arguments& argv, long param)
+{
+    amiga.profiler.stop();
+}
+
+template <> void
+RetroShell::exec <Token::profile, Token::clear> (Arguments& argv, long param)
+{
+    amiga.profiler.clear();
+}
+
+template <> void
+RetroShell::exec <Token::profile, Token::report> (Arguments& argv, long param)
+{
+    dump(amiga.profiler, Dump::State);
+}
+
+//
+// Event tracer
+//
+
+template <> void
+RetroShell::exec <Token::tracer, Token::start> (Arguments& argv, long param)
+{
+    if (EventTracer::isAvailable()) {
+        amiga.tracer.start(argv.front());
+    } else {
+        *this << "The event tracer is not compiled in. Define EVENT_TRACER in config.h." << '\n';
+    }
+}
+
+template <> void
+RetroShell::exec <Token::tracer, Token::stop> (Arguments& argv, long param)
+{
+    amiga.tracer.stop();
+}
+
+template <> void
+RetroShell::exec <Token::tracer, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.tracer, Dump::State);
+}
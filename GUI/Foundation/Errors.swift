@@ -53,6 +53,11 @@ class VAError: Error {
         case .SNP_TOO_NEW:
             return "The snapshot was created with a newer version of " +
                 "vAmiga and is incompatible with this release."
+        case .SNP_MISMATCH:
+            return "The delta snapshot does not match the current " +
+                "emulator state."
+        case .SNP_CORRUPTED:
+            return "The snapshot file is corrupted."
         case .UNSUPPORTED_SNAPSHOT:
             return "Unsupported Snapshot Revision."
         case .MISSING_ROM_KEY:
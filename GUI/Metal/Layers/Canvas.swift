@@ -133,7 +133,7 @@ class Canvas: Layer {
         let buffer = amiga.denise.stableBuffer
         
         // Only proceed if the emulator delivers a new texture
-        if prevBuffer?.data == buffer.data { return }
+        if prevBuffer?.nr == buffer.nr { return }
         prevBuffer = buffer
 
         // Determine if the new texture is a long frame or a short frame
@@ -421,6 +421,9 @@
 
 @property (readonly) ScreenBuffer stableBuffer;
 @property (readonly) u32 *noise;
+@property (readonly) NSInteger frameNr;
+- (void)setFrameListener:(const void *)sender function:(FrameCallback *)func;
+- (void)removeFrameListener;
 
 @end
 
@@ -784,6 +784,21 @@ using namespace moira;
     return [self denise]->pixelEngine.getNoise();
 }
 
+- (NSInteger)frameNr
+{
+    return [self denise]->pixelEngine.getFrameNr();
+}
+
+- (void)setFrameListener:(const void *)sender function:(FrameCallback *)func
+{
+    [self denise]->pixelEngine.setFrameListener(sender, func);
+}
+
+- (void)removeFrameListener
+{
+    [self denise]->pixelEngine.removeFrameListener();
+}
+
 @end
 
 
@@ -10,6 +10,8 @@
 #include "Chrono.h"
 #ifdef __MACH__
 #include <mach/mach_time.h>
+#else
+#include <time.h>
 #endif
 
 namespace util {
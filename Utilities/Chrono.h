@@ -11,6 +11,10 @@
 
 #include "Types.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 namespace util {
 
 class Time {
@@ -70,4 +74,17 @@ public:
     Time restart();
 };
 
+/* Reads out a fast, monotonic counter. On x86 hosts, the time stamp counter
+ * is read which has a host dependent tick length. Elsewhere, the function
+ * falls back to the system clock and returns nanoseconds.
+ */
+inline u64 ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (u64)Time::now().asNanoseconds();
+#endif
+}
+
 }
@@ -0,0 +1,329 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Compression.h"
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+// Minimum length of a back reference
+static constexpr isize minMatch = 4;
+
+// The last bytes of a block are always encoded as literals
+static constexpr isize lastLiterals = 5;
+
+// A back reference must not start within the last bytes of a block
+static constexpr isize matchStartLimit = 12;
+
+// Maximum distance of a back reference
+static constexpr isize maxOffset = 65535;
+
+// Size of the hash table used to find back references
+static constexpr isize hashLog = 12;
+
+static inline u32
+read32(const u8 *p)
+{
+    u32 result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static inline isize
+be32(const u8 *p)
+{
+    return (isize)((u32)p[0] << 24 | (u32)p[1] << 16 | (u32)p[2] << 8 | (u32)p[3]);
+}
+
+static inline u32
+hash(u32 sequence)
+{
+    return (sequence * 2654435761U) >> (32 - hashLog);
+}
+
+static inline u8 *
+writeLength(u8 *op, isize length)
+{
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (u8)length;
+    return op;
+}
+
+isize
+compressLZ4(const u8 *src, isize size, u8 *dst)
+{
+    const u8 *ip = src;
+    const u8 *anchor = src;
+    const u8 *end = src + size;
+    u8 *op = dst;
+
+    // Hash table storing the most recent position of a 4-byte sequence
+    u32 table[1 << hashLog] = { };
+
+    if (size >= matchStartLimit) {
+
+        const u8 *matchLimit = end - lastLiterals;
+        const u8 *startLimit = end - matchStartLimit;
+
+        while (ip < startLimit) {
+
+            u32 sequence = read32(ip);
+            u32 h = hash(sequence);
+            const u8 *ref = src + table[h];
+            table[h] = (u32)(ip - src);
+
+            // Skip faster over incompressible data
+            if (ref >= ip || ip - ref > maxOffset || read32(ref) != sequence) {
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend the match backwards
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) { ip--; ref--; }
+
+            // Extend the match forwards
+            const u8 *p = ip + minMatch;
+            const u8 *q = ref + minMatch;
+            while (p < matchLimit && *p == *q) { p++; q++; }
+
+            isize literals = ip - anchor;
+            isize matchLength = (p - ip) - minMatch;
+            isize offset = ip - ref;
+
+            // Write the token
+            u8 *token = op++;
+            *token = (u8)((std::min(literals, (isize)15) << 4) |
+                          std::min(matchLength, (isize)15));
+
+            // Write the literal run
+            if (literals >= 15) op = writeLength(op, literals - 15);
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            // Write the back reference
+            *op++ = (u8)(offset & 0xFF);
+            *op++ = (u8)(offset >> 8);
+            if (matchLength >= 15) op = writeLength(op, matchLength - 15);
+
+            ip = anchor = p;
+        }
+    }
+
+    // Write the remaining bytes as a final literal run
+    isize literals = end - anchor;
+    *op++ = (u8)(std::min(literals, (isize)15) << 4);
+    if (literals >= 15) op = writeLength(op, literals - 15);
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    return op - dst;
+}
+
+isize
+decompressLZ4(const u8 *src, isize size, u8 *dst, isize capacity)
+{
+    const u8 *ip = src;
+    const u8 *iend = src + size;
+    u8 *op = dst;
+    u8 *oend = dst + capacity;
+
+    auto readLength = [&](isize &length) {
+
+        u8 byte;
+        do {
+            if (ip >= iend) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (ip < iend) {
+
+        u8 token = *ip++;
+
+        // Copy the literal run
+        isize literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return -1;
+        if (literals > iend - ip || literals > oend - op) return -1;
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence consists of literals only
+        if (ip == iend) break;
+
+        // Copy the back reference
+        if (iend - ip < 2) return -1;
+        isize offset = ip[0] | ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op - dst) return -1;
+
+        isize matchLength = token & 15;
+        if (matchLength == 15 && !readLength(matchLength)) return -1;
+        matchLength += minMatch;
+        if (matchLength > oend - op) return -1;
+
+        const u8 *ref = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, ref, matchLength);
+        } else {
+            for (isize i = 0; i < matchLength; i++) op[i] = ref[i];
+        }
+        op += matchLength;
+    }
+
+    return op - dst;
+}
+
+
+LZ4Writer::LZ4Writer(std::ostream &stream) : stream(stream)
+{
+    block.resize(blockSize);
+    packed.resize(lz4Bound(blockSize));
+}
+
+void
+LZ4Writer::write(const u8 *src, isize count)
+{
+    while (count > 0) {
+
+        isize chunk = std::min(count, blockSize - fill);
+        memcpy(block.data() + fill, src, chunk);
+        fill += chunk;
+        src += chunk;
+        count -= chunk;
+
+        if (fill == blockSize) flush();
+    }
+}
+
+void
+LZ4Writer::flush()
+{
+    if (fill == 0) return;
+
+    isize packedSize = compressLZ4(block.data(), fill, packed.data());
+    bool stored = packedSize >= fill;
+    if (stored) packedSize = fill;
+
+    u8 header[8] = {
+        (u8)(fill >> 24), (u8)(fill >> 16), (u8)(fill >> 8), (u8)fill,
+        (u8)(packedSize >> 24), (u8)(packedSize >> 16), (u8)(packedSize >> 8), (u8)packedSize
+    };
+    stream.write((const char *)header, sizeof(header));
+    stream.write((const char *)(stored ? block.data() : packed.data()), packedSize);
+
+    written += isizeof(header) + packedSize;
+    fill = 0;
+}
+
+LZ4Reader::LZ4Reader(std::istream &stream) : stream(stream)
+{
+}
+
+bool
+LZ4Reader::read(u8 *dst, isize count)
+{
+    while (count > 0) {
+
+        // Serve the request from the current block if possible
+        if (pos < fill) {
+
+            isize chunk = std::min(count, fill - pos);
+            memcpy(dst, block.data() + pos, chunk);
+            pos += chunk;
+            dst += chunk;
+            count -= chunk;
+            continue;
+        }
+
+        isize rawSize, packedSize;
+        if (!readBlockHeader(rawSize, packedSize)) return false;
+
+        // Decompress directly into the target buffer if the block fits in
+        if (rawSize <= count) {
+
+            if (!readBlock(dst, rawSize, packedSize)) return false;
+            dst += rawSize;
+            count -= rawSize;
+            continue;
+        }
+
+        // Otherwise, keep the block to serve subsequent requests
+        block.resize(LZ4Writer::blockSize);
+        if (!readBlock(block.data(), rawSize, packedSize)) return false;
+        pos = 0;
+        fill = rawSize;
+    }
+
+    return true;
+}
+
+bool
+LZ4Reader::readBlockHeader(isize &rawSize, isize &packedSize)
+{
+    u8 header[8];
+    if (!stream.read((char *)header, sizeof(header))) return false;
+
+    rawSize = be32(header);
+    packedSize = be32(header + 4);
+
+    if (rawSize == 0 || rawSize > LZ4Writer::blockSize) return false;
+    if (packedSize == 0 || packedSize > lz4Bound(rawSize)) return false;
+
+    return true;
+}
+
+bool
+LZ4Reader::readBlock(u8 *dst, isize rawSize, isize packedSize)
+{
+    // Stored blocks are copied as they are
+    if (packedSize == rawSize) {
+        return (bool)stream.read((char *)dst, rawSize);
+    }
+
+    packed.resize(lz4Bound(LZ4Writer::blockSize));
+    if (!stream.read((char *)packed.data(), packedSize)) return false;
+
+    return decompressLZ4(packed.data(), packedSize, dst, rawSize) == rawSize;
+}
+
+isize
+decompressBlocks(const u8 *src, isize size, u8 *dst, isize capacity)
+{
+    const u8 *ip = src;
+    const u8 *iend = src + size;
+    u8 *op = dst;
+    u8 *oend = dst + capacity;
+
+    while (ip < iend) {
+
+        if (iend - ip < 8) return -1;
+        isize rawSize = be32(ip);
+        isize packedSize = be32(ip + 4);
+        ip += 8;
+
+        if (rawSize == 0 || rawSize > oend - op) return -1;
+        if (packedSize == 0 || packedSize > iend - ip) return -1;
+
+        if (packedSize == rawSize) {
+            memcpy(op, ip, rawSize);
+        } else if (decompressLZ4(ip, packedSize, op, rawSize) != rawSize) {
+            return -1;
+        }
+        ip += packedSize;
+        op += rawSize;
+    }
+
+    return op - dst;
+}
+
+}
@@ -0,0 +1,124 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace util {
+
+/* This file provides a fast, dictionary-free LZ77 compressor. The encoded
+ * data adheres to the LZ4 block format, i.e., it consists of a sequence of
+ * literal runs and back references into a 64 KB window. The compressor
+ * trades compression ratio for speed, which makes it suitable for compressing
+ * emulator states on the fly.
+ */
+
+// Returns the maximum size of the compressed data for a given input size
+inline isize lz4Bound(isize size) { return size + size / 255 + 16; }
+
+/* Compresses a buffer. The target buffer must provide at least lz4Bound(size)
+ * bytes. The function returns the number of bytes written.
+ */
+isize compressLZ4(const u8 *src, isize size, u8 *dst);
+
+/* Decompresses a buffer. The function returns the number of bytes written or
+ * -1 if the compressed data is corrupt or doesn't fit into the target buffer.
+ */
+isize decompressLZ4(const u8 *src, isize size, u8 *dst, isize capacity);
+
+
+/* The following two classes compress and decompress data streams on the fly.
+ * The data is split into blocks which are compressed independently. Each
+ * block is preceded by its uncompressed and its compressed size, stored as
+ * 32-bit big-endian values. Blocks that don't shrink are stored as they are,
+ * which is indicated by equal sizes. Because both classes operate on a single
+ * block at a time, their memory footprint is independent of the stream size.
+ */
+class LZ4Writer {
+
+public:
+
+    // Maximum number of uncompressed bytes in a block
+    static constexpr isize blockSize = 65536;
+
+private:
+
+    // The stream the compressed blocks are written to
+    std::ostream &stream;
+
+    // The block that is currently filled
+    std::vector<u8> block;
+    isize fill = 0;
+
+    // Staging area for a compressed block
+    std::vector<u8> packed;
+
+    // Number of bytes written to the stream so far
+    isize written = 0;
+
+public:
+
+    LZ4Writer(std::ostream &stream);
+
+    // Appends data to the stream
+    void write(const u8 *src, isize count);
+
+    // Terminates the current block
+    void flush();
+
+    // Returns the number of bytes written to the stream so far
+    isize bytesWritten() const { return written; }
+};
+
+class LZ4Reader {
+
+    // The stream the compressed blocks are read from
+    std::istream &stream;
+
+    // The most recently decompressed block, if it hasn't been fully consumed
+    std::vector<u8> block;
+    isize pos = 0;
+    isize fill = 0;
+
+    // Staging area for a compressed block
+    std::vector<u8> packed;
+
+public:
+
+    LZ4Reader(std::istream &stream);
+
+    /* Reads data from the stream. Blocks that are consumed entirely are
+     * decompressed directly into the target buffer. The function returns
+     * false if the stream ends prematurely or the data is corrupt.
+     */
+    bool read(u8 *dst, isize count);
+
+    // Discards the remainder of the current block
+    void skipBlock() { pos = fill = 0; }
+
+private:
+
+    // Reads the size information of the next block
+    bool readBlockHeader(isize &rawSize, isize &packedSize);
+
+    // Reads and decompresses the next block into the provided buffer
+    bool readBlock(u8 *dst, isize rawSize, isize packedSize);
+};
+
+/* Decompresses a sequence of blocks as written by LZ4Writer from memory. The
+ * function returns the number of bytes written or -1 if the data is corrupt or
+ * doesn't fit into the target buffer.
+ */
+isize decompressBlocks(const u8 *src, isize size, u8 *dst, isize capacity);
+
+}
@@ -57,4 +57,53 @@ ReentrantMutex::unlock()
     return pthread_mutex_unlock(&mutex);
 }
 
+Wakeable::Wakeable()
+{
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&cond, nullptr);
+}
+
+Wakeable::~Wakeable()
+{
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+}
+
+void
+Wakeable::waitForWakeUp(Time timeout)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    i64 nsec = ts.tv_nsec + timeout.asNanoseconds();
+    ts.tv_sec += nsec / 1000000000;
+    ts.tv_nsec = nsec % 1000000000;
+
+    pthread_mutex_lock(&mutex);
+    while (!ready) {
+        if (pthread_cond_timedwait(&cond, &mutex, &ts)) break;
+    }
+    ready = false;
+    pthread_mutex_unlock(&mutex);
+}
+
+void
+Wakeable::wakeUp()
+{
+    pthread_mutex_lock(&mutex);
+    ready = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+bool
+Wakeable::tryWakeUp()
+{
+    if (pthread_mutex_trylock(&mutex)) return false;
+    ready = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+    return true;
+}
+
 }
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "Chrono.h"
 #include <pthread.h>
 
 namespace util {
@@ -51,4 +52,28 @@ public:
     ~AutoMutex() { mutex.unlock(); }
 };
 
+/* Lets a thread sleep until another thread wakes it up. A wake-up request is
+ * remembered if no thread is waiting, i.e., it is never lost.
+ */
+class Wakeable
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool ready = false;
+
+public:
+
+    Wakeable();
+    ~Wakeable();
+
+    // Blocks until wakeUp() is called or the timeout has expired
+    void waitForWakeUp(Time timeout);
+
+    // Wakes up the waiting thread
+    void wakeUp();
+
+    // Like wakeUp(), but gives up instead of blocking if the mutex is taken
+    bool tryWakeUp();
+};
+
 }
@@ -8,6 +8,9 @@
 // -----------------------------------------------------------------------------
 
 #include "IO.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <vector>
 
 namespace util {
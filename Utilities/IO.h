@@ -15,6 +15,7 @@
 #include <istream>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <vector>
 
 namespace util {
 
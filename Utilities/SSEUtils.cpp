@@ -8,50 +8,640 @@
 // -----------------------------------------------------------------------------
 
 #include "SSEUtils.h"
+#include <cassert>
+#include <cstring>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define SIMD_X86
+#include <x86intrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
 
 namespace util {
 
-#if (defined(__i386__) || defined(__x86_64__)) && defined(__MACH__)
+void transposeScalar(const u16 *source, u8 *target)
+{
+    u32 mask = 0x8000;
+    for (isize i = 0; i < 16; i++, mask >>= 1) {
 
-#include <x86intrin.h>
+        target[i] =
+        (!!(source[0] & mask) << 0) |
+        (!!(source[1] & mask) << 1) |
+        (!!(source[2] & mask) << 2) |
+        (!!(source[3] & mask) << 3) |
+        (!!(source[4] & mask) << 4) |
+        (!!(source[5] & mask) << 5) |
+        (!!(source[6] & mask) << 6) |
+        (!!(source[7] & mask) << 7);
+    }
+}
+
+void transposeBlockScalar(const u16 *source, isize count, u8 mask, bool doubled, u8 *target)
+{
+    u8 columns[16];
+
+    for (isize i = 0; i < count; i++, source += 8) {
+
+        transposeScalar(source, columns);
+
+        for (isize j = 0; j < 16; j++) {
+
+            *target++ = columns[j] & mask;
+            if (doubled) *target++ = columns[j] & mask;
+        }
+    }
+}
+
+
+void lookup8Scalar(const u32 *table, isize size, const u8 *source, u32 *target, isize count)
+{
+    for (isize i = 0; i < count; i++) {
+
+        assert(source[i] < size);
+        target[i] = table[source[i]];
+    }
+}
+
+void lookup16Scalar(const u32 *table, const u16 *source, u32 *target, isize count)
+{
+    for (isize i = 0; i < count; i++) {
+        target[i] = table[source[i]];
+    }
+}
+
+u16 decodeHAMScalar(const u8 *bpl, const u8 *index, const u16 *colreg,
+                    u16 *target, isize count, u16 hold)
+{
+    for (isize i = 0; i < count; i++) {
+
+        switch ((bpl[i] >> 4) & 0b11) {
+
+            case 0b00: // Get color from register
+
+                hold = colreg[index[i]];
+                break;
+
+            case 0b01: // Modify blue
+
+                hold &= 0xFF0;
+                hold |= (index[i] & 0b1111);
+                break;
+
+            case 0b10: // Modify red
+
+                hold &= 0x0FF;
+                hold |= (index[i] & 0b1111) << 8;
+                break;
+
+            case 0b11: // Modify green
+
+                hold &= 0xF0F;
+                hold |= (index[i] & 0b1111) << 4;
+                break;
+        }
+
+        target[i] = hold;
+    }
+
+    return hold;
+}
+
+/* The vectorized HAM decoders process 16 pixels at a time. Each color channel
+ * is handled separately, one nibble per lane. At first, the value and a write
+ * flag is determined for each pixel. A pixel writes a channel if it loads a
+ * color register or modifies this particular channel. Afterwards, the values
+ * are propagated to all subsequent pixels not writing the channel. This is
+ * done with a parallel prefix scan in four steps, shifting by 1, 2, 4, and 8
+ * lanes. Lanes before the first writing pixel receive the hold value.
+ */
+#ifdef SIMD_X86
+
+/* Splits the matrix rows into bytes. We receive the rows in little endian
+ * format
+ *
+ *     0.lo 0.hi 1.lo 1.hi 2.lo 2.hi 3.lo 3.hi  ........  7.lo 7.hi
+ *
+ * and rearrange the byte order to
+ *
+ *     0.hi 1.hi 2.hi 3.hi ...  7.hi 0.lo 1.lo 2.lo 3.lo  ...  7.lo
+ *
+ * Afterwards, the most significant bits of all bytes form the column values of
+ * column 0 and column 8. Shifting by one bit exposes the next two columns.
+ */
+__attribute__((target("sse2"))) static inline __m128i
+splitRows(const u16 *source)
+{
+    __m128i rows = _mm_load_si128((const __m128i *)source);
+    __m128i hi = _mm_srli_epi16(rows, 8);
+    __m128i lo = _mm_and_si128(rows, _mm_set1_epi16(0xFF));
+
+    return _mm_packus_epi16(hi, lo);
+}
+
+/* Computes the column values and returns them in a SSE register. In each
+ * round, movemask cuts off the values of column i and column i + 8.
+ */
+__attribute__((target("sse2"))) static inline __m128i
+columnsSSE2(const u16 *source)
+{
+    __m128i bytes = splitRows(source);
+    u64 lo = 0, hi = 0;
 
-void transposeSSE(u16 *source, u8* target)
-{
-    // We receive the matrix rows in little endian format
-    // 0.lo 0.hi 1.lo 1.hi 2.lo 2.hi 3.lo 3.hi  ........  7.lo 7.hi
-    //
-    // Rearrange the byte order to
-    // 0.hi 1.hi 2.hi 3.hi ...  7.hi 0.lo 1.lo 2.lo 3.lo  ...  7.lo
-    
-    const u8 mask1[16] = { 1,3,5,7,9,11,13,15,0,2,4,6,8,10,12,14 };
-    __m128i shuffled = _mm_shuffle_epi8(*(__m128i *)source, *(__m128i *)mask1);
-    
-    // Cut off column values in the order
-    // col0 col8 col1 col9 col2 col10 col3 col11 ... col7 col15
-    
-    union { u16 column[8]; __m128i sse; } result;
     for (isize i = 0; i < 8; i++) {
-        result.column[i] = (u16)_mm_movemask_epi8(shuffled);
-        shuffled = _mm_slli_epi64(shuffled, 1);
+
+        u64 mask = (u64)_mm_movemask_epi8(bytes);
+        lo |= (mask & 0xFF) << (8 * i);
+        hi |= (mask >> 8) << (8 * i);
+        bytes = _mm_slli_epi64(bytes, 1);
+    }
+
+    return _mm_set_epi64x((i64)hi, (i64)lo);
+}
+
+/* Computes the column values like columnsSSE2() does. A copy which is four
+ * columns ahead is placed into the upper lane, which makes movemask cut off
+ * four columns in each round.
+ */
+__attribute__((target("avx2"))) static inline __m128i
+columnsAVX2(const u16 *source)
+{
+    __m128i bytes = splitRows(source);
+    __m256i both = _mm256_inserti128_si256(_mm256_castsi128_si256(bytes),
+                                           _mm_slli_epi64(bytes, 4), 1);
+    u64 lo = 0, hi = 0;
+
+    for (isize i = 0; i < 4; i++) {
+
+        u64 mask = (u32)_mm256_movemask_epi8(both);
+        lo |= ((mask & 0xFF) << (8 * i)) | (((mask >> 16) & 0xFF) << (8 * i + 32));
+        hi |= (((mask >> 8) & 0xFF) << (8 * i)) | ((mask >> 24) << (8 * i + 32));
+        both = _mm256_slli_epi64(both, 1);
+    }
+
+    return _mm_set_epi64x((i64)hi, (i64)lo);
+}
+
+// Writes the column values of a single matrix into the target block
+__attribute__((target("sse2"))) static inline void
+storeColumns(__m128i columns, __m128i mask, bool doubled, u8 *target)
+{
+    columns = _mm_and_si128(columns, mask);
+
+    if (doubled) {
+
+        _mm_storeu_si128((__m128i *)target, _mm_unpacklo_epi8(columns, columns));
+        _mm_storeu_si128((__m128i *)(target + 16), _mm_unpackhi_epi8(columns, columns));
+
+    } else {
+
+        _mm_storeu_si128((__m128i *)target, columns);
+    }
+}
+
+__attribute__((target("sse2"))) static void
+transposeSSE2(const u16 *source, u8 *target)
+{
+    _mm_store_si128((__m128i *)target, columnsSSE2(source));
+}
+
+__attribute__((target("avx2"))) static void
+transposeAVX2(const u16 *source, u8 *target)
+{
+    _mm_store_si128((__m128i *)target, columnsAVX2(source));
+}
+
+__attribute__((target("sse2"))) static void
+transposeBlockSSE2(const u16 *source, isize count, u8 mask, bool doubled, u8 *target)
+{
+    __m128i m = _mm_set1_epi8((char)mask);
+    isize width = doubled ? 32 : 16;
+
+    for (isize i = 0; i < count; i++, source += 8, target += width) {
+        storeColumns(columnsSSE2(source), m, doubled, target);
+    }
+}
+
+__attribute__((target("avx2"))) static void
+transposeBlockAVX2(const u16 *source, isize count, u8 mask, bool doubled, u8 *target)
+{
+    __m128i m = _mm_set1_epi8((char)mask);
+    isize width = doubled ? 32 : 16;
+
+    for (isize i = 0; i < count; i++, source += 8, target += width) {
+        storeColumns(columnsAVX2(source), m, doubled, target);
+    }
+}
+
+__attribute__((target("avx2"))) static void
+lookup8AVX2(const u32 *table, isize size, const u8 *source, u32 *target, isize count)
+{
+    isize i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+
+        __m128i bytes = _mm_loadl_epi64((const __m128i *)(source + i));
+        __m256i indices = _mm256_cvtepu8_epi32(bytes);
+        __m256i colors = _mm256_i32gather_epi32((const int *)table, indices, 4);
+        _mm256_storeu_si256((__m256i *)(target + i), colors);
+    }
+
+    lookup8Scalar(table, size, source + i, target + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void
+lookup16AVX2(const u32 *table, const u16 *source, u32 *target, isize count)
+{
+    isize i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+
+        __m128i words = _mm_loadu_si128((const __m128i *)(source + i));
+        __m256i indices = _mm256_cvtepu16_epi32(words);
+        __m256i colors = _mm256_i32gather_epi32((const int *)table, indices, 4);
+        _mm256_storeu_si256((__m256i *)(target + i), colors);
+    }
+
+    lookup16Scalar(table, source + i, target + i, count - i);
+}
+
+// Performs a single step of the prefix scan
+template <int k> __attribute__((target("sse2"))) static inline void
+scanStep(__m128i &value, __m128i &written)
+{
+    __m128i shifted = _mm_slli_si128(value, k);
+    value = _mm_or_si128(_mm_and_si128(written, value), _mm_andnot_si128(written, shifted));
+    written = _mm_or_si128(written, _mm_slli_si128(written, k));
+}
+
+// Propagates the channel values to all pixels not writing the channel
+__attribute__((target("sse2"))) static inline __m128i
+scan(__m128i value, __m128i written, u8 hold)
+{
+    scanStep<1>(value, written);
+    scanStep<2>(value, written);
+    scanStep<4>(value, written);
+    scanStep<8>(value, written);
+
+    __m128i carry = _mm_set1_epi8((char)hold);
+    return _mm_or_si128(_mm_and_si128(written, value), _mm_andnot_si128(written, carry));
+}
+
+/* Decodes a block of 16 HAM pixels. The last three arguments contain the
+ * channel values of the color registers selected by the color indices.
+ */
+__attribute__((target("sse2"))) static inline u16
+decodeBlock(const u8 *bpl, const u8 *index, __m128i r, __m128i g, __m128i b,
+            u16 *target, u16 hold)
+{
+    __m128i bits = _mm_loadu_si128((const __m128i *)bpl);
+    __m128i ctrl = _mm_and_si128(_mm_srli_epi16(bits, 4), _mm_set1_epi8(3));
+    __m128i value = _mm_and_si128(_mm_loadu_si128((const __m128i *)index), _mm_set1_epi8(0xF));
+
+    __m128i load = _mm_cmpeq_epi8(ctrl, _mm_setzero_si128());
+    __m128i modB = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(1));
+    __m128i modR = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(2));
+    __m128i modG = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(3));
+
+    r = scan(_mm_or_si128(_mm_and_si128(load, r), _mm_and_si128(modR, value)),
+             _mm_or_si128(load, modR), (hold >> 8) & 0xF);
+    g = scan(_mm_or_si128(_mm_and_si128(load, g), _mm_and_si128(modG, value)),
+             _mm_or_si128(load, modG), (hold >> 4) & 0xF);
+    b = scan(_mm_or_si128(_mm_and_si128(load, b), _mm_and_si128(modB, value)),
+             _mm_or_si128(load, modB), hold & 0xF);
+
+    // Assemble the 12 bit color values
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_unpacklo_epi8(r, zero), 8),
+                                           _mm_slli_epi16(_mm_unpacklo_epi8(g, zero), 4)),
+                              _mm_unpacklo_epi8(b, zero));
+    __m128i hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_unpackhi_epi8(r, zero), 8),
+                                           _mm_slli_epi16(_mm_unpackhi_epi8(g, zero), 4)),
+                              _mm_unpackhi_epi8(b, zero));
+    _mm_storeu_si128((__m128i *)target, lo);
+    _mm_storeu_si128((__m128i *)(target + 8), hi);
+
+    return (u16)_mm_extract_epi16(hi, 7);
+}
+
+__attribute__((target("sse2"))) static u16
+decodeHAMSSE2(const u8 *bpl, const u8 *index, const u16 *colreg,
+              u16 *target, isize count, u16 hold)
+{
+    isize i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+
+        // SSE2 lacks a byte shuffle. Hence, we look up the registers one by one
+        alignas(16) u8 r[16], g[16], b[16];
+        for (isize j = 0; j < 16; j++) {
+
+            u16 color = colreg[index[i + j] & 0x1F];
+            r[j] = (color >> 8) & 0xF;
+            g[j] = (color >> 4) & 0xF;
+            b[j] = color & 0xF;
+        }
+
+        hold = decodeBlock(bpl + i, index + i,
+                           _mm_load_si128((__m128i *)r),
+                           _mm_load_si128((__m128i *)g),
+                           _mm_load_si128((__m128i *)b), target + i, hold);
+    }
+
+    return decodeHAMScalar(bpl + i, index + i, colreg, target + i, count - i, hold);
+}
+
+__attribute__((target("avx2"))) static u16
+decodeHAMAVX2(const u8 *bpl, const u8 *index, const u16 *colreg,
+              u16 *target, isize count, u16 hold)
+{
+    isize i = 0;
+
+    // Split the color registers into six tables with 16 nibbles each
+    alignas(16) u8 table[6][16];
+    for (isize j = 0; j < 16; j++) {
+
+        table[0][j] = (colreg[j] >> 8) & 0xF;
+        table[1][j] = (colreg[j + 16] >> 8) & 0xF;
+        table[2][j] = (colreg[j] >> 4) & 0xF;
+        table[3][j] = (colreg[j + 16] >> 4) & 0xF;
+        table[4][j] = colreg[j] & 0xF;
+        table[5][j] = colreg[j + 16] & 0xF;
+    }
+    __m128i r0 = _mm_load_si128((__m128i *)table[0]);
+    __m128i r1 = _mm_load_si128((__m128i *)table[1]);
+    __m128i g0 = _mm_load_si128((__m128i *)table[2]);
+    __m128i g1 = _mm_load_si128((__m128i *)table[3]);
+    __m128i b0 = _mm_load_si128((__m128i *)table[4]);
+    __m128i b1 = _mm_load_si128((__m128i *)table[5]);
+
+    for (; i + 16 <= count; i += 16) {
+
+        // Look up the color registers with byte shuffles
+        __m128i regs = _mm_and_si128(_mm_loadu_si128((const __m128i *)(index + i)),
+                                     _mm_set1_epi8(0x1F));
+        __m128i upper = _mm_cmpgt_epi8(regs, _mm_set1_epi8(0xF));
+
+        __m128i r = _mm_blendv_epi8(_mm_shuffle_epi8(r0, regs), _mm_shuffle_epi8(r1, regs), upper);
+        __m128i g = _mm_blendv_epi8(_mm_shuffle_epi8(g0, regs), _mm_shuffle_epi8(g1, regs), upper);
+        __m128i b = _mm_blendv_epi8(_mm_shuffle_epi8(b0, regs), _mm_shuffle_epi8(b1, regs), upper);
+
+        hold = decodeBlock(bpl + i, index + i, r, g, b, target + i, hold);
+    }
+
+    return decodeHAMScalar(bpl + i, index + i, colreg, target + i, count - i, hold);
+}
+
+#endif
+
+#ifdef SIMD_NEON
+
+static void
+transposeNEON(const u16 *source, u8 *target)
+{
+    static const u16 weights[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    uint16x8_t rows = vld1q_u16(source);
+    uint16x8_t w = vld1q_u16(weights);
+
+    // Select the bit of each row and sum up the weights of all set bits
+    for (isize i = 0; i < 16; i++) {
+
+        uint16x8_t bits = vtstq_u16(rows, vdupq_n_u16((u16)(0x8000 >> i)));
+        target[i] = (u8)vaddvq_u16(vandq_u16(bits, w));
     }
-    
-    // Shuffle back to
-    // col0 col1 col2 col3 col4 col5 col6 col7 ...  col14 col15
-    
-    const u8 mask2[16] = { 0,2,4,6,8,10,12,14,1,3,5,7,9,11,13,15 };
-    shuffled = _mm_shuffle_epi8(result.sse, *(__m128i *)mask2);
-    
-    // Read the result back from the SSE registers
-    _mm_store_si128((__m128i *)target, shuffled);
 }
 
+static void
+transposeBlockNEON(const u16 *source, isize count, u8 mask, bool doubled, u8 *target)
+{
+    uint8x16_t m = vdupq_n_u8(mask);
+    isize width = doubled ? 32 : 16;
+    u8 columns[16];
+
+    for (isize i = 0; i < count; i++, source += 8, target += width) {
+
+        transposeNEON(source, columns);
+        uint8x16_t v = vandq_u8(vld1q_u8(columns), m);
+
+        if (doubled) {
+
+            vst1q_u8(target, vzip1q_u8(v, v));
+            vst1q_u8(target + 16, vzip2q_u8(v, v));
+
+        } else {
+
+            vst1q_u8(target, v);
+        }
+    }
+}
+
+static void
+lookup8NEON(const u32 *table, isize size, const u8 *source, u32 *target, isize count)
+{
+    isize i = 0;
+
+    // Tables with up to 80 entries are kept in registers
+    if (size <= 80 && count >= 64) {
+
+        // Split the table into four byte planes
+        u32 padded[80] = { };
+        memcpy(padded, table, size * sizeof(u32));
+
+        uint8x16x4_t lo[4], hi;
+        for (isize k = 0; k < 4; k++) {
+
+            uint8x16x4_t planes = vld4q_u8((const u8 *)padded + 64 * k);
+            for (isize c = 0; c < 4; c++) lo[c].val[k] = planes.val[c];
+        }
+        hi = vld4q_u8((const u8 *)padded + 256);
+
+        for (; i + 16 <= count; i += 16) {
+
+            // Out-of-range indices make the table lookups return 0
+            uint8x16_t idx = vld1q_u8(source + i);
+            uint8x16_t idx2 = vsubq_u8(idx, vdupq_n_u8(64));
+
+            uint8x16x4_t pixels;
+            for (isize c = 0; c < 4; c++) {
+                pixels.val[c] = vorrq_u8(vqtbl4q_u8(lo[c], idx), vqtbl1q_u8(hi.val[c], idx2));
+            }
+            vst4q_u8((u8 *)(target + i), pixels);
+        }
+    }
+
+    lookup8Scalar(table, size, source + i, target + i, count - i);
+}
+
+// Performs a single step of the prefix scan
+template <int k> static inline void
+scanStep(uint8x16_t &value, uint8x16_t &written)
+{
+    uint8x16_t zero = vdupq_n_u8(0);
+    value = vbslq_u8(written, value, vextq_u8(zero, value, 16 - k));
+    written = vorrq_u8(written, vextq_u8(zero, written, 16 - k));
+}
+
+// Propagates the channel values to all pixels not writing the channel
+static inline uint8x16_t
+scan(uint8x16_t value, uint8x16_t written, u8 hold)
+{
+    scanStep<1>(value, written);
+    scanStep<2>(value, written);
+    scanStep<4>(value, written);
+    scanStep<8>(value, written);
+
+    return vbslq_u8(written, value, vdupq_n_u8(hold));
+}
+
+static u16
+decodeHAMNEON(const u8 *bpl, const u8 *index, const u16 *colreg,
+              u16 *target, isize count, u16 hold)
+{
+    isize i = 0;
+
+    // Split the color registers into three tables with 32 nibbles each
+    u8 table[3][32];
+    for (isize j = 0; j < 32; j++) {
+
+        table[0][j] = (colreg[j] >> 8) & 0xF;
+        table[1][j] = (colreg[j] >> 4) & 0xF;
+        table[2][j] = colreg[j] & 0xF;
+    }
+    uint8x16x2_t tr = { vld1q_u8(table[0]), vld1q_u8(table[0] + 16) };
+    uint8x16x2_t tg = { vld1q_u8(table[1]), vld1q_u8(table[1] + 16) };
+    uint8x16x2_t tb = { vld1q_u8(table[2]), vld1q_u8(table[2] + 16) };
+
+    for (; i + 16 <= count; i += 16) {
+
+        uint8x16_t bits = vld1q_u8(bpl + i);
+        uint8x16_t indices = vld1q_u8(index + i);
+        uint8x16_t ctrl = vandq_u8(vshrq_n_u8(bits, 4), vdupq_n_u8(3));
+        uint8x16_t value = vandq_u8(indices, vdupq_n_u8(0xF));
+        uint8x16_t regs = vandq_u8(indices, vdupq_n_u8(0x1F));
+
+        uint8x16_t load = vceqq_u8(ctrl, vdupq_n_u8(0));
+        uint8x16_t modB = vceqq_u8(ctrl, vdupq_n_u8(1));
+        uint8x16_t modR = vceqq_u8(ctrl, vdupq_n_u8(2));
+        uint8x16_t modG = vceqq_u8(ctrl, vdupq_n_u8(3));
+
+        uint8x16_t r = vbslq_u8(load, vqtbl2q_u8(tr, regs), vandq_u8(modR, value));
+        uint8x16_t g = vbslq_u8(load, vqtbl2q_u8(tg, regs), vandq_u8(modG, value));
+        uint8x16_t b = vbslq_u8(load, vqtbl2q_u8(tb, regs), vandq_u8(modB, value));
+
+        r = scan(r, vorrq_u8(load, modR), (hold >> 8) & 0xF);
+        g = scan(g, vorrq_u8(load, modG), (hold >> 4) & 0xF);
+        b = scan(b, vorrq_u8(load, modB), hold & 0xF);
+
+        // Assemble the 12 bit color values
+        uint16x8_t lo = vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vget_low_u8(r)), 8),
+                                            vshlq_n_u16(vmovl_u8(vget_low_u8(g)), 4)),
+                                  vmovl_u8(vget_low_u8(b)));
+        uint16x8_t hi = vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_high_u8(r), 8),
+                                            vshlq_n_u16(vmovl_high_u8(g), 4)),
+                                  vmovl_high_u8(b));
+        vst1q_u16(target + i, lo);
+        vst1q_u16(target + i + 8, hi);
+
+        hold = vgetq_lane_u16(hi, 7);
+    }
+
+    return decodeHAMScalar(bpl + i, index + i, colreg, target + i, count - i, hold);
+}
+
+#endif
+
+static const Kernels kernelTable[] = {
+
+    // Scalar
+    { transposeScalar, transposeBlockScalar, lookup8Scalar, lookup16Scalar, decodeHAMScalar },
+
+#ifdef SIMD_X86
+    // SSE2
+    { transposeSSE2, transposeBlockSSE2, lookup8Scalar, lookup16Scalar, decodeHAMSSE2 },
+
+    // AVX2
+    { transposeAVX2, transposeBlockAVX2, lookup8AVX2, lookup16AVX2, decodeHAMAVX2 },
 #else
+    { transposeScalar, transposeBlockScalar, lookup8Scalar, lookup16Scalar, decodeHAMScalar },
+    { transposeScalar, transposeBlockScalar, lookup8Scalar, lookup16Scalar, decodeHAMScalar },
+#endif
 
-void transposeSSE(u16 *source, u8* target)
+#ifdef SIMD_NEON
+    // NEON
+    { transposeNEON, transposeBlockNEON, lookup8NEON, lookup16Scalar, decodeHAMNEON }
+#else
+    { transposeScalar, transposeBlockScalar, lookup8Scalar, lookup16Scalar, decodeHAMScalar }
+#endif
+};
+
+const char *
+simdName(SIMD s)
 {
-    assert(false);
+    switch (s) {
+
+        case SIMD::Scalar:  return "Scalar";
+        case SIMD::SSE2:    return "SSE2";
+        case SIMD::AVX2:    return "AVX2";
+        case SIMD::NEON:    return "NEON";
+
+        default:
+            return "???";
+    }
 }
 
+bool
+simdIsSupported(SIMD s)
+{
+    switch (s) {
+
+        case SIMD::Scalar:
+            return true;
+
+#ifdef SIMD_X86
+        case SIMD::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+
+        case SIMD::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
 #endif
 
+#ifdef SIMD_NEON
+        case SIMD::NEON:
+            return true;
+#endif
+
+        default:
+            return false;
+    }
+}
+
+SIMD
+bestSIMD()
+{
+    if (simdIsSupported(SIMD::AVX2)) return SIMD::AVX2;
+    if (simdIsSupported(SIMD::SSE2)) return SIMD::SSE2;
+    if (simdIsSupported(SIMD::NEON)) return SIMD::NEON;
+
+    return SIMD::Scalar;
+}
+
+const Kernels &
+kernels(SIMD s)
+{
+    assert((isize)s < (isize)SIMD::Count);
+    return kernelTable[(isize)s];
+}
+
+void (*transpose)(const u16 *, u8 *) = kernels(bestSIMD()).transpose;
+void (*transposeBlock)(const u16 *, isize, u8, bool, u8 *) = kernels(bestSIMD()).transposeBlock;
+void (*lookup8)(const u32 *, isize, const u8 *, u32 *, isize) = kernels(bestSIMD()).lookup8;
+void (*lookup16)(const u32 *, const u16 *, u32 *, isize) = kernels(bestSIMD()).lookup16;
+u16 (*decodeHAM)(const u8 *, const u8 *, const u16 *, u16 *, isize, u16) = kernels(bestSIMD()).decodeHAM;
+
 }
@@ -13,7 +13,15 @@
 
 namespace util {
 
-/* Transposes a 8 x 16 bit matrix using SSE3 extensions.
+/* This file provides the vectorized kernels of the graphics pipeline. Each
+ * kernel exists in a scalar version which runs everywhere and serves as the
+ * reference. The vectorized versions are only available if the host CPU
+ * supports the corresponding instruction set. The fastest supported version
+ * is selected once at program start. Kernels without a vectorized version
+ * for a certain instruction set fall back to the scalar implementation.
+ */
+
+/* Transposes a 8 x 16 bit matrix.
  *
  *     Input:   A pointer to a u16[8] array.
  *              Each array element stores a row of the matrix.
@@ -32,7 +40,66 @@ namespace util {
  *                                        | Column values
  *                                        v
  *              Output: 31, 7, 11, 3, 13, 5, 9, 17, 30, 6, 10, 2, 12, 4, 8, 16
+ *
+ * Both arrays must be 16 byte aligned.
+ */
+void transposeScalar(const u16 *source, u8 *target);
+
+/* Transposes a sequence of 8 x 16 bit matrices and writes the column values
+ * into a contiguous block of memory. Each column value is ANDed with a mask.
+ * If the doubled flag is set, each column value is written twice. Hence, the
+ * function writes 16 or 32 bytes per matrix. The source array must be 16
+ * byte aligned. The target array needs no alignment.
+ */
+void transposeBlockScalar(const u16 *source, isize count, u8 mask, bool doubled, u8 *target);
+
+/* Replaces each element of the source array by the table entry it refers to.
+ * For 8 bit indices, the size of the table has to be provided, too. It allows
+ * the vectorized versions to keep small tables in registers.
+ */
+void lookup8Scalar(const u32 *table, isize size, const u8 *source, u32 *target, isize count);
+void lookup16Scalar(const u32 *table, const u16 *source, u32 *target, isize count);
+
+/* Decodes a sequence of HAM pixels. Bits 4 and 5 of the bitplane data select
+ * the operation. The color index either selects a color register or
+ * provides the new value of the red, green, or blue channel. The hold
+ * argument is the color of the pixel preceding the sequence. The function
+ * writes a 12 bit Amiga color for each pixel and returns the last one.
  */
-void transposeSSE(u16 *source, u8* target);
+u16 decodeHAMScalar(const u8 *bpl, const u8 *index, const u16 *colreg,
+                    u16 *target, isize count, u16 hold);
+
+// Supported instruction set extensions
+enum class SIMD { Scalar, SSE2, AVX2, NEON, Count };
+
+// The kernels provided for an instruction set
+struct Kernels {
+
+    void (*transpose)(const u16 *, u8 *);
+    void (*transposeBlock)(const u16 *, isize, u8, bool, u8 *);
+    void (*lookup8)(const u32 *, isize, const u8 *, u32 *, isize);
+    void (*lookup16)(const u32 *, const u16 *, u32 *, isize);
+    u16 (*decodeHAM)(const u8 *, const u8 *, const u16 *, u16 *, isize, u16);
+};
+
+// Returns a textual description of an instruction set
+const char *simdName(SIMD s);
+
+// Checks if an instruction set is supported by the host CPU
+bool simdIsSupported(SIMD s);
+
+// Returns the fastest instruction set supported by the host CPU
+SIMD bestSIMD();
+
+// Returns the kernels of an instruction set
+const Kernels &kernels(SIMD s);
+
+// The kernels of the fastest instruction set supported by the host CPU
+extern void (*transpose)(const u16 *source, u8 *target);
+extern void (*transposeBlock)(const u16 *source, isize count, u8 mask, bool doubled, u8 *target);
+extern void (*lookup8)(const u32 *table, isize size, const u8 *source, u32 *target, isize count);
+extern void (*lookup16)(const u32 *table, const u16 *source, u32 *target, isize count);
+extern u16 (*decodeHAM)(const u8 *bpl, const u8 *index, const u16 *colreg,
+                        u16 *target, isize count, u16 hold);
 
 }
@@ -10,9 +10,48 @@
 #pragma once
 
 #include "Macros.h"
+#include <cstring>
+#include <type_traits>
 
 namespace util {
 
+//
+// Byte order
+//
+
+/* By default, all values are serialized in big-endian byte order which makes
+ * snapshot files portable across platforms. Snapshots which never leave the
+ * host (e.g., the states saved by the rewind buffer or the run-ahead mode) may
+ * be serialized in native byte order instead which is considerably faster. The
+ * byte order is selected per thread with a NativeByteOrder guard. It affects
+ * all serializers created while the guard is alive. The layout of the
+ * serialized data is the same in both modes.
+ */
+inline thread_local bool nativeByteOrder = false;
+
+struct NativeByteOrder {
+
+    bool previous;
+
+    NativeByteOrder() : previous(nativeByteOrder) { nativeByteOrder = true; }
+    ~NativeByteOrder() { nativeByteOrder = previous; }
+};
+
+// Returns the number of bytes occupied by a serialized value of type T
+template <class T> constexpr isize serializedSize()
+{
+    return sizeof(T) <= 2 ? sizeof(T) : 8;
+}
+
+/* Indicates if arrays of type T can be transferred with a single memcpy.
+ * This is the case for all byte types and, in native byte order, for all
+ * arithmetic types whose size doesn't change when serialized.
+ */
+template <class T> constexpr bool isBulkType()
+{
+    return std::is_arithmetic<T>::value && serializedSize<T>() == sizeof(T);
+}
+
 //
 // Basic memory buffer I/O
 //
@@ -45,6 +84,14 @@ inline u64 read64(const u8 *& buf)
     return ((u64)hi << 32) | lo;
 }
 
+template <class T> inline T readNative(const u8 *& buf)
+{
+    T result;
+    memcpy(&result, buf, sizeof(T));
+    buf += sizeof(T);
+    return result;
+}
+
 inline double readDouble(const u8 *& buf)
 {
     double result = 0;
@@ -76,6 +123,12 @@ inline void write64(u8 *& buf, u64 value)
     write32(buf, (u32)(value));
 }
 
+template <class T> inline void writeNative(u8 *& buf, T value)
+{
+    memcpy(buf, &value, sizeof(T));
+    buf += sizeof(T);
+}
+
 inline void writeDouble(u8 *& buf, double value)
 {
     for (isize i = 0; i < 8; i++) write8(buf, ((u8 *)&value)[i]);
@@ -124,8 +177,12 @@ public:
     template <class T, isize N>
     SerCounter& operator<<(T (&v)[N])
     {
-        for(isize i = 0; i < N; ++i) {
-            *this << v[i];
+        if constexpr (std::is_arithmetic<T>::value) {
+            count += N * serializedSize<T>();
+        } else {
+            for(isize i = 0; i < N; ++i) {
+                *this << v[i];
+            }
         }
         return *this;
     }
@@ -152,17 +209,17 @@ public:
 // Reader (Deserializer)
 //
 
-#define DESERIALIZE(type,function) \
+#define DESERIALIZE(type,function,native) \
 SerReader& operator<<(type& v) \
 { \
-v = (type)function(ptr); \
+v = (type)(nativeOrder ? readNative<native>(ptr) : function(ptr)); \
 return *this; \
 }
 
-#define DESERIALIZE8(type)  static_assert(sizeof(type) == 1); DESERIALIZE(type,read8)
-#define DESERIALIZE16(type) static_assert(sizeof(type) == 2); DESERIALIZE(type,read16)
-#define DESERIALIZE64(type) static_assert(sizeof(type) <= 8); DESERIALIZE(type,read64)
-#define DESERIALIZED(type) static_assert(sizeof(type) <= 8); DESERIALIZE(type,readDouble)
+#define DESERIALIZE8(type)  static_assert(sizeof(type) == 1); DESERIALIZE(type,read8,u8)
+#define DESERIALIZE16(type) static_assert(sizeof(type) == 2); DESERIALIZE(type,read16,u16)
+#define DESERIALIZE64(type) static_assert(sizeof(type) <= 8); DESERIALIZE(type,read64,u64)
+#define DESERIALIZED(type) static_assert(sizeof(type) <= 8); DESERIALIZE(type,readDouble,double)
 
 class SerReader
 {
@@ -170,7 +227,10 @@ public:
 
     const u8 *ptr;
 
-    SerReader(const u8 *p) : ptr(p)
+    // Indicates if values are stored in native byte order
+    const bool nativeOrder;
+
+    SerReader(const u8 *p) : ptr(p), nativeOrder(nativeByteOrder)
     {
     }
 
@@ -192,6 +252,9 @@ public:
     template <class T, isize N>
     SerReader& operator<<(T (&v)[N])
     {
+        if constexpr (isBulkType<T>()) {
+            if (sizeof(T) == 1 || nativeOrder) { copy(v, sizeof(v)); return *this; }
+        }
         for(isize i = 0; i < N; ++i) {
             *this << v[i];
         }
@@ -229,7 +292,7 @@ public:
 #define SERIALIZE(type,function,cast) \
 SerWriter& operator<<(type& v) \
 { \
-function(ptr, (cast)v); \
+if (nativeOrder) writeNative(ptr, (cast)v); else function(ptr, (cast)v); \
 return *this; \
 }
 
@@ -244,7 +307,10 @@ public:
 
     u8 *ptr;
 
-    SerWriter(u8 *p) : ptr(p)
+    // Indicates if values are stored in native byte order
+    const bool nativeOrder;
+
+    SerWriter(u8 *p) : ptr(p), nativeOrder(nativeByteOrder)
     {
     }
 
@@ -266,6 +332,9 @@ public:
     template <class T, isize N>
     SerWriter& operator<<(T (&v)[N])
     {
+        if constexpr (isBulkType<T>()) {
+            if (sizeof(T) == 1 || nativeOrder) { copy(v, sizeof(v)); return *this; }
+        }
         for(isize i = 0; i < N; ++i) {
             *this << v[i];
         }
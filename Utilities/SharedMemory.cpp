@@ -0,0 +1,99 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "SharedMemory.h"
+#include <atomic>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace util {
+
+static int
+createAnonymousFile()
+{
+#ifdef __linux__
+
+    return memfd_create("vAmiga", MFD_CLOEXEC);
+
+#else
+
+    // Create a shared memory object and remove its name right away
+    static std::atomic<int> counter { 0 };
+
+    char name[32];
+    snprintf(name, sizeof(name), "/vAmiga.%d.%d", (int)getpid(), counter++);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) shm_unlink(name);
+    return fd;
+
+#endif
+}
+
+AnonymousFile::AnonymousFile(const u8 *contents, isize size)
+{
+    if ((fd = createAnonymousFile()) < 0) return;
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    for (isize offset = 0; offset < size; ) {
+
+        ssize_t count = pwrite(fd, contents + offset, (size_t)(size - offset), (off_t)offset);
+
+        if (count <= 0) {
+
+            close(fd);
+            fd = -1;
+            return;
+        }
+        offset += count;
+    }
+
+    this->size = size;
+}
+
+AnonymousFile::~AnonymousFile()
+{
+    if (fd >= 0) close(fd);
+}
+
+u8 *
+AnonymousFile::map(void *addr) const
+{
+    if (fd < 0) return nullptr;
+
+    int flags = addr ? MAP_PRIVATE | MAP_FIXED : MAP_PRIVATE;
+    void *result = mmap(addr, (size_t)size, PROT_READ | PROT_WRITE, flags, fd, 0);
+
+    return result == MAP_FAILED ? nullptr : (u8 *)result;
+}
+
+u8 *
+allocMappable(isize size)
+{
+    void *result = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return result == MAP_FAILED ? nullptr : (u8 *)result;
+}
+
+void
+freeMappable(void *ptr, isize size)
+{
+    if (ptr) munmap(ptr, (size_t)size);
+}
+
+}
@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+
+namespace util {
+
+/* This file provides the building blocks for sharing large memory areas
+ * copy-on-write between multiple emulator instances. The contents of a memory
+ * area are frozen by writing them into an anonymous file which only lives in
+ * host memory. Afterwards, each instance maps the file privately. The pages
+ * are shared until an instance modifies them. In this case, the host creates
+ * a private copy of the modified page.
+ */
+
+class AnonymousFile {
+
+    // File descriptor (-1 if the file could not be created)
+    int fd = -1;
+
+    // File size in bytes
+    isize size = 0;
+
+public:
+
+    // Creates an anonymous file with the specified contents
+    AnonymousFile(const u8 *contents, isize size);
+    ~AnonymousFile();
+
+    AnonymousFile(const AnonymousFile &) = delete;
+    AnonymousFile &operator=(const AnonymousFile &) = delete;
+
+    bool isValid() const { return fd >= 0; }
+    isize getSize() const { return size; }
+
+    /* Maps the file copy-on-write. If an address is given, the new mapping
+     * replaces the existing one at this address. The function returns nullptr
+     * if the file could not be mapped.
+     */
+    u8 *map(void *addr = nullptr) const;
+};
+
+// Allocates a memory block that can be replaced by AnonymousFile::map()
+u8 *allocMappable(isize size);
+
+// Frees a memory block that has been allocated by allocMappable() or map()
+void freeMappable(void *ptr, isize size);
+
+}
@@ -53,6 +53,15 @@ struct FloatStereo; typedef FloatStereo SampleType;
 // Uncomment to fallback to a simpler Agnus execution function
 // #define AGNUS_EXEC_DEBUG
 
+// Uncomment to synchronize Agnus with the CPU after each CPU bus cycle
+// #define AGNUS_EAGER_SYNC
+
+// Uncomment to compile in the profiler (RetroShell command "profile")
+// #define PROFILER
+
+// Uncomment to compile in the event tracer (RetroShell command "tracer")
+// #define EVENT_TRACER
+
 // Uncomment to lauch the emulator with a disk in df0
 // #define DF0_DISK "/Users/hoff/Desktop/Testing/Planet_Rocklobster_Oxyron.adf"
 // #define DF0_DISK "/Users/hoff/Desktop/Testing/Ruffntumble.adf"
@@ -160,6 +169,7 @@ static const int HOLD_MOUSE_R    = 0; // Hold down the right mouse button
 static const int RTC_DEBUG       = 0; // Real-time clock
 static const int KBD_DEBUG       = 0; // Keyboard
 static const int REC_DEBUG       = 0; // Screen recorder
+static const int INP_DEBUG       = 0; // Input recorder
 
 
 #ifdef RELEASEBUILD